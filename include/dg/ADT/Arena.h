@@ -0,0 +1,78 @@
+#ifndef DG_ADT_ARENA_H_
+#define DG_ADT_ARENA_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Bump allocator: the memory is taken from big chunks and it is freed
+// only when the arena is destroyed (all at once). The arena does not
+// call destructors of the created objects, that is up to the owner
+// of the objects.
+class Arena {
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    char *_cur{nullptr};
+    size_t _free{0};
+    const size_t _chunkSize;
+
+    void newChunk(size_t size) {
+        size = std::max(size, _chunkSize);
+        _chunks.emplace_back(new char[size]);
+        _cur = _chunks.back().get();
+        _free = size;
+    }
+
+  public:
+    explicit Arena(size_t chunkSize = 64 * 1024) : _chunkSize(chunkSize) {}
+
+    Arena(Arena &&rhs)
+            : _chunks(std::move(rhs._chunks)), _cur(rhs._cur), _free(rhs._free),
+              _chunkSize(rhs._chunkSize) {
+        rhs._cur = nullptr;
+        rhs._free = 0;
+    }
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t align) {
+        void *ptr = _cur;
+        if (!ptr || !std::align(align, size, ptr, _free)) {
+            // the chunks are aligned for any fundamental type
+            assert(align <= alignof(std::max_align_t));
+            newChunk(size);
+            ptr = _cur;
+        }
+        _cur = static_cast<char *>(ptr) + size;
+        _free -= size;
+        return ptr;
+    }
+
+    template <typename T, typename... Args>
+    T *create(Args &&...args) {
+        return new (allocate(sizeof(T), alignof(T)))
+                T(std::forward<Args>(args)...);
+    }
+
+    void swap(Arena &rhs) {
+        _chunks.swap(rhs._chunks);
+        std::swap(_cur, rhs._cur);
+        std::swap(_free, rhs._free);
+    }
+
+    // the number of allocated chunks
+    size_t chunks() const { return _chunks.size(); }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_ARENA_H_
@@ -0,0 +1,499 @@
+#ifndef DG_ADT_BDD_H_
+#define DG_ADT_BDD_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Reduced ordered binary decision diagrams (BDDs) that represent sets
+// of 64-bit unsigned numbers. The i-th variable of the diagrams is
+// the i-th most significant bit of the number.
+//
+// The manager keeps all the nodes in a node table. The unique table makes
+// sure that every node is created only once, so equal sets are represented
+// by the same BDD (the same index of a node) and sets that share bits
+// of their elements share the nodes. Results of the binary operations are
+// kept in a (lossy) operation cache.
+//
+// The sets are reference counted like the sets of InternedSetsPool: every
+// set returned by the manager is retained and must be released by the
+// caller, and the arguments of the operations must be retained sets.
+// Whenever the number of nodes doubles, the manager frees the nodes that
+// are not reachable from any retained set (mark and sweep) and reuses
+// them for new nodes. A manager that is owned by someone else than
+// the users of its sets is destroyed by destroy(), which leaves it alive
+// until the last retained set is released (and release() tells the caller
+// to delete the manager).
+//
+// The manager can be switched to the concurrent mode in which every
+// operation locks the manager.
+class BDDManager {
+  public:
+    using BDD = uint32_t;
+    using ValueT = uint64_t;
+
+    enum : BDD {
+        EMPTY = 0, // empty set
+        ALL = 1,   // set of all numbers
+    };
+    static const unsigned BITS = sizeof(ValueT) * 8;
+
+    explicit BDDManager(bool concurrent = false) : _concurrent(concurrent) {
+        // terminal nodes
+        _nodes.push_back({BITS, EMPTY, EMPTY, 0});
+        _nodes.push_back({BITS, ALL, ALL, 0});
+    }
+
+    BDDManager(const BDDManager &) = delete;
+    BDDManager &operator=(const BDDManager &) = delete;
+
+    // Destroy the manager allocated by new. If some of its sets are still
+    // retained, the manager is deleted by the last release().
+    void destroy() {
+        bool last;
+        {
+            Lock lock(*this);
+            _orphan = true;
+            last = _roots == 0;
+        }
+        if (last)
+            delete this;
+    }
+
+    void retain(BDD a) {
+        if (a == EMPTY || a == ALL)
+            return;
+        Lock lock(*this);
+        _retain(a);
+    }
+
+    // Return true if the manager was destroyed and this was its last
+    // retained set. The caller must delete the manager then.
+    bool release(BDD a) {
+        if (a == EMPTY || a == ALL)
+            return false;
+        Lock lock(*this);
+        assert(_nodes[a].refs > 0 && "The set is not retained");
+        --_nodes[a].refs;
+        return --_roots == 0 && _orphan;
+    }
+
+    // the set {v}
+    BDD singleton(ValueT v) {
+        Lock lock(*this);
+        auto it = _singletons.find(v);
+        if (it != _singletons.end())
+            return _retain(it->second);
+
+        maybeCollect();
+        BDD res = mkPrefix(v, BITS);
+        _singletons.emplace(v, res);
+        return _retain(res);
+    }
+
+    // the set of all numbers whose 'bits' most significant bits
+    // are the same as in 'prefix'
+    BDD withPrefix(ValueT prefix, unsigned bits) {
+        assert(bits <= BITS);
+        Lock lock(*this);
+        maybeCollect();
+        return _retain(mkPrefix(prefix, bits));
+    }
+
+    BDD unite(BDD a, BDD b) {
+        Lock lock(*this);
+        maybeCollect();
+        return _retain(apply(Op::UNION, a, b));
+    }
+
+    BDD intersect(BDD a, BDD b) {
+        Lock lock(*this);
+        maybeCollect();
+        return _retain(apply(Op::INTERSECTION, a, b));
+    }
+
+    BDD subtract(BDD a, BDD b) {
+        Lock lock(*this);
+        maybeCollect();
+        return _retain(apply(Op::DIFFERENCE, a, b));
+    }
+
+    bool contains(BDD a, ValueT v) const {
+        Lock lock(*this);
+        while (a != EMPTY && a != ALL) {
+            const auto &N = _nodes[a];
+            a = ((v >> (BITS - 1 - N.var)) & 1) ? N.high : N.low;
+        }
+        return a == ALL;
+    }
+
+    // Return true if the set contains a number whose 'bits' most
+    // significant bits are the same as in 'prefix'
+    bool containsPrefix(BDD a, ValueT prefix, unsigned bits) const {
+        assert(bits <= BITS);
+        Lock lock(*this);
+        while (a != EMPTY && a != ALL) {
+            const auto &N = _nodes[a];
+            if (N.var >= bits)
+                break;
+            a = ((prefix >> (BITS - 1 - N.var)) & 1) ? N.high : N.low;
+        }
+        // a non-empty BDD always contains some number
+        return a != EMPTY;
+    }
+
+    // The number of elements of the set. It must not be ALL
+    // or any other set with more than 2^64 - 1 elements.
+    size_t count(BDD a) const {
+        Lock lock(*this);
+        return countFrom(a, 0);
+    }
+
+    // The elements of the set in increasing order.
+    // The same constraints as for count() apply.
+    std::vector<ValueT> getValues(BDD a) const {
+        Lock lock(*this);
+        std::vector<ValueT> values;
+        collect(a, 0, 0, values);
+        return values;
+    }
+
+    // the number of nodes that are not freed (including terminals)
+    size_t size() const {
+        Lock lock(*this);
+        return _nodes.size() - _freeNum;
+    }
+
+    // free the nodes that are not reachable from any retained set
+    void collectGarbage() {
+        Lock lock(*this);
+        collect();
+    }
+
+    // Allow using the manager from several threads at once.
+    // Must not be switched while the manager is used by other threads.
+    void setConcurrent(bool b) { _concurrent = b; }
+
+  private:
+    enum class Op : uint32_t { NONE, UNION, INTERSECTION, DIFFERENCE };
+
+    struct Node {
+        uint32_t var;  // BITS for terminals, FREE for freed nodes
+        BDD low;       // the bit is 0 (the next freed node for freed nodes)
+        BDD high;      // the bit is 1
+        uint32_t refs; // how many times is the set of this node retained
+    };
+
+    static const uint32_t FREE = BITS + 1;
+    // the minimal number of nodes that triggers garbage collection
+    static const size_t MIN_COLLECT_LIMIT = 1 << 16;
+
+    struct CacheEntry {
+        Op op{Op::NONE};
+        BDD a{0};
+        BDD b{0};
+        BDD res{0};
+    };
+
+    static const size_t CACHE_SIZE = 1 << 16;
+
+    class Lock {
+        const BDDManager &M;
+
+      public:
+        Lock(const BDDManager &m) : M(m) {
+            if (M._concurrent)
+                M._mutex.lock();
+        }
+        ~Lock() {
+            if (M._concurrent)
+                M._mutex.unlock();
+        }
+    };
+
+    std::vector<Node> _nodes;
+    // The unique table: an open-addressing hash table of indices
+    // of the nodes (EMPTY marks a free slot, terminals are not there)
+    std::vector<BDD> _unique;
+    std::vector<CacheEntry> _cache;
+    std::unordered_map<ValueT, BDD> _singletons;
+    // the numbers of elements of the sets represented by nodes
+    // (counting only the variables below the variable of the node),
+    // 0 if not computed yet
+    mutable std::vector<size_t> _counts;
+
+    // the list of freed nodes linked by 'low' (EMPTY ends the list)
+    BDD _free{EMPTY};
+    size_t _freeNum{0};
+    // collect garbage when the number of nodes reaches this number
+    size_t _collectLimit{MIN_COLLECT_LIMIT};
+    // the number of references to retained sets
+    size_t _roots{0};
+    // destroy() was called, the manager is deleted by the last release()
+    bool _orphan{false};
+
+    mutable std::mutex _mutex;
+    bool _concurrent{false};
+
+    BDD _retain(BDD a) {
+        if (a != EMPTY && a != ALL) {
+            ++_nodes[a].refs;
+            ++_roots;
+        }
+        return a;
+    }
+
+    BDD mkPrefix(ValueT prefix, unsigned bits) {
+        BDD res = ALL;
+        for (unsigned var = bits; var > 0; --var) {
+            bool bit = (prefix >> (BITS - var)) & 1;
+            res = bit ? mk(var - 1, EMPTY, res) : mk(var - 1, res, EMPTY);
+        }
+        return res;
+    }
+
+    BDD mk(uint32_t var, BDD low, BDD high) {
+        if (low == high)
+            return low;
+
+        // keep the load factor of the unique table at most 1/2
+        if (2 * _nodes.size() >= _unique.size())
+            rehash(_unique.empty() ? 1024 : 2 * _unique.size());
+
+        size_t mask = _unique.size() - 1;
+        for (size_t i = hashNode(var, low, high) & mask;; i = (i + 1) & mask) {
+            BDD n = _unique[i];
+            if (n == EMPTY) {
+                BDD res = newNode({var, low, high, 0});
+                _unique[i] = res;
+                return res;
+            }
+            const auto &N = _nodes[n];
+            if (N.var == var && N.low == low && N.high == high)
+                return n;
+        }
+    }
+
+    static size_t hashNode(uint32_t var, BDD low, BDD high) {
+        uint64_t h = (static_cast<uint64_t>(low) << 32) | high;
+        h = (h ^ var) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+
+    BDD newNode(const Node &node) {
+        if (_free != EMPTY) {
+            BDD res = _free;
+            _free = _nodes[res].low;
+            --_freeNum;
+            _nodes[res] = node;
+            return res;
+        }
+
+        BDD res = static_cast<BDD>(_nodes.size());
+        assert(res == _nodes.size() && "Too many BDD nodes");
+        _nodes.push_back(node);
+        return res;
+    }
+
+    void rehash(size_t size) {
+        std::vector<BDD> table(size, EMPTY);
+        size_t mask = table.size() - 1;
+        // skip the terminals
+        for (BDD n = 2; n < _nodes.size(); ++n) {
+            const auto &N = _nodes[n];
+            if (N.var == FREE)
+                continue;
+            size_t i = hashNode(N.var, N.low, N.high) & mask;
+            while (table[i] != EMPTY)
+                i = (i + 1) & mask;
+            table[i] = n;
+        }
+        _unique.swap(table);
+    }
+
+    void maybeCollect() {
+        if (_nodes.size() - _freeNum >= _collectLimit)
+            collect();
+    }
+
+    // Free the nodes that are not reachable from retained sets.
+    // It must not be called in the middle of an operation, the nodes
+    // that the operation has created are not retained yet.
+    void collect() {
+        std::vector<bool> reachable(_nodes.size(), false);
+        std::vector<BDD> stack;
+        for (BDD n = 2; n < _nodes.size(); ++n) {
+            if (_nodes[n].var != FREE && _nodes[n].refs > 0)
+                stack.push_back(n);
+        }
+        while (!stack.empty()) {
+            BDD n = stack.back();
+            stack.pop_back();
+            if (n == EMPTY || n == ALL || reachable[n])
+                continue;
+            reachable[n] = true;
+            stack.push_back(_nodes[n].low);
+            stack.push_back(_nodes[n].high);
+        }
+
+        for (BDD n = 2; n < _nodes.size(); ++n) {
+            if (reachable[n] || _nodes[n].var == FREE)
+                continue;
+            _nodes[n] = {FREE, _free, EMPTY, 0};
+            _free = n;
+            ++_freeNum;
+            if (n < _counts.size())
+                _counts[n] = 0;
+        }
+
+        for (auto it = _singletons.begin(); it != _singletons.end();) {
+            if (reachable[it->second])
+                ++it;
+            else
+                it = _singletons.erase(it);
+        }
+        // the cached results may be freed nodes
+        if (!_cache.empty())
+            std::fill(_cache.begin(), _cache.end(), CacheEntry());
+        if (!_unique.empty())
+            rehash(_unique.size());
+
+        size_t live = _nodes.size() - _freeNum;
+        _collectLimit =
+                2 * live > MIN_COLLECT_LIMIT ? 2 * live : MIN_COLLECT_LIMIT;
+    }
+
+    static bool terminalCase(Op op, BDD a, BDD b, BDD &res) {
+        switch (op) {
+        case Op::UNION:
+            if (a == ALL || b == ALL)
+                res = ALL;
+            else if (a == EMPTY || a == b)
+                res = b;
+            else if (b == EMPTY)
+                res = a;
+            else
+                return false;
+            return true;
+        case Op::INTERSECTION:
+            if (a == EMPTY || b == EMPTY)
+                res = EMPTY;
+            else if (a == ALL || a == b)
+                res = b;
+            else if (b == ALL)
+                res = a;
+            else
+                return false;
+            return true;
+        case Op::DIFFERENCE:
+            if (a == EMPTY || b == ALL || a == b)
+                res = EMPTY;
+            else if (b == EMPTY)
+                res = a;
+            else
+                return false;
+            return true;
+        default:
+            assert(false && "Invalid operation");
+            abort();
+        }
+    }
+
+    BDD apply(Op op, BDD a, BDD b) {
+        BDD res;
+        if (terminalCase(op, a, b, res))
+            return res;
+
+        // the cache is big, allocate it only when it is needed
+        if (_cache.empty())
+            _cache.resize(CACHE_SIZE);
+
+        auto &entry = _cache[cacheIdx(op, a, b)];
+        if (entry.op == op && entry.a == a && entry.b == b)
+            return entry.res;
+
+        // NOTE: do not keep references to _nodes, the vector can grow
+        const Node A = _nodes[a];
+        const Node B = _nodes[b];
+        uint32_t var = A.var < B.var ? A.var : B.var;
+        BDD low = apply(op, A.var == var ? A.low : a, B.var == var ? B.low : b);
+        BDD high =
+                apply(op, A.var == var ? A.high : a, B.var == var ? B.high : b);
+        res = mk(var, low, high);
+
+        // the recursive calls could overwrite the entry
+        auto &newEntry = _cache[cacheIdx(op, a, b)];
+        newEntry.op = op;
+        newEntry.a = a;
+        newEntry.b = b;
+        newEntry.res = res;
+        return res;
+    }
+
+    static size_t cacheIdx(Op op, BDD a, BDD b) {
+        uint64_t h = (static_cast<uint64_t>(a) << 32) | b;
+        h = (h ^ static_cast<uint64_t>(op)) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(h >> 48) & (CACHE_SIZE - 1);
+    }
+
+    // the number of assignments of variables var, ..., BITS - 1
+    // that are in the set
+    size_t countFrom(BDD a, uint32_t var) const {
+        if (a == EMPTY)
+            return 0;
+        if (a == ALL) {
+            // the remaining variables may have any value
+            assert(var > 0 && "The set is too big");
+            return static_cast<size_t>(1) << (BITS - var);
+        }
+
+        const auto &N = _nodes[a];
+        assert(N.var >= var);
+        // the skipped variables may have any value
+        size_t skipped = static_cast<size_t>(1) << (N.var - var);
+
+        if (_counts.size() <= a)
+            _counts.resize(_nodes.size(), 0);
+        if (_counts[a] == 0) {
+            _counts[a] =
+                    countFrom(N.low, N.var + 1) + countFrom(N.high, N.var + 1);
+        }
+        return skipped * _counts[a];
+    }
+
+    void collect(BDD a, uint32_t var, ValueT prefix,
+                 std::vector<ValueT> &values) const {
+        if (a == EMPTY)
+            return;
+        if (var == BITS) {
+            assert(a == ALL);
+            values.push_back(prefix);
+            return;
+        }
+
+        const auto &N = _nodes[a];
+        if (N.var == var) {
+            collect(N.low, var + 1, prefix, values);
+            collect(N.high, var + 1, prefix | (ValueT{1} << (BITS - 1 - var)),
+                    values);
+        } else {
+            // the variable may have any value
+            collect(a, var + 1, prefix, values);
+            collect(a, var + 1, prefix | (ValueT{1} << (BITS - 1 - var)),
+                    values);
+        }
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_BDD_H_
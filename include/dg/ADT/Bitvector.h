@@ -49,6 +49,8 @@ class SparseBitvectorImpl {
 
     SparseBitvectorImpl(const SparseBitvectorImpl &) = default;
     SparseBitvectorImpl(SparseBitvectorImpl &&) = default;
+    SparseBitvectorImpl &operator=(const SparseBitvectorImpl &) = default;
+    SparseBitvectorImpl &operator=(SparseBitvectorImpl &&) = default;
 
     void reset() { _bits.clear(); }
     bool empty() const { return _bits.empty(); }
@@ -94,6 +96,31 @@ class SparseBitvectorImpl {
         return changed;
     }
 
+    // intersection operation, returns true if some bit was unset
+    bool intersect(const SparseBitvectorImpl &rhs) {
+        bool changed = false;
+        for (auto it = _bits.begin(); it != _bits.end();) {
+            auto rit = rhs._bits.find(it->first);
+            auto B = rit == rhs._bits.end() ? BitsT{0}
+                                            : (it->second & rit->second);
+            if (B == it->second) {
+                ++it;
+                continue;
+            }
+
+            changed = true;
+            if (B == 0) {
+                it = _bits.erase(it);
+            } else {
+                // the hash maps return read-only objects (see unset())
+                _bits[it->first] = B;
+                ++it;
+            }
+        }
+
+        return changed;
+    }
+
     // returns the previous value of the i-th bit
     bool unset(IndexT i) {
         auto sft = _shift(i);
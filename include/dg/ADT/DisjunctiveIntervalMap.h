@@ -67,12 +67,14 @@ struct DiscreteInterval {
 
 ///
 // Mapping of disjunctive discrete intervals of values
-// to sets of ValueT.
-template <typename ValueT, typename IntervalValueT = Offset>
+// to sets of ValueT. The sets are of the type ValuesSetT
+// that must have (a subset of) the interface of std::set.
+template <typename ValueT, typename IntervalValueT = Offset,
+          typename ValuesSetT = std::set<ValueT>>
 class DisjunctiveIntervalMap {
   public:
     using IntervalT = DiscreteInterval<IntervalValueT>;
-    using ValuesT = std::set<ValueT>;
+    using ValuesT = ValuesSetT;
     using MappingT = std::map<IntervalT, ValuesT>;
     using iterator = typename MappingT::iterator;
     using const_iterator = typename MappingT::const_iterator;
@@ -217,18 +219,30 @@ class DisjunctiveIntervalMap {
 
     std::set<ValueT> gather(const IntervalT &I) const {
         std::set<ValueT> ret;
+        forEachOverlapping(I, [&ret](const IntervalT &, const ValuesT &vals) {
+            ret.insert(vals.begin(), vals.end());
+        });
+        return ret;
+    }
+
+    ///
+    // Call fun(interval, values) for every interval that overlaps I
+    // (in the order of the intervals). Unlike gather(), this does not
+    // allocate anything.
+    template <typename FunT>
+    void forEachOverlapping(const IntervalT &I, FunT fun) const {
+        if (_mapping.empty())
+            return;
 
         auto it = le(I);
         if (it == end())
-            return ret;
+            return;
 
         assert(it->first.overlaps(I) && "The found interval should overlap");
-        while (it != end() && it->first.overlaps(I)) {
-            ret.insert(it->second.begin(), it->second.end());
+        while (it != end() && it->first.start <= I.end) {
+            fun(it->first, it->second);
             ++it;
         }
-
-        return ret;
     }
 
     std::vector<IntervalT> uncovered(IntervalValueT start,
@@ -303,7 +317,7 @@ class DisjunctiveIntervalMap {
     const_iterator end() const { return _mapping.end(); }
 
     bool operator==(
-            const DisjunctiveIntervalMap<ValueT, IntervalValueT> &rhs) const {
+            const DisjunctiveIntervalMap &rhs) const {
         return _mapping == rhs._mapping;
     }
 
@@ -328,7 +342,7 @@ class DisjunctiveIntervalMap {
 #ifndef NDEBUG
     friend std::ostream &
     operator<<(std::ostream &os,
-               const DisjunctiveIntervalMap<ValueT, IntervalValueT> &map) {
+               const DisjunctiveIntervalMap &map) {
         os << "{";
         for (const auto &pair : map) {
             if (pair.second.empty())
@@ -347,7 +361,7 @@ class DisjunctiveIntervalMap {
 #endif
 
 #if 0
-    friend llvm::raw_ostream& operator<<(llvm::raw_ostream& os, const DisjunctiveIntervalMap<ValueT, IntervalValueT>& map) {
+    friend llvm::raw_ostream& operator<<(llvm::raw_ostream& os, const DisjunctiveIntervalMap& map) {
         os << "{";
         for (const auto& pair : map) {
             if (pair.second.empty())
@@ -0,0 +1,131 @@
+#ifndef DG_ADT_SORTED_VECTOR_MAP_H_
+#define DG_ADT_SORTED_VECTOR_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Map stored as a vector of (key, value) pairs sorted by the keys.
+// It has (a subset of) the interface of std::map, but the entries are
+// kept in one piece of memory, so iterating over the map and searching
+// in it is cheap and ranges of keys can be found by binary search.
+// Inserting a new key moves the entries with greater keys, so the map
+// is meant for small number of entries.
+//
+// NOTE: unlike with std::map, inserting a new key invalidates
+// iterators and references to the entries.
+template <typename KeyT, typename ValueT>
+class SortedVectorMap {
+  public:
+    using key_type = KeyT;
+    using mapped_type = ValueT;
+    using value_type = std::pair<KeyT, ValueT>;
+    using ContainerT = std::vector<value_type>;
+    using iterator = typename ContainerT::iterator;
+    using const_iterator = typename ContainerT::const_iterator;
+
+  private:
+    ContainerT _entries;
+
+    struct KeyLess {
+        bool operator()(const value_type &entry, const KeyT &key) const {
+            return entry.first < key;
+        }
+        bool operator()(const KeyT &key, const value_type &entry) const {
+            return key < entry.first;
+        }
+    };
+
+  public:
+    // the first entry whose key is not less than 'key'
+    iterator lower_bound(const KeyT &key) {
+        return std::lower_bound(_entries.begin(), _entries.end(), key,
+                                KeyLess());
+    }
+
+    const_iterator lower_bound(const KeyT &key) const {
+        return std::lower_bound(_entries.begin(), _entries.end(), key,
+                                KeyLess());
+    }
+
+    // the first entry whose key is greater than 'key'
+    iterator upper_bound(const KeyT &key) {
+        return std::upper_bound(_entries.begin(), _entries.end(), key,
+                                KeyLess());
+    }
+
+    const_iterator upper_bound(const KeyT &key) const {
+        return std::upper_bound(_entries.begin(), _entries.end(), key,
+                                KeyLess());
+    }
+
+    iterator find(const KeyT &key) {
+        auto it = lower_bound(key);
+        if (it != end() && !(key < it->first))
+            return it;
+        return end();
+    }
+
+    const_iterator find(const KeyT &key) const {
+        auto it = lower_bound(key);
+        if (it != end() && !(key < it->first))
+            return it;
+        return end();
+    }
+
+    size_t count(const KeyT &key) const { return find(key) != end(); }
+
+    ValueT &operator[](const KeyT &key) {
+        auto it = lower_bound(key);
+        if (it == end() || key < it->first)
+            it = _entries.emplace(it, key, ValueT());
+        return it->second;
+    }
+
+    std::pair<iterator, bool> emplace(const KeyT &key, ValueT &&val) {
+        auto it = lower_bound(key);
+        if (it != end() && !(key < it->first))
+            return {it, false};
+        return {_entries.emplace(it, key, std::move(val)), true};
+    }
+
+    iterator erase(const_iterator it) { return _entries.erase(it); }
+
+    size_t erase(const KeyT &key) {
+        auto it = find(key);
+        if (it == end())
+            return 0;
+        _entries.erase(it);
+        return 1;
+    }
+
+    void clear() { _entries.clear(); }
+    void reserve(size_t n) { _entries.reserve(n); }
+    bool empty() const { return _entries.empty(); }
+    size_t size() const { return _entries.size(); }
+
+    iterator begin() { return _entries.begin(); }
+    iterator end() { return _entries.end(); }
+    const_iterator begin() const { return _entries.begin(); }
+    const_iterator end() const { return _entries.end(); }
+
+    void swap(SortedVectorMap &rhs) { _entries.swap(rhs._entries); }
+
+    bool operator==(const SortedVectorMap &rhs) const {
+        return _entries == rhs._entries;
+    }
+
+    bool operator!=(const SortedVectorMap &rhs) const {
+        return !operator==(rhs);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_SORTED_VECTOR_MAP_H_
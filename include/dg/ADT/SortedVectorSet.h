@@ -0,0 +1,96 @@
+#ifndef DG_ADT_SORTED_VECTOR_SET_H_
+#define DG_ADT_SORTED_VECTOR_SET_H_
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace dg {
+namespace ADT {
+
+///
+// Set stored as a sorted vector of elements. It has (a subset of)
+// the interface of std::set, but it does not allocate a node for every
+// element and copying it is one allocation. It is meant for small sets
+// (inserting an element moves the greater elements).
+//
+// NOTE: unlike with std::set, inserting an element invalidates
+// iterators to the set.
+template <typename T>
+class SortedVectorSet {
+  public:
+    using key_type = T;
+    using value_type = T;
+    using ContainerT = std::vector<T>;
+    using iterator = typename ContainerT::const_iterator;
+    using const_iterator = typename ContainerT::const_iterator;
+
+  private:
+    ContainerT _elems;
+
+  public:
+    SortedVectorSet() = default;
+    SortedVectorSet(std::initializer_list<T> elems) {
+        for (const auto &e : elems)
+            insert(e);
+    }
+
+    std::pair<iterator, bool> insert(const T &val) {
+        auto it = std::lower_bound(_elems.begin(), _elems.end(), val);
+        if (it != _elems.end() && !(val < *it))
+            return {it, false};
+        return {_elems.insert(it, val), true};
+    }
+
+    // the hint is ignored, this overload is here
+    // so that the set can be used with std::inserter
+    iterator insert(const_iterator /* hint */, const T &val) {
+        return insert(val).first;
+    }
+
+    template <typename IteratorT>
+    void insert(IteratorT b, IteratorT e) {
+        for (; b != e; ++b)
+            insert(*b);
+    }
+
+    const_iterator find(const T &val) const {
+        auto it = std::lower_bound(_elems.begin(), _elems.end(), val);
+        if (it != _elems.end() && !(val < *it))
+            return it;
+        return _elems.end();
+    }
+
+    size_t count(const T &val) const { return find(val) != end(); }
+
+    size_t erase(const T &val) {
+        auto it = find(val);
+        if (it == end())
+            return 0;
+        _elems.erase(it);
+        return 1;
+    }
+
+    void clear() { _elems.clear(); }
+    bool empty() const { return _elems.empty(); }
+    size_t size() const { return _elems.size(); }
+
+    const_iterator begin() const { return _elems.begin(); }
+    const_iterator end() const { return _elems.end(); }
+
+    void swap(SortedVectorSet &rhs) { _elems.swap(rhs._elems); }
+
+    bool operator==(const SortedVectorSet &rhs) const {
+        return _elems == rhs._elems;
+    }
+
+    bool operator!=(const SortedVectorSet &rhs) const {
+        return !operator==(rhs);
+    }
+};
+
+} // namespace ADT
+} // namespace dg
+
+#endif // DG_ADT_SORTED_VECTOR_SET_H_
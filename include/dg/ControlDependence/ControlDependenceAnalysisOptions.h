@@ -24,6 +24,19 @@ struct ControlDependenceAnalysisOptions : AnalysisOptions {
     // (raising e.g., from calls to exit() which terminates the program)
     bool interprocedural{true};
 
+    // The number of threads used when the dependencies of all functions
+    // are computed at once (compute() without a function). The functions
+    // are independent, so every thread computes the dependencies
+    // of whole functions and the results are the same as with one thread.
+    unsigned workers{1};
+
+    // Compute the dependencies of only the queried nodes (blocks or
+    // instructions) instead of computing the dependencies of the whole
+    // function on the first query. The results are remembered, so every
+    // node is processed at most once. It pays off when only a few nodes
+    // of big functions are queried. Used only by NTSCD.
+    bool nodesOnDemand{false};
+
     bool standardCD() const { return algorithm == CDAlgorithm::STANDARD; }
     bool ntscdCD() const { return algorithm == CDAlgorithm::NTSCD; }
     bool ntscd2CD() const { return algorithm == CDAlgorithm::NTSCD2; }
@@ -44,6 +57,16 @@ struct ControlDependenceAnalysisOptions : AnalysisOptions {
     bool strongCC() const { return algorithm == CDAlgorithm::STRONG_CC; }
     bool interproceduralCD() const { return interprocedural; }
 
+    ControlDependenceAnalysisOptions &setWorkers(unsigned n) {
+        workers = n;
+        return *this;
+    }
+
+    ControlDependenceAnalysisOptions &setNodesOnDemand(bool b) {
+        nodesOnDemand = b;
+        return *this;
+    }
+
     ///
     // Return true if the computed control dependencies
     // contain NTSCD dependencies
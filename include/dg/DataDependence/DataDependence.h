@@ -59,6 +59,21 @@ class DataDependenceAnalysis {
         return _impl->getDefinitions(use);
     }
 
+    // answer more queries at once, the i-th element of the returned
+    // vector are the reaching definitions for the i-th query
+    std::vector<std::vector<RWNode *>>
+    getDefinitions(const std::vector<DefinitionsQuery> &queries) {
+        return _impl->getDefinitions(queries);
+    }
+
+    // answer the query without changing the state of the analysis
+    // (can be called from several threads at once). Return false
+    // if the query must be answered by getDefinitions()
+    bool getKnownDefinitions(const DefinitionsQuery &query,
+                             std::vector<RWNode *> &defs) const {
+        return _impl->getKnownDefinitions(query, defs);
+    }
+
     const DataDependenceAnalysisOptions &getOptions() const { return _options; }
 
     DataDependenceAnalysisImpl *getImpl() { return _impl.get(); }
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <utility>
+#include <vector>
 
 #include "dg/DataDependence/DataDependenceAnalysisOptions.h"
 #include "dg/Offset.h"
@@ -13,6 +14,16 @@
 namespace dg {
 namespace dda {
 
+///
+// A query for the definitions of the bytes [off, off + len) of the memory
+// 'mem' that may reach the location 'where'
+struct DefinitionsQuery {
+    RWNode *where;
+    RWNode *mem;
+    Offset off;
+    Offset len;
+};
+
 // here the types are for type-checking (optional - user can do it
 // when building the graph) and for later optimizations
 
@@ -52,6 +63,27 @@ class DataDependenceAnalysisImpl {
     // return reaching definitions of a node that represents
     // the given use
     virtual std::vector<RWNode *> getDefinitions(RWNode *use) = 0;
+
+    // Answer more queries at once. The i-th element of the returned
+    // vector are the reaching definitions for the i-th query.
+    virtual std::vector<std::vector<RWNode *>>
+    getDefinitions(const std::vector<DefinitionsQuery> &queries) {
+        std::vector<std::vector<RWNode *>> ret;
+        ret.reserve(queries.size());
+        for (const auto &q : queries)
+            ret.push_back(getDefinitions(q.where, q.mem, q.off, q.len));
+        return ret;
+    }
+
+    // Answer the query without changing the state of the analysis,
+    // so that it can be called from several threads at once (but not
+    // concurrently with other methods). Return false if the query cannot
+    // be answered without changing the state, the query must be then
+    // answered by getDefinitions().
+    virtual bool getKnownDefinitions(const DefinitionsQuery & /*query*/,
+                                     std::vector<RWNode *> & /*defs*/) const {
+        return false;
+    }
 };
 
 } // namespace dda
@@ -129,11 +129,24 @@ struct DataDependenceAnalysisOptions : AnalysisOptions {
         return undefinedFunsBehavior & dda::READ_ARGS;
     }
 
+    // The number of threads used by the memory SSA. With more than one
+    // thread, the definitions of all uses are computed eagerly in run()
+    // (instead of on demand). The threads perform LVN of basic blocks
+    // and find the definitions from the beginning of blocks to uses,
+    // PHI nodes are created by one thread in the same order as without
+    // threads, so the results are the same as with one thread.
+    unsigned workers{1};
+
     DataDependenceAnalysisOptions &setFieldInsensitive(bool b) {
         fieldInsensitive = b;
         return *this;
     }
 
+    DataDependenceAnalysisOptions &setWorkers(unsigned n) {
+        workers = n;
+        return *this;
+    }
+
     std::map<const std::string, FunctionModel> functionModels;
 
     const FunctionModel *getFunctionModel(const std::string &name) const {
@@ -51,6 +51,20 @@ struct Definitions {
         return retval;
     }
 
+    ///
+    /// append the definition-sites for the given 'ds' to 'defs'
+    /// (the same as get(), but without allocating a set).
+    /// Return the number of appended nodes.
+    ///
+    size_t gather(const DefSite &ds, std::vector<RWNode *> &defs) const {
+        auto n = definitions.gather(ds, defs);
+        if (n == 0) {
+            defs.insert(defs.end(), unknownWrites.begin(), unknownWrites.end());
+            n = unknownWrites.size();
+        }
+        return n;
+    }
+
     // update this Definitions by definitions from 'node'.
     // I.e., as if node would be executed when already
     // having the definitions we have
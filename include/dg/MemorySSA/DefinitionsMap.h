@@ -1,6 +1,7 @@
 #ifndef DG_DEFINITIONS_MAP_H_
 #define DG_DEFINITIONS_MAP_H_
 
+#include <algorithm>
 #include <set>
 #include <unordered_map>
 #include <vector>
@@ -9,6 +10,7 @@
 #endif
 
 #include "dg/ADT/DisjunctiveIntervalMap.h"
+#include "dg/ADT/SortedVectorSet.h"
 #include "dg/Offset.h"
 #include "dg/ReadWriteGraph/DefSite.h"
 
@@ -20,11 +22,14 @@ class ReachingDefinitionsAnalysis;
 
 /// A data structure that represents a mapping
 /// DefSite -> RWNode, that is, it stores which memory (DefSite)
-/// was defined where.
+/// was defined where. The nodes that define an interval of bytes
+/// are kept in a sorted vector. The lookups that are done often
+/// (forEach, gather) do not allocate any memory on their own.
 template <typename NodeT = RWNode>
 class DefinitionsMap {
   public:
-    using OffsetsT = ADT::DisjunctiveIntervalMap<NodeT *>;
+    using OffsetsT = ADT::DisjunctiveIntervalMap<NodeT *, Offset,
+                                                 ADT::SortedVectorSet<NodeT *>>;
     using IntervalT = typename OffsetsT::IntervalT;
 
   private:
@@ -106,15 +111,44 @@ class DefinitionsMap {
     }
 
     ///
-    // Get definitions of the memory described by 'ds'
-    std::set<NodeT *> get(const DefSite &ds) {
+    // Call fun(node) for every definition of the memory described by 'ds'.
+    // A node may be visited several times (if it defines more intervals
+    // of the memory).
+    template <typename FunT>
+    void forEach(const DefSite &ds, FunT fun) const {
         auto it = _definitions.find(ds.target);
         if (it == _definitions.end())
-            return {};
+            return;
 
         Offset start, end;
         std::tie(start, end) = getInterval(ds);
-        return it->second.gather(start, end);
+        it->second.forEachOverlapping(
+                IntervalT(start, end),
+                [&fun](const IntervalT &, const typename OffsetsT::ValuesT &S) {
+                    for (auto *n : S)
+                        fun(n);
+                });
+    }
+
+    ///
+    // Append definitions of the memory described by 'ds' to 'defs'.
+    // The appended nodes are sorted and unique (the nodes that were
+    // in 'defs' before are not touched). Return the number of appended nodes.
+    size_t gather(const DefSite &ds, std::vector<NodeT *> &defs) const {
+        auto oldsize = defs.size();
+        forEach(ds, [&defs](NodeT *n) { defs.push_back(n); });
+        auto b = defs.begin() + oldsize;
+        std::sort(b, defs.end());
+        defs.erase(std::unique(b, defs.end()), defs.end());
+        return defs.size() - oldsize;
+    }
+
+    ///
+    // Get definitions of the memory described by 'ds'
+    std::set<NodeT *> get(const DefSite &ds) const {
+        std::set<NodeT *> ret;
+        forEach(ds, [&ret](NodeT *n) { ret.insert(n); });
+        return ret;
     }
 
     ///
@@ -168,14 +202,21 @@ class DefinitionsMap {
         return retval;
     }
 
-    // FIXME: do that as iterators
-    std::set<NodeT *> values() const {
-        std::set<NodeT *> ret;
+    // Call fun(node) for every node in the map. A node may be visited
+    // several times.
+    template <typename FunT>
+    void forEachValue(FunT fun) const {
         for (auto &it : _definitions) {
             for (auto &it2 : it.second) {
-                ret.insert(it2.second.begin(), it2.second.end());
+                for (auto *n : it2.second)
+                    fun(n);
             }
         }
+    }
+
+    std::set<NodeT *> values() const {
+        std::set<NodeT *> ret;
+        forEachValue([&ret](NodeT *n) { ret.insert(n); });
         return ret;
     }
 
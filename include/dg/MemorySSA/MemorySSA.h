@@ -14,6 +14,7 @@
 
 #include "dg/ReadWriteGraph/ReadWriteGraph.h"
 
+#include "dg/ADT/Bitvector.h"
 #include "dg/ADT/Queue.h"
 #include "dg/util/debug.h"
 
@@ -56,17 +57,20 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
             void addOutput(const DefSite &ds, RWNode *n) { outputs.add(ds, n); }
 
             RWNode *getUnknownPhi() {
-                // FIXME: optimize this, we create std::set for nothing...
-                auto S = inputs.get({UNKNOWN_MEMORY, 0, Offset::UNKNOWN});
-                if (S.empty()) {
-                    return nullptr;
-                }
-                assert(S.size() == 1);
-                return *(S.begin());
+                RWNode *phi = nullptr;
+                inputs.forEach({UNKNOWN_MEMORY, 0, Offset::UNKNOWN},
+                               [&phi](RWNode *n) {
+                                   assert((!phi || phi == n) &&
+                                          "Multiple unknown phis");
+                                   phi = n;
+                               });
+                return phi;
             }
 
-            std::set<RWNode *> getOutputs(const DefSite &ds) {
-                return outputs.get(ds);
+            std::vector<RWNode *> getOutputs(const DefSite &ds) {
+                std::vector<RWNode *> ret;
+                outputs.gather(ds, ret);
+                return ret;
             }
             auto getUncoveredOutputs(const DefSite &ds) const
                     -> decltype(outputs.undefinedIntervals(ds)) {
@@ -106,6 +110,8 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
                                               const RWNode *mem = nullptr);
     static Definitions findEscapingDefinitionsInBlock(RWNode *to);
     static void performLvn(Definitions & /*D*/, RWBBlock * /*block*/);
+    // perform LVN of all (non-call) blocks, in parallel if requested
+    void performLvnOfAllBlocks();
     void updateDefinitions(Definitions &D, RWNode *node);
 
     ///
@@ -118,6 +124,9 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
 
     // Find definitions for the given node (which is supposed to be a use)
     std::vector<RWNode *> findDefinitions(RWNode *node);
+    // The same as above, but 'D' are the definitions from the beginning
+    // of the block of the node to the node (see findDefinitionsInBlock)
+    std::vector<RWNode *> findDefinitions(RWNode *node, Definitions &D);
 
     std::vector<RWNode *> findDefinitionsInPredecessors(RWBBlock *block,
                                                         const DefSite &ds);
@@ -187,8 +196,12 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
     void addDefinitionsFromCalledValue(RWNode *phi, RWNodeCall *C,
                                        const DefSite &ds, RWNode *calledValue);
 
-    void computeModRef(RWSubgraph *subg, SubgraphInfo &si);
-    bool callMayDefineTarget(RWNodeCall *C, RWNode *target);
+    // compute ModRef information of all subgraphs
+    void computeModRef();
+    // ModRef information of the subgraph without the effects of
+    // the called subgraphs
+    void computeLocalModRef(RWSubgraph *subg, SubgraphInfo &si);
+    bool callMayDefineTarget(RWNodeCall *C, RWNode *target) const;
 
     RWNode *createPhi(const DefSite &ds, RWNodeType type = RWNodeType::PHI);
     RWNode *createPhi(Definitions &D, const DefSite &ds,
@@ -200,6 +213,28 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
                       const Offset &len);
 
     std::vector<RWNode *> _phis;
+
+    // Cache of non-PHI definitions of PHI nodes. The PHI nodes from one SCC
+    // of the graph of PHI nodes share the index of the result in 'defs'.
+    struct NonPhiDefsCache {
+        std::unordered_map<const RWNode *, unsigned> scc;
+        std::vector<ADT::SparseBitvectorHashImpl> defs;
+        // the number of PHI nodes when the cache was filled
+        size_t phis{0};
+    } _nonPhiDefs;
+
+    const ADT::SparseBitvectorHashImpl &getNonPhiDefs(RWNode *phi);
+    template <typename ContT>
+    std::vector<RWNode *> gatherNonPhisDefs(ContT &nodes);
+
+    // searching definitions without changing the state of the analysis
+    const Definitions *getKnownBBlockDefinitions(RWBBlock *b,
+                                                 const DefSite &ds,
+                                                 Definitions &tmp) const;
+    bool findKnownDefinitionsInPredecessors(RWBBlock *block,
+                                            const DefSite &ds,
+                                            std::vector<RWNode *> &defs,
+                                            std::set<RWBBlock *> &path) const;
     dg::ADT::QueueLIFO<RWNode> _queue;
     std::unordered_map<const RWSubgraph *, SubgraphInfo> _subgraphs_info;
 
@@ -251,6 +286,17 @@ class MemorySSATransformation : public DataDependenceAnalysisImpl {
 
     std::vector<RWNode *> getDefinitions(RWNode *use) override;
 
+    // answer the queries without inserting MU nodes into the graph,
+    // every block with queried locations is processed at once
+    std::vector<std::vector<RWNode *>>
+    getDefinitions(const std::vector<DefinitionsQuery> &queries) override;
+
+    // answer the query using only the definitions that were already
+    // found (e.g., by computeAllDefinitions() or getDefinitions()),
+    // it fails if a new PHI node would be needed
+    bool getKnownDefinitions(const DefinitionsQuery &query,
+                             std::vector<RWNode *> &defs) const override;
+
     const Definitions *getDefinitions(RWBBlock *b) const {
         const auto *bi = getBBlockInfo(b);
         return bi ? &bi->getDefinitions() : nullptr;
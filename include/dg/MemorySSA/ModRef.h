@@ -66,10 +66,12 @@ class ModRefInfo {
         }
     }
 
-    void add(const ModRefInfo &oth) {
-        maydef.add(oth.maydef);
-        mayref.add(oth.mayref);
-        mustdef.add(oth.mustdef);
+    bool add(const ModRefInfo &oth) {
+        bool changed = false;
+        changed |= maydef.add(oth.maydef);
+        changed |= mayref.add(oth.mayref);
+        changed |= mustdef.add(oth.mustdef);
+        return changed;
     }
 
     ///
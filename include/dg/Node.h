@@ -1,6 +1,8 @@
 #ifndef NODE_H_
 #define NODE_H_
 
+#include <atomic>
+
 #include "ADT/DGContainer.h"
 #include "DGParameters.h"
 #include "legacy/Analysis.h"
@@ -332,6 +334,9 @@ class Node {
 
     KeyT getKey() const { return key; }
 
+    // the unique number of the node (among the nodes of this type)
+    unsigned int getID() const { return id; }
+
     uint32_t getSlice() const { return slice_id; }
     uint32_t setSlice(uint32_t sid) {
         uint32_t old = slice_id;
@@ -394,6 +399,11 @@ class Node {
     // actual parameters if this is a callsite
     DGParameters<NodeT> *parameters{nullptr};
 
+    // the counter used to number the nodes (nodes may be created
+    // by several threads at once)
+    static std::atomic<unsigned int> last_id;
+    const unsigned int id{++last_id};
+
     // id of the slice this nodes is in. If it is 0, it is in no slice
     uint32_t slice_id{0};
 
@@ -408,6 +418,10 @@ class Node {
     friend class legacy::Analysis<NodeT>;
 };
 
+// counter definition
+template <typename DependenceGraphT, typename KeyT, typename NodeT>
+std::atomic<unsigned int> Node<DependenceGraphT, KeyT, NodeT>::last_id{0};
+
 } // namespace dg
 
 #endif // _NODE_H_
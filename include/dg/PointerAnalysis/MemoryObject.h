@@ -12,12 +12,18 @@
 #endif // not NDEBUG
 
 #include "PointsToSet.h"
+#include "dg/ADT/SortedVectorMap.h"
 
 namespace dg {
 namespace pta {
 
 struct MemoryObject {
-    using PointsToMapT = std::map<Offset, PointsToSetT>;
+    // Objects usually have pointers only at few offsets, so the offsets
+    // are kept sorted in a flat vector. Offset::UNKNOWN is the greatest
+    // offset, so its entry (if any) is always the last one.
+    using PointsToMapT = ADT::SortedVectorMap<Offset, PointsToSetT>;
+    using RangeT =
+            std::pair<PointsToMapT::const_iterator, PointsToMapT::const_iterator>;
 
     MemoryObject(/*uint64_t s = 0, bool isheap = false, */ PSNode *n = nullptr)
             : node(n) /*, is_heap(isheap), size(s)*/ {}
@@ -40,6 +46,22 @@ struct MemoryObject {
     PointsToMapT::const_iterator begin() const { return pointsTo.begin(); }
     PointsToMapT::const_iterator end() const { return pointsTo.end(); }
 
+    // Get the entries with known offsets from the interval
+    // [from, from + len). If 'from' is unknown, return all the entries
+    // with known offsets, if 'len' is unknown, return all the entries
+    // with known offsets starting at 'from'.
+    RangeT getRange(const Offset from, const Offset len) const {
+        auto last = pointsTo.lower_bound(Offset::UNKNOWN);
+        if (from.isUnknown())
+            return {pointsTo.begin(), last};
+
+        auto first = pointsTo.lower_bound(from);
+        // the sum is Offset::UNKNOWN if it overflows
+        if (!len.isUnknown())
+            last = pointsTo.lower_bound(from + len);
+        return {first, last};
+    }
+
     bool merge(const MemoryObject &rhs) {
         bool changed = false;
         for (const auto &rit : rhs.pointsTo) {
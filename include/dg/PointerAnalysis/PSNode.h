@@ -137,6 +137,10 @@ class PSNode : public SubgraphNode<PSNode> {
     // in some cases we need to know from which function the node is
     PointerSubgraph *_parent = nullptr;
 
+    // the table of IDs of pointers to this node
+    // (the table of the graph that owns the node)
+    PointerIDLookupTable *_pointerIDs = nullptr;
+
     unsigned int dfsid = 0;
 
   public:
@@ -188,18 +192,7 @@ class PSNode : public SubgraphNode<PSNode> {
     //               invalidates memory after returning from a function
     // FREE:         invalidates memory after calling free function on a pointer
 
-    PSNode(IDType id, PSNodeType t) : SubgraphNode<PSNode>(id), type(t) {
-        switch (type) {
-        case PSNodeType::ALLOC:
-        case PSNodeType::FUNCTION:
-            // these always points-to itself
-            // (they points to the node where the memory was allocated)
-            addPointsTo(this, 0);
-            break;
-        default:
-            break;
-        }
-    }
+    PSNode(IDType id, PSNodeType t) : SubgraphNode<PSNode>(id), type(t) {}
 
     // Unfortunately, constructors cannot use enums in templates
     template <typename... Args>
@@ -216,6 +209,27 @@ class PSNode : public SubgraphNode<PSNode> {
         return type == PSNodeType::CALL || type == PSNodeType::CALL_FUNCPTR;
     }
 
+    // Set the table of IDs of pointers to this node. This is done
+    // by the graph that creates the node, pointers to the node
+    // cannot be created before.
+    void setPointerIDs(PointerIDLookupTable *ids) {
+        assert(!_pointerIDs && "The node already has the table");
+        _pointerIDs = ids;
+
+        switch (type) {
+        case PSNodeType::ALLOC:
+        case PSNodeType::FUNCTION:
+            // these always points-to itself
+            // (they points to the node where the memory was allocated)
+            addPointsTo(this, 0);
+            break;
+        default:
+            break;
+        }
+    }
+
+    PointerIDLookupTable *getPointerIDs() const { return _pointerIDs; }
+
     void setParent(PointerSubgraph *p) { _parent = p; }
     PointerSubgraph *getParent() { return _parent; }
     const PointerSubgraph *getParent() const { return _parent; }
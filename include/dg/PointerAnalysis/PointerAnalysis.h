@@ -2,6 +2,8 @@
 #define DG_POINTER_ANALYSIS_H_
 
 #include <cassert>
+#include <set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -10,6 +12,7 @@
 #include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointerAnalysisOptions.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
+#include "dg/PointerAnalysis/PointsToMapping.h"
 
 namespace dg {
 namespace pta {
@@ -28,6 +31,61 @@ class PointerAnalysis {
 
     const PointerAnalysisOptions options{};
 
+    // the number of the current round of the fixpoint computation
+    // (one round is one call of iteration())
+    unsigned _round{1};
+    // how many times we called processNode
+    size_t _processedNodes{0};
+    // the number of iterations of the main fixpoint loop
+    size_t _iterations{0};
+
+    // priorities of nodes (indexed by IDs of nodes) for
+    // the topological scheduling, lower number goes first
+    std::vector<unsigned> _priorities;
+
+    // Information used by the difference propagation
+    // (PointerAnalysisOptions::differencePropagation)
+    struct DeltaInfo {
+        // the round in which the node was processed the last time
+        // (0 if the node has not been processed yet)
+        unsigned processed{0};
+        // the number of operands that the node had at that time
+        size_t operandsNum{0};
+        // the last two rounds in which the points-to set of
+        // the node changed
+        unsigned changed{0};
+        unsigned prevChanged{0};
+        // the pointers added to the node in the round 'changed'
+        PointsToSetT delta;
+    };
+
+    // indexed by the IDs of nodes
+    std::vector<DeltaInfo> _deltas;
+    // the last round in which a memory object changed
+    // (used only if canTrackObjectChanges() returns true)
+    std::unordered_map<const MemoryObject *, unsigned> _objectsChanged;
+
+    // Online cycle collapsing (PointerAnalysisOptions::collapseCycles).
+    // Nodes that only copy pointers and that form a cycle must have
+    // the same points-to sets, so they share the points-to set
+    // of one of them (the representative) during the analysis.
+    bool _collapseCycles{false};
+    // representatives of nodes, indexed by the IDs of nodes
+    // (nullptr if the node represents itself)
+    std::vector<PSNode *> _representatives;
+    // the copy edges (pairs of IDs of nodes) that we already checked
+    std::set<std::pair<unsigned, unsigned>> _checkedCopyEdges;
+    // collapsed nodes mapped to their representatives
+    PointsToMapping<PSNode *> _collapsed;
+
+    // Parallel processing of nodes (PointerAnalysisOptions::workers)
+    bool _parallel{false};
+    // marks of nodes that are written (1) or read (2) by the nodes
+    // of the current wave of nodes processed in parallel
+    // (indexed by the IDs of nodes, valid if the stamp is the current one)
+    std::vector<std::pair<unsigned, char>> _waveMarks;
+    unsigned _waveStamp{0};
+
   public:
     PointerAnalysis(PointerGraph *ps, PointerAnalysisOptions opts)
             : PG(ps), options(std::move(opts)) {
@@ -46,6 +104,15 @@ class PointerAnalysis {
     virtual void getMemoryObjects(PSNode *where, const Pointer &pointer,
                                   std::vector<MemoryObject *> &objects) = 0;
 
+    // Called before writing new pointers to the object 'mo'
+    // that was returned by getMemoryObjects(where, ...).
+    // Returns the object that should be written to, so that the analysis
+    // can share memory objects and copy them only when they change.
+    virtual MemoryObject *getWritableObject(PSNode * /*where*/,
+                                            MemoryObject *mo) {
+        return mo;
+    }
+
     /*
     virtual bool addEdge(MemoryObject *from, MemoryObject *to,
                          Offset off1 = 0, Offset off2 = 0)
@@ -66,8 +133,68 @@ class PointerAnalysis {
 
     virtual void enqueue(PSNode *n) { changed.push_back(n); }
 
+    // Get the nodes that must be processed in the next iteration
+    // because the nodes 'changed' changed. By default, these are all
+    // the nodes reachable from the changed nodes.
+    virtual std::vector<PSNode *>
+    getNodesToProcess(const std::vector<PSNode *> &changed,
+                      unsigned expected_num) {
+        // DONT std::move - it prevents compiler from copy ellision
+        auto nodes = PG->getNodes(changed /* starting set */,
+                                  true /* interprocedural */,
+                                  expected_num /* expected num */);
+
+        // since changed was not empty,
+        // the nodes must not be empty too
+        assert(!nodes.empty());
+        assert(nodes.size() >= changed.size());
+        return nodes;
+    }
+
+    // Return true if memory objects are modified only by processing
+    // the nodes (i.e., not in the hooks of the analysis).
+    // In that case, the difference propagation may skip
+    // reading memory objects that did not change.
+    virtual bool canTrackObjectChanges() const { return false; }
+
+    // Return true if the points-to sets of nodes that only copy pointers
+    // may be shared while the analysis runs (i.e., the analysis does not
+    // read the points-to sets of such nodes in its hooks).
+    virtual bool canCollapseCycles() const { return false; }
+
+    // Return true if the nodes that compute only their own points-to sets
+    // (i.e., not STORE, MEMCPY, calls via pointers, ...) may be processed
+    // by several threads at once. That is, getMemoryObjects() and the hooks
+    // of the analysis are thread-safe for such nodes (when no other
+    // nodes are processed at the same time).
+    virtual bool canProcessInParallel() const { return false; }
+
+    // Called before processing a group of nodes in parallel,
+    // the analysis may prepare its state for the parallel processing here
+    // (e.g., create the objects that would be created lazily).
+    virtual void prepareParallelProcessing() {}
+
+    // Nodes that were collapsed into a representative node by the online
+    // cycle detection. The points-to sets of the collapsed nodes are set
+    // to the points-to sets of their representatives when the analysis
+    // finishes.
+    const PointsToMapping<PSNode *> &getCollapsedNodes() const {
+        return _collapsed;
+    }
+
     virtual void preprocess() {}
 
+    // forget the state of the solver (not the points-to sets),
+    // so that the analysis can be run again
+    void resetSolverState() {
+        _priorities.clear();
+        _deltas.clear();
+        _objectsChanged.clear();
+        _representatives.clear();
+        _checkedCopyEdges.clear();
+        _collapsed = PointsToMapping<PSNode *>();
+    }
+
     void initialize_queue() {
         assert(to_process.empty());
 
@@ -75,6 +202,9 @@ class PointerAnalysis {
         assert(root && "Do not have root of PG");
         // rely on C++11 move semantics
         to_process = PG->getNodes(root);
+        if (options.scheduling ==
+            PointerAnalysisOptions::Scheduling::TOPOLOGICAL)
+            sortByPriorities(to_process);
     }
 
     void queue_globals() {
@@ -87,16 +217,24 @@ class PointerAnalysis {
     bool iteration() {
         assert(changed.empty());
 
+        if (_parallel) {
+            parallelIteration();
+            ++_round;
+            return !changed.empty();
+        }
+
         for (PSNode *cur : to_process) {
             bool enq = false;
             enq |= beforeProcessed(cur);
             enq |= processNode(cur);
             enq |= afterProcessed(cur);
+            ++_processedNodes;
 
             if (enq)
                 enqueue(cur);
         }
 
+        ++_round;
         return !changed.empty();
     }
 
@@ -105,20 +243,20 @@ class PointerAnalysis {
         to_process.clear();
 
         if (!changed.empty()) {
-            // DONT std::move - it prevents compiler from copy ellision
-            to_process = PG->getNodes(changed /* starting set */,
-                                      true /* interprocedural */,
-                                      last_processed_num /* expected num */);
-
-            // since changed was not empty,
-            // the to_process must not be empty too
-            assert(!to_process.empty());
-            assert(to_process.size() >= changed.size());
+            to_process = getNodesToProcess(changed, last_processed_num);
             changed.clear();
+
+            if (options.scheduling ==
+                PointerAnalysisOptions::Scheduling::TOPOLOGICAL)
+                sortByPriorities(to_process);
         }
     }
 
-    bool run();
+    virtual bool run();
+
+    // statistics of the last run
+    size_t getProcessedNodesNum() const { return _processedNodes; }
+    size_t getIterationsNum() const { return _iterations; }
 
     // generic error
     // @msg - message for the user
@@ -163,12 +301,51 @@ class PointerAnalysis {
     void sanityCheck();
 
     bool processNode(PSNode * /*node*/);
+    bool processStore(PSNode *node);
     bool processLoad(PSNode *node);
     bool processGep(PSNode *node);
     bool processMemcpy(PSNode *node);
-    bool processMemcpy(std::vector<MemoryObject *> &srcObjects,
+    bool processMemcpy(PSNode *node, std::vector<MemoryObject *> &srcObjects,
                        std::vector<MemoryObject *> &destObjects,
                        const Pointer &sptr, const Pointer &dptr, Offset len);
+
+    // topological scheduling
+    void computePriorities();
+    void sortByPriorities(std::vector<PSNode *> &nodes);
+
+    // parallel processing of nodes
+    void parallelIteration();
+    bool processesOnlyItself(const PSNode *node) const;
+    bool processWithHooks(PSNode *node);
+    void processWave(const std::vector<PSNode *> &wave);
+
+    // online cycle collapsing
+    PSNode *getRepresentative(PSNode *node) {
+        if (_representatives.size() <= node->getID() ||
+            _representatives[node->getID()] == nullptr)
+            return node;
+        PSNode *rep = getRepresentative(_representatives[node->getID()]);
+        _representatives[node->getID()] = rep;
+        return rep;
+    }
+    PointsToSetT &getPointsTo(PSNode *node) {
+        return getRepresentative(node)->pointsTo;
+    }
+    bool isCopyNode(const PSNode *node) const;
+    bool detectCycles(PSNode *node);
+    bool collapse(const std::vector<PSNode *> &scc);
+    void finalizeCollapsedNodes();
+
+    // difference propagation
+    DeltaInfo &getDeltaInfo(const PSNode *node);
+    const PointsToSetT *getNewPointers(PSNode *node, size_t idx);
+    bool objectChanged(PSNode *node, const MemoryObject *mo) const;
+    bool addPointsTo(PSNode *node, const Pointer &ptr);
+    bool addPointsTo(PSNode *node, const PointsToSetT &ptrs);
+    bool addPointsTo(PSNode *where, MemoryObject *mo, const Offset &off,
+                     const Pointer &ptr);
+    bool addPointsTo(PSNode *where, MemoryObject *mo, const Offset &off,
+                     const PointsToSetT &ptrs);
 };
 
 } // namespace pta
@@ -15,6 +15,19 @@ namespace pta {
 //
 class PointerAnalysisFI : public PointerAnalysis {
     std::vector<std::unique_ptr<MemoryObject>> memory_objects;
+    // the number of nodes for which we created memory objects
+    // in prepareParallelProcessing()
+    size_t _preparedNodes{0};
+
+    MemoryObject *getOrCreateObject(PSNode *n) {
+        MemoryObject *mo = n->getData<MemoryObject>();
+        if (!mo) {
+            mo = new MemoryObject(n);
+            memory_objects.emplace_back(mo);
+            n->setData<MemoryObject>(mo);
+        }
+        return mo;
+    }
 
     void preprocessGEPs() {
         // if a node is in a loop (a scc that has more than one node),
@@ -43,6 +56,23 @@ class PointerAnalysisFI : public PointerAnalysis {
                 std::max(ps->size() / 100, static_cast<size_t>(8)));
     }
 
+    // memory objects are changed only by stores and memcpy
+    bool canTrackObjectChanges() const override { return true; }
+    bool canCollapseCycles() const override { return true; }
+    bool canProcessInParallel() const override { return true; }
+
+    // create the memory objects for all allocations, so that
+    // getMemoryObjects() does not modify anything
+    void prepareParallelProcessing() override {
+        const auto &nodes = getPG()->getNodes();
+        for (; _preparedNodes < nodes.size(); ++_preparedNodes) {
+            PSNode *n = nodes[_preparedNodes].get();
+            if (n && (n->getType() == PSNodeType::ALLOC ||
+                      n->getType() == PSNodeType::UNKNOWN_MEM))
+                getOrCreateObject(n);
+        }
+    }
+
     void preprocess() override {
         if (options.preprocessGeps)
             preprocessGEPs();
@@ -68,14 +98,7 @@ class PointerAnalysisFI : public PointerAnalysis {
         assert(n->getType() == PSNodeType::ALLOC ||
                n->getType() == PSNodeType::UNKNOWN_MEM);
 
-        MemoryObject *mo = n->getData<MemoryObject>();
-        if (!mo) {
-            mo = new MemoryObject(n);
-            memory_objects.emplace_back(mo);
-            n->setData<MemoryObject>(mo);
-        }
-
-        objects.push_back(mo);
+        objects.push_back(getOrCreateObject(n));
     }
 };
 
@@ -6,6 +6,7 @@
 
 #include "MemoryObject.h"
 #include "PointerGraph.h"
+#include "dg/util/cow_shared_ptr.h"
 
 namespace dg {
 namespace pta {
@@ -16,7 +17,9 @@ namespace pta {
 class PointerAnalysisFS : public PointerAnalysis {
   public:
     // using MemoryObjectsSetT = std::set<MemoryObject *>;
-    using MemoryMapT = std::map<PSNode *, std::unique_ptr<MemoryObject>>;
+    // Memory objects are shared between memory maps and copied
+    // only when a node that can change the memory writes to them.
+    using MemoryMapT = std::map<PSNode *, cow_shared_ptr<MemoryObject>>;
 
     // this is an easy but not very efficient implementation,
     // works for testing
@@ -127,7 +130,9 @@ class PointerAnalysisFS : public PointerAnalysis {
 
         auto I = mm->find(pointer.target);
         if (I != mm->end()) {
-            objects.push_back(I->second.get());
+            // the object may be shared with other memory maps,
+            // writes go through getWritableObject()
+            objects.push_back(const_cast<MemoryObject *>(I->second.get()));
         }
 
         // if we haven't found any memory object, but this psnode
@@ -135,11 +140,23 @@ class PointerAnalysisFS : public PointerAnalysis {
         // the write has something to write to
         if (objects.empty() && canChangeMM(where)) {
             MemoryObject *mo = new MemoryObject(pointer.target);
-            mm->emplace(pointer.target, std::unique_ptr<MemoryObject>(mo));
+            mm->emplace(pointer.target, mo);
             objects.push_back(mo);
         }
     }
 
+    MemoryObject *getWritableObject(PSNode *where, MemoryObject *mo) override {
+        MemoryMapT *mm = where->getData<MemoryMapT>();
+        assert(mm && "Node does not have memory map");
+        assert(canChangeMM(where) && "Writing to a memory map of other node");
+
+        // the object may have been copied already by a previous write,
+        // so look it up in the map
+        auto I = mm->find(mo->node);
+        assert(I != mm->end() && "The object is not in the memory map");
+        return I->second.getWritable();
+    }
+
   protected:
     static bool canChangeMM(PSNode *n) {
         switch (n->getType()) {
@@ -165,15 +182,53 @@ class PointerAnalysisFS : public PointerAnalysis {
         return false;
     }
 
-    static bool mergeObjects(PSNode *node, MemoryObject *to, MemoryObject *from,
+    static bool includes(const PointsToSetT &S, const PointsToSetT &what) {
+        for (const auto &ptr : what) {
+            if (!S.has(ptr))
+                return false;
+        }
+        return true;
+    }
+
+    static bool overwrites(PSNode *node, const MemoryObject *mo,
+                           PointsToSetT *overwritten) {
+        if (!overwritten)
+            return false;
+
+        for (const auto &it : mo->pointsTo) {
+            if (overwritten->count(Pointer(node, it.first)))
+                return true;
+        }
+        return false;
+    }
+
+    static bool hasPointers(const MemoryObject *mo) {
+        for (const auto &it : mo->pointsTo) {
+            if (!it.second.empty())
+                return true;
+        }
+        return false;
+    }
+
+    static bool mergeObjects(PSNode *node, cow_shared_ptr<MemoryObject> &to,
+                             const MemoryObject *from,
                              PointsToSetT *overwritten) {
         bool changed = false;
+        MemoryObject *writable = nullptr;
 
-        for (auto &fromIt : from->pointsTo) {
+        for (const auto &fromIt : from->pointsTo) {
             if (overwritten && overwritten->count(Pointer(node, fromIt.first)))
                 continue;
 
-            auto &S = to->pointsTo[fromIt.first];
+            // do not copy the shared object if there is nothing new
+            if (!writable) {
+                auto it = to->find(fromIt.first);
+                if (it != to->end() && includes(it->second, fromIt.second))
+                    continue;
+                writable = to.getWritable();
+            }
+
+            auto &S = writable->pointsTo[fromIt.first];
             for (const auto &ptr : fromIt.second)
                 changed |= S.add(ptr);
         }
@@ -181,19 +236,35 @@ class PointerAnalysisFS : public PointerAnalysis {
         return changed;
     }
 
+    // Merge the memory object 'from' for the target 'fromTarget' into
+    // the memory map, return true if any new information was created
+    static bool mergeObject(MemoryMapT *mm, PSNode *fromTarget,
+                            const cow_shared_ptr<MemoryObject> &from,
+                            PointsToSetT *overwritten) {
+        auto toIt = mm->find(fromTarget);
+        if (toIt == mm->end()) {
+            // share the object if we take it as it is
+            if (!overwrites(fromTarget, from.get(), overwritten)) {
+                mm->emplace_hint(toIt, fromTarget, from);
+                return hasPointers(from.get());
+            }
+            toIt = mm->emplace_hint(toIt, fromTarget,
+                                    new MemoryObject(fromTarget));
+        } else if (toIt->second == from) {
+            // the same object, nothing can change
+            return false;
+        }
+
+        return mergeObjects(fromTarget, toIt->second, from.get(), overwritten);
+    }
+
     // Merge two Memory maps, return true if any new information was created,
     // otherwise return false
     static bool mergeMaps(MemoryMapT *mm, MemoryMapT *from,
                           PointsToSetT *overwritten) {
         bool changed = false;
         for (auto &it : *from) {
-            PSNode *fromTarget = it.first;
-            std::unique_ptr<MemoryObject> &toMo = (*mm)[fromTarget];
-            if (toMo == nullptr)
-                toMo.reset(new MemoryObject(fromTarget));
-
-            changed |= mergeObjects(fromTarget, toMo.get(), it.second.get(),
-                                    overwritten);
+            changed |= mergeObject(mm, it.first, it.second, overwritten);
         }
 
         return changed;
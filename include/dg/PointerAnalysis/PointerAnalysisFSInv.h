@@ -18,13 +18,34 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
         return canInvalidateMM(n) || PointerAnalysisFS::needsMerge(n);
     }
 
-    static MemoryObject *getOrCreateMO(MemoryMapT *mm, PSNode *target) {
-        std::unique_ptr<MemoryObject> &moptr = (*mm)[target];
+    static cow_shared_ptr<MemoryObject> &getOrCreateMO(MemoryMapT *mm,
+                                                       PSNode *target) {
+        auto &moptr = (*mm)[target];
         if (!moptr)
             moptr.reset(new MemoryObject(target));
 
         assert(mm->find(target) != mm->end());
-        return moptr.get();
+        return moptr;
+    }
+
+    // Get the points-to set for the offset 'off' for writing. The object
+    // may be shared with other memory maps, so it is copied only on
+    // the first write and 'mo' then caches the writable object.
+    static PointsToSetT &writableSet(cow_shared_ptr<MemoryObject> &moptr,
+                                     MemoryObject *&mo, Offset off) {
+        if (!mo)
+            mo = moptr.getWritable();
+        return mo->pointsTo[off];
+    }
+
+    static bool addPointer(cow_shared_ptr<MemoryObject> &moptr,
+                           MemoryObject *&mo, Offset off, const Pointer &ptr) {
+        if (!mo) {
+            auto it = moptr->find(off);
+            if (it != moptr->end() && it->second.has(ptr))
+                return false;
+        }
+        return writableSet(moptr, mo, off).add(ptr);
     }
 
   public:
@@ -106,7 +127,7 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
                alloc->getParent() == where->getParent();
     }
 
-    static bool containsRemovableLocals(PSNode *where, PointsToSetT &S) {
+    static bool containsRemovableLocals(PSNode *where, const PointsToSetT &S) {
         for (const auto &ptr : S) {
             if (ptr.isNull() || ptr.isUnknown() || ptr.isInvalidated())
                 continue;
@@ -171,37 +192,38 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
 
             // get or create a memory object for this target
 
-            MemoryObject *mo = getOrCreateMO(mm, I.first);
-            MemoryObject *pmo = I.second.get();
+            auto &moptr = getOrCreateMO(mm, I.first);
+            MemoryObject *mo = nullptr; // writable, got on the first change
+            const MemoryObject *pmo = I.second.get();
 
-            for (auto &it : *mo) {
+            for (const auto &it : *moptr.get()) {
                 // remove pointers to locals from the points-to set
                 if (containsRemovableLocals(node, it.second)) {
-                    replaceLocalsWithInv(node, it.second);
-                    assert(!containsRemovableLocals(node, it.second));
+                    auto &S = writableSet(moptr, mo, it.first);
+                    replaceLocalsWithInv(node, S);
+                    assert(!containsRemovableLocals(node, S));
                     changed = true;
                 }
             }
 
             for (auto &it : *pmo) {
-                PointsToSetT &predS = it.second;
+                const PointsToSetT &predS = it.second;
                 if (predS.empty())
                     continue;
 
-                PointsToSetT &S = mo->pointsTo[it.first];
-
                 // merge pointers from the previous states
                 // but do not include the pointers
                 // that _must_ point to destroyed memory
                 for (const auto &ptr : predS) {
                     PSNodeAlloc *alloc = PSNodeAlloc::get(ptr.target);
                     if (alloc && isLocal(alloc, node) && knownInstance(alloc)) {
-                        changed |= S.add(INVALIDATED, 0);
+                        changed |= addPointer(moptr, mo, it.first,
+                                              {INVALIDATED, 0});
                     } else
-                        changed |= S.add(ptr);
+                        changed |= addPointer(moptr, mo, it.first, ptr);
                 }
 
-                assert(!S.empty());
+                assert(!moptr->find(it.first)->second.empty());
             }
         }
 
@@ -292,14 +314,16 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
         // if we know exactly which memory object
         // is being used for freeing the memory,
         // we can set it to invalidated
-        auto *mo = getOrCreateMO(mm, target);
-        if (mo->pointsTo.size() == 1) {
-            auto &S = mo->pointsTo[0];
-            if (S.size() == 1 && (*S.begin()).target == INVALIDATED) {
+        auto &moptr = getOrCreateMO(mm, target);
+        if (moptr->pointsTo.size() == 1) {
+            auto it = moptr->find(0);
+            if (it != moptr->end() && it->second.size() == 1 &&
+                (*it->second.begin()).target == INVALIDATED) {
                 return false; // no update
             }
         }
 
+        auto *mo = moptr.getWritable();
         mo->pointsTo.clear();
         mo->pointsTo[0].add(INVALIDATED, 0);
         return true;
@@ -341,24 +365,27 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
                 continue;
 
             // get or create a memory object for this target
-            MemoryObject *mo = getOrCreateMO(mm, I.first);
-            MemoryObject *pmo = I.second.get();
+            auto &moptr = getOrCreateMO(mm, I.first);
+            MemoryObject *mo = nullptr; // writable, got on the first change
+            const MemoryObject *pmo = I.second.get();
 
             // Remove references to invalidated memory from mo
             // if the invalidated object is just one.
             // Otherwise, add the invalidated pointer to the points-to sets
             // (strong vs. weak update) as we do not know which
             // object is actually being invalidated.
-            for (auto &it : *mo) {
+            for (const auto &it : *moptr.get()) {
                 if (invStrongUpdate(operand)) { // strong update
                     const auto &ptr = *(operand->pointsTo.begin());
                     if (ptr.isUnknown())
-                        changed |= it.second.add(INVALIDATED, 0);
+                        changed |= addPointer(moptr, mo, it.first,
+                                              {INVALIDATED, 0});
                     else if (ptr.isNull() || ptr.isInvalidated())
                         continue;
                     else if (it.second.pointsToTarget(ptr.target)) {
-                        replaceTargetWithInv(it.second, ptr.target);
-                        assert(!it.second.pointsToTarget(ptr.target));
+                        auto &S = writableSet(moptr, mo, it.first);
+                        replaceTargetWithInv(S, ptr.target);
+                        assert(!S.pointsToTarget(ptr.target));
                         changed = true;
                     }
                 } else { // weak update
@@ -370,7 +397,8 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
                         // each element
                         if (ptr.isUnknown() ||
                             it.second.pointsToTarget(ptr.target)) {
-                            changed |= it.second.add(INVALIDATED, 0);
+                            changed |= addPointer(moptr, mo, it.first,
+                                                  {INVALIDATED, 0});
                         }
                     }
                 }
@@ -379,12 +407,10 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
             // merge pointers from pmo to mo, but skip
             // the pointers that may point to the freed memory
             for (auto &it : *pmo) {
-                PointsToSetT &predS = it.second;
+                const PointsToSetT &predS = it.second;
                 if (predS.empty()) // keep the map clean
                     continue;
 
-                PointsToSetT &S = mo->pointsTo[it.first];
-
                 // merge pointers from the previous states
                 // but do not include the pointers
                 // that may point to freed memory.
@@ -397,17 +423,18 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
                             // we still want to copy the original pointer
                             // if we cannot perform strong update
                             // on this invalidated memory
-                            changed |= S.add(ptr);
+                            changed |= addPointer(moptr, mo, it.first, ptr);
                         }
-                        changed |= S.add(INVALIDATED, 0);
+                        changed |= addPointer(moptr, mo, it.first,
+                                              {INVALIDATED, 0});
                     } else {
                         // this is a pointer to some memory that was not
                         // invalidated, so merge it into the points-to set
-                        changed |= S.add(ptr);
+                        changed |= addPointer(moptr, mo, it.first, ptr);
                     }
                 }
 
-                assert(!S.empty());
+                assert(!moptr->find(it.first)->second.empty());
             }
         }
 
@@ -419,11 +446,15 @@ class PointerAnalysisFSInv : public PointerAnalysisFS {
         for (auto &it : *mm) {
             auto pmit = pm->find(it.first);
             if (pmit == pm->end()) {
-                for (auto &mit : *it.second) {
+                // the write below may replace the object with a copy,
+                // but then the original is still held by another map
+                for (const auto &mit : *it.second.get()) {
                     if (mit.first.isUnknown())
                         continue; // FIXME: we are optimistic here...
-                    changed |= it.second->addPointsTo(mit.first,
-                                                      Pointer{INVALIDATED, 0});
+                    if (mit.second.has(Pointer{INVALIDATED, 0}))
+                        continue;
+                    changed |= it.second.getWritable()->addPointsTo(
+                            mit.first, Pointer{INVALIDATED, 0});
                 }
                 continue;
             }
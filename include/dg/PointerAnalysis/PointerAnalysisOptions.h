@@ -18,6 +18,39 @@ struct PointerAnalysisOptions : AnalysisOptions {
     // INVALIDATED object.
     bool invalidateNodes{false};
 
+    // Use difference propagation: remember which pointers were added
+    // to a node in the latest round in which it changed and propagate
+    // only these pointers to the users of the node instead of
+    // re-merging the whole points-to sets of the operands.
+    bool differencePropagation{false};
+
+    // Detect cycles of nodes that only copy pointers (PHI, CAST, ...)
+    // during the analysis and collapse them into one node.
+    // Used only by the flow-insensitive analysis.
+    bool collapseCycles{false};
+
+    // The order in which the nodes are processed in one iteration
+    enum class Scheduling {
+        // BFS order from the changed nodes (default)
+        BFS,
+        // Topological order of strongly connected components
+        // of the (interprocedural) graph. Nodes inside a component are
+        // ordered by the DFS discovery time, so that the head of a loop
+        // is processed before the body of the loop.
+        // Information then reaches more nodes in one iteration.
+        TOPOLOGICAL
+    };
+
+    Scheduling scheduling{Scheduling::BFS};
+
+    // The number of threads that process the nodes of one iteration.
+    // Consecutive nodes that only compute their own points-to sets
+    // and do not read the points-to sets of each other are processed
+    // in parallel, so the results are the same as with one thread.
+    // Used only by the flow-insensitive analysis without collapsing
+    // of cycles.
+    unsigned workers{1};
+
     PointerAnalysisOptions &setInvalidateNodes(bool b) {
         invalidateNodes = b;
         return *this;
@@ -26,6 +59,22 @@ struct PointerAnalysisOptions : AnalysisOptions {
         preprocessGeps = b;
         return *this;
     }
+    PointerAnalysisOptions &setDifferencePropagation(bool b) {
+        differencePropagation = b;
+        return *this;
+    }
+    PointerAnalysisOptions &setCollapseCycles(bool b) {
+        collapseCycles = b;
+        return *this;
+    }
+    PointerAnalysisOptions &setScheduling(Scheduling s) {
+        scheduling = s;
+        return *this;
+    }
+    PointerAnalysisOptions &setWorkers(unsigned n) {
+        workers = n;
+        return *this;
+    }
 
     // Perform maximally this number of iterations.
     // If exceeded, the analysis is terminated and points-to sets
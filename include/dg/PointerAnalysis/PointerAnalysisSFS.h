@@ -0,0 +1,98 @@
+#ifndef DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+#define DG_ANALYSIS_POINTS_TO_SPARSE_FLOW_SENSITIVE_H_
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "PointerAnalysis.h"
+#include "PointerAnalysisFS.h"
+
+namespace dg {
+namespace pta {
+
+///
+// Sparse flow-sensitive pointer analysis
+//
+// The analysis runs in two stages. First, it runs flow-insensitive
+// analysis to find out which memory may be written and read
+// by every node. From these results, it computes memory SSA
+// (def-use chains of memory): for every node that accesses a memory
+// object, it finds the nodes that may write the object and whose
+// definitions may reach the node. Then the points-to sets are
+// computed again flow-sensitively, but the memory is propagated only
+// along the def-use chains and only the nodes that access memory
+// have memory maps. The results are the same as of PointerAnalysisFS,
+// or more precise when calls via function pointers are resolved
+// (the memory SSA is computed on the final graph).
+//
+class PointerAnalysisSFS : public PointerAnalysisFS {
+  public:
+    using MemoryMapT = PointerAnalysisFS::MemoryMapT;
+
+    PointerAnalysisSFS(PointerGraph *ps, PointerAnalysisOptions opts)
+            : PointerAnalysisFS(ps, std::move(opts)) {}
+
+    PointerAnalysisSFS(PointerGraph *ps) : PointerAnalysisSFS(ps, {}) {}
+
+    bool run() override;
+
+    bool beforeProcessed(PSNode * /*unused*/) override { return false; }
+    bool afterProcessed(PSNode *n) override;
+
+    void getMemoryObjects(PSNode *where, const Pointer &pointer,
+                          std::vector<MemoryObject *> &objects) override;
+
+    MemoryObject *getWritableObject(PSNode *where, MemoryObject *mo) override {
+        if (_stage == Stage::FI)
+            return mo;
+        return PointerAnalysisFS::getWritableObject(where, mo);
+    }
+
+    // the flow-insensitive stage is the same as PointerAnalysisFI
+    bool canTrackObjectChanges() const override { return _stage == Stage::FI; }
+    bool canCollapseCycles() const override { return _stage == Stage::FI; }
+
+    // Get the nodes whose definitions of the memory 'target'
+    // may reach the node 'n' (available after the analysis is run)
+    const std::vector<PSNode *> &getReachingDefinitions(PSNode *n,
+                                                        PSNode *target) const;
+
+    // Return true if the node may write to the memory 'target'
+    // (according to the flow-insensitive stage)
+    bool defines(PSNode *n, PSNode *target) const;
+
+  protected:
+    std::vector<PSNode *>
+    getNodesToProcess(const std::vector<PSNode *> &changed,
+                      unsigned expected_num) override;
+
+  private:
+    enum class Stage { FI, SPARSE } _stage{Stage::FI};
+
+    // memory objects used in the flow-insensitive stage
+    std::unordered_map<PSNode *, std::unique_ptr<MemoryObject>> _fiObjects;
+
+    // the memory that the node may write (sorted)
+    std::unordered_map<PSNode *, std::vector<PSNode *>> _definedTargets;
+    // memory SSA: the reaching definitions for every node
+    // and every memory that the node accesses
+    std::unordered_map<PSNode *, std::map<PSNode *, std::vector<PSNode *>>>
+            _reachingDefs;
+    // the nodes that are reached by the definitions of the node
+    std::unordered_map<PSNode *, std::vector<PSNode *>> _defUses;
+    // used to mark nodes when gathering nodes to process
+    std::vector<unsigned> _queued;
+    unsigned _queuedStamp{0};
+
+    void computeMemorySSA();
+    void resetPointsTo();
+    MemoryMapT *getOrCreateMM(PSNode *n);
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif
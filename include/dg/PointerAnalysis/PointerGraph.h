@@ -105,6 +105,10 @@ class PointerGraph {
     using GlobalNodesT = std::vector<PSNode *>;
     using SubgraphsT = std::vector<std::unique_ptr<PointerSubgraph>>;
 
+    // IDs of pointers to the nodes of this graph used by points-to sets
+    // (must be destroyed after the nodes)
+    PointerIDLookupTable _pointerIDs;
+
     NodesT nodes;
     SubgraphsT _subgraphs;
 
@@ -186,6 +190,7 @@ class PointerGraph {
     template <PSNodeType Type, typename... Args>
     PSNode *create(Args &&...args) {
         PSNode *n = nodeFactory<Type>(std::forward<Args>(args)...);
+        n->setPointerIDs(&_pointerIDs);
         nodes.emplace_back(n); // C++17 returns a referece
         assert(n->getID() == nodes.size() - 1);
         return n;
@@ -211,6 +216,7 @@ class PointerGraph {
     const SubgraphsT &getSubgraphs() const { return _subgraphs; }
 
     const NodesT &getNodes() const { return nodes; }
+    PointerIDLookupTable &getPointerIDs() { return _pointerIDs; }
     const GlobalNodesT &getGlobals() const { return _globals; }
     size_t size() const { return nodes.size() + _globals.size(); }
 
@@ -226,6 +232,36 @@ class PointerGraph {
 
     void remove(PSNode *nd);
 
+    // iterate over successors of the node, if 'interprocedural'
+    // is true, then also over call (return) edges
+    template <typename FunT>
+    static void foreachSuccessor(PSNode *cur, bool interprocedural,
+                                 FunT &&Dispatch) {
+        if (interprocedural) {
+            if (PSNodeCall *C = PSNodeCall::get(cur)) {
+                for (auto *subg : C->getCallees()) {
+                    Dispatch(subg->root);
+                }
+                // we do not need to iterate over succesors
+                // if we dive into the procedure (as we will
+                // return via call return)
+                // NOTE: we must iterate over successors if the
+                // function is undefined
+                if (!C->getCallees().empty())
+                    return;
+            } else if (PSNodeRet *R = PSNodeRet::get(cur)) {
+                for (auto *ret : R->getReturnSites()) {
+                    Dispatch(ret);
+                }
+                if (!R->getReturnSites().empty())
+                    return;
+            }
+        }
+
+        for (auto *s : cur->successors())
+            Dispatch(s);
+    }
+
     // get nodes in BFS order and store them into
     // the container
     template <typename ContainerOrNode>
@@ -252,29 +288,7 @@ class PointerGraph {
             EdgeChooser(bool inter = true) : interproc(inter) {}
 
             void foreach (PSNode *cur, std::function<void(PSNode *)> Dispatch) {
-                if (interproc) {
-                    if (PSNodeCall *C = PSNodeCall::get(cur)) {
-                        for (auto *subg : C->getCallees()) {
-                            Dispatch(subg->root);
-                        }
-                        // we do not need to iterate over succesors
-                        // if we dive into the procedure (as we will
-                        // return via call return)
-                        // NOTE: we must iterate over successors if the
-                        // function is undefined
-                        if (!C->getCallees().empty())
-                            return;
-                    } else if (PSNodeRet *R = PSNodeRet::get(cur)) {
-                        for (auto *ret : R->getReturnSites()) {
-                            Dispatch(ret);
-                        }
-                        if (!R->getReturnSites().empty())
-                            return;
-                    }
-                }
-
-                for (auto *s : cur->successors())
-                    Dispatch(s);
+                PointerGraph::foreachSuccessor(cur, interproc, Dispatch);
             }
         };
 
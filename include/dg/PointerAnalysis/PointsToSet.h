@@ -3,6 +3,8 @@
 
 #include "dg/PointerAnalysis/PointsToSets/AlignedPointerIdPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/AlignedSmallOffsetsPointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/BDDPointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/InternedPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/OffsetsSetPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/PointerIdPointsToSet.h"
 #include "dg/PointerAnalysis/PointsToSets/SeparateOffsetsPointsToSet.h"
@@ -12,7 +14,13 @@
 namespace dg {
 namespace pta {
 
+#if defined(DG_INTERNED_POINTS_TO_SETS)
+using PointsToSetT = InternedPointsToSet;
+#elif defined(DG_BDD_POINTS_TO_SETS)
+using PointsToSetT = BDDPointsToSet;
+#else
 using PointsToSetT = PointerIdPointsToSet;
+#endif
 using PointsToMapT = std::map<Offset, PointsToSetT>;
 
 } // namespace pta
@@ -3,11 +3,13 @@
 
 #include "dg/ADT/Bitvector.h"
 #include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
 #include "dg/util/iterators.h"
 
 #include <cassert>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace dg {
@@ -20,18 +22,17 @@ class AlignedPointerIdPointsToSet {
 
     ADT::SparseBitvector pointers;
     std::set<Pointer> overflowSet;
-    static std::map<Pointer, size_t> ids; // pointers are numbered 1, 2, ...
-    static std::vector<Pointer>
-            idVector; // starts from 0 (pointer = idVector[id - 1])
+    // the table of IDs of the graph of the pointed nodes
+    // (nullptr while there are only pointers to special nodes)
+    PointerIDLookupTable *_table{nullptr};
 
     // if the pointer doesn't have ID, it's assigned one
     static size_t getPointerID(const Pointer &ptr) {
-        auto it = ids.find(ptr);
-        if (it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(ptr);
-        return ids.emplace_hint(it, ptr, ids.size() + 1)->second;
+        return PointerIDLookupTable::getID(ptr);
+    }
+
+    Pointer getPointer(size_t id) const {
+        return PointerIDLookupTable::getPointer(_table, id);
     }
 
     bool addWithUnknownOffset(PSNode *node) {
@@ -52,6 +53,7 @@ class AlignedPointerIdPointsToSet {
     bool add(PSNode *target, Offset off) { return add(Pointer(target, off)); }
 
     bool add(const Pointer &ptr) {
+        PointerIDLookupTable::bindTable(_table, ptr.target);
         if (has({ptr.target, Offset::UNKNOWN})) {
             return false;
         }
@@ -65,6 +67,10 @@ class AlignedPointerIdPointsToSet {
     }
 
     bool add(const AlignedPointerIdPointsToSet &S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table) &&
+               "Pointers to nodes of different graphs in one set");
         bool changed = pointers.set(S.pointers);
         for (const auto &ptr : S.overflowSet) {
             changed |= overflowSet.insert(ptr).second;
@@ -86,7 +92,7 @@ class AlignedPointerIdPointsToSet {
     bool removeAny(PSNode *target) {
         std::vector<size_t> toRemove;
         for (const auto &ptrID : pointers) {
-            if (idVector[ptrID - 1].target == target) {
+            if (getPointer(ptrID).target == target) {
                 toRemove.push_back(ptrID);
             }
         }
@@ -131,8 +137,8 @@ class AlignedPointerIdPointsToSet {
     }
 
     bool pointsToTarget(PSNode *target) const {
-        for (const auto &kv : ids) {
-            if (kv.first.target == target && pointers.get(kv.second)) {
+        for (const auto &ptrID : pointers) {
+            if (getPointer(ptrID).target == target) {
                 return true;
             }
         }
@@ -163,6 +169,7 @@ class AlignedPointerIdPointsToSet {
     void swap(AlignedPointerIdPointsToSet &rhs) {
         pointers.swap(rhs.pointers);
         overflowSet.swap(rhs.overflowSet);
+        std::swap(_table, rhs._table);
     }
 
     size_t overflowSetSize() const { return overflowSet.size(); }
@@ -170,14 +177,16 @@ class AlignedPointerIdPointsToSet {
     static unsigned int getMultiplier() { return multiplier; }
 
     class const_iterator {
+        const PointerIDLookupTable *table;
         typename ADT::SparseBitvector::const_iterator bitvector_it;
         typename ADT::SparseBitvector::const_iterator bitvector_end;
         typename std::set<Pointer>::const_iterator set_it;
         bool secondContainer;
 
-        const_iterator(const ADT::SparseBitvector &pointers,
+        const_iterator(const PointerIDLookupTable *table,
+                       const ADT::SparseBitvector &pointers,
                        const std::set<Pointer> &overflow, bool end = false)
-                : bitvector_it(end ? pointers.end() : pointers.begin()),
+                : table(table), bitvector_it(end ? pointers.end() : pointers.begin()),
                   bitvector_end(pointers.end()),
                   set_it(end ? overflow.end() : overflow.begin()),
                   secondContainer(end) {
@@ -207,7 +216,7 @@ class AlignedPointerIdPointsToSet {
 
         Pointer operator*() const {
             if (!secondContainer) {
-                return {idVector[*bitvector_it - 1]};
+                return PointerIDLookupTable::getPointer(table, *bitvector_it);
             }
             return *set_it;
         }
@@ -223,9 +232,9 @@ class AlignedPointerIdPointsToSet {
         friend class AlignedPointerIdPointsToSet;
     };
 
-    const_iterator begin() const { return {pointers, overflowSet}; }
+    const_iterator begin() const { return {_table, pointers, overflowSet}; }
     const_iterator end() const {
-        return {pointers, overflowSet, true /* end */};
+        return {_table, pointers, overflowSet, true /* end */};
     }
 
     friend class const_iterator;
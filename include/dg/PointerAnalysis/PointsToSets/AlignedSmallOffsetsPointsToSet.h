@@ -3,10 +3,12 @@
 
 #include "dg/ADT/Bitvector.h"
 #include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
 
 #include <cassert>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace dg {
@@ -22,18 +24,13 @@ class AlignedSmallOffsetsPointsToSet {
 
     ADT::SparseBitvector pointers;
     std::set<Pointer> oddPointers;
-    static std::map<PSNode *, size_t> ids; // nodes are numbered 1,2, ...
-    static std::vector<PSNode *>
-            idVector; // starts from 0 (node = idVector[id - 1])
+    // the table of IDs of the graph of the pointed nodes
+    // (nullptr while there are only pointers to special nodes)
+    PointerIDLookupTable *_table{nullptr};
 
     // if the node doesn't have ID, it's assigned one
     static size_t getNodeID(PSNode *node) {
-        auto it = ids.find(node);
-        if (it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(node);
-        return ids.emplace_hint(it, node, ids.size() + 1)->second;
+        return PointerIDLookupTable::getNodeID(node);
     }
 
     static size_t getNodePosition(PSNode *node) {
@@ -64,6 +61,7 @@ class AlignedSmallOffsetsPointsToSet {
     }
 
     bool add(PSNode *target, Offset off) {
+        PointerIDLookupTable::bindTable(_table, target);
         if (has({target, Offset::UNKNOWN})) {
             return false;
         }
@@ -79,6 +77,10 @@ class AlignedSmallOffsetsPointsToSet {
     bool add(const Pointer &ptr) { return add(ptr.target, ptr.offset); }
 
     bool add(const AlignedSmallOffsetsPointsToSet &S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table) &&
+               "Pointers to nodes of different graphs in one set");
         bool changed = pointers.set(S.pointers);
         for (const auto &ptr : S.oddPointers) {
             changed |= oddPointers.insert(ptr).second;
@@ -169,6 +171,7 @@ class AlignedSmallOffsetsPointsToSet {
     void swap(AlignedSmallOffsetsPointsToSet &rhs) {
         pointers.swap(rhs.pointers);
         oddPointers.swap(rhs.oddPointers);
+        std::swap(_table, rhs._table);
     }
 
     size_t overflowSetSize() const { return oddPointers.size(); }
@@ -177,14 +180,16 @@ class AlignedSmallOffsetsPointsToSet {
 
     // iterates over the bitvector first, then over the set
     class const_iterator {
+        const PointerIDLookupTable *table;
         typename ADT::SparseBitvector::const_iterator bitvector_it;
         typename ADT::SparseBitvector::const_iterator bitvector_end;
         typename std::set<Pointer>::const_iterator set_it;
         bool secondContainer;
 
-        const_iterator(const ADT::SparseBitvector &pointers,
+        const_iterator(const PointerIDLookupTable *table,
+                       const ADT::SparseBitvector &pointers,
                        const std::set<Pointer> &oddPointers, bool end = false)
-                : bitvector_it(end ? pointers.end() : pointers.begin()),
+                : table(table), bitvector_it(end ? pointers.end() : pointers.begin()),
                   bitvector_end(pointers.end()),
                   set_it(end ? oddPointers.end() : oddPointers.begin()),
                   secondContainer(end) {
@@ -219,8 +224,9 @@ class AlignedSmallOffsetsPointsToSet {
                         ((*bitvector_it - offsetPosition) / (MAX_OFFSET + 1)) +
                         1;
                 return offsetPosition == MAX_OFFSET
-                               ? Pointer(idVector[nodeID - 1], Offset::UNKNOWN)
-                               : Pointer(idVector[nodeID - 1],
+                               ? Pointer(PointerIDLookupTable::getNode(table, nodeID),
+                                         Offset::UNKNOWN)
+                               : Pointer(PointerIDLookupTable::getNode(table, nodeID),
                                          offsetPosition * multiplier);
             }
             return *set_it;
@@ -237,9 +243,9 @@ class AlignedSmallOffsetsPointsToSet {
         friend class AlignedSmallOffsetsPointsToSet;
     };
 
-    const_iterator begin() const { return {pointers, oddPointers}; }
+    const_iterator begin() const { return {_table, pointers, oddPointers}; }
     const_iterator end() const {
-        return {pointers, oddPointers, true /* end */};
+        return {_table, pointers, oddPointers, true /* end */};
     }
 
     friend class const_iterator;
@@ -0,0 +1,391 @@
+#ifndef DG_BDDPOINTSTOSET_H
+#define DG_BDDPOINTSTOSET_H
+
+#include <cassert>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "dg/ADT/BDD.h"
+#include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
+
+namespace dg {
+
+// The manager of BDDs of sets that contain only pointers to the special
+// nodes (NULLPTR, UNKNOWN_MEMORY, INVALIDATED). These pointers do not
+// belong to any graph, so the BDDs are shared by all graphs. There are
+// only few such sets, so the manager is never freed. The manager is always
+// in the concurrent mode.
+ADT::BDDManager &getSpecialBDDs();
+
+namespace pta {
+
+class PSNode;
+
+///
+// Points-to set represented by a BDD over the bits of numbers
+// of the pointers. The BDDs of all the sets of a graph are kept
+// by one manager (owned by the table of IDs of the graph), so equal
+// sets and sets with common parts share the nodes of the BDD.
+// The set retains its BDD, so the manager can free the nodes of BDDs
+// that are not used anymore.
+//
+// The number of a pointer to a special node is its ID. The number
+// of other pointers is the ID of the pointer to the same target with
+// offset 0 followed by the ID of the pointer (ID_BITS bits), so the numbers
+// of the pointers to one target share a prefix in both cases and the
+// pointers to a target are found and removed without enumerating the set.
+class BDDPointsToSet {
+    using BDD = ADT::BDDManager::BDD;
+    using ValueT = ADT::BDDManager::ValueT;
+
+    static const unsigned ID_BITS = 32;
+
+    BDD _bdd{ADT::BDDManager::EMPTY};
+    // cached number of pointers in the set
+    size_t _size{0};
+    // The table of IDs of the graph whose nodes are pointed to by
+    // the pointers in this set and the manager of BDDs of the table.
+    // They are nullptr while the set contains only pointers to special
+    // nodes (these do not need any table). The set keeps the manager,
+    // because it can outlive the table.
+    PointerIDLookupTable *_table{nullptr};
+    ADT::BDDManager *_manager{nullptr};
+
+    static void release(ADT::BDDManager &M, BDD bdd) {
+        // the table of the manager was destroyed
+        if (M.release(bdd))
+            delete &M;
+    }
+
+    // a BDD that is released when the object is destroyed
+    class Retained {
+        ADT::BDDManager &M;
+        BDD bdd;
+
+      public:
+        Retained(ADT::BDDManager &m, BDD b) : M(m), bdd(b) {}
+        Retained(const Retained &) = delete;
+        Retained &operator=(const Retained &) = delete;
+        ~Retained() { release(M, bdd); }
+
+        operator BDD() const { return bdd; }
+    };
+
+    ADT::BDDManager &getManager() const {
+        return _manager ? *_manager : getSpecialBDDs();
+    }
+
+    std::vector<ValueT> getValues() const {
+        return getManager().getValues(_bdd);
+    }
+
+    // take the already retained BDD
+    bool reset(BDD bdd) {
+        auto &M = getManager();
+        bool changed = bdd != _bdd;
+        if (changed)
+            _size = M.count(bdd);
+        // releasing the last set of a destroyed table deletes the manager
+        release(M, _bdd);
+        _bdd = bdd;
+        return changed;
+    }
+
+    // Get the (retained) BDD of the set S in the manager of this set
+    BDD getBDDOf(const BDDPointsToSet &S) const {
+        auto &M = getManager();
+        if (&M == &S.getManager()) {
+            M.retain(S._bdd);
+            return S._bdd;
+        }
+
+        // S contains only pointers to special nodes
+        assert(!S._table);
+        BDD res = ADT::BDDManager::EMPTY;
+        for (auto value : S.getValues()) {
+            Retained single(M, M.singleton(value));
+            BDD tmp = M.unite(res, single);
+            release(M, res);
+            res = tmp;
+        }
+        return res;
+    }
+
+    // Set the table of the set that contains only pointers to special nodes,
+    // the BDD must be moved from the manager of special sets
+    void setTable(PointerIDLookupTable *table) {
+        assert(!_table);
+        BDDPointsToSet tmp;
+        tmp.swap(*this);
+        _table = table;
+        _manager = &table->getBDDs();
+        reset(getBDDOf(tmp));
+    }
+
+    // if the pointer doesn't have ID, it's assigned one
+    ValueT getPointerValue(const Pointer &ptr) {
+        if (PointerIDLookupTable::isSpecial(ptr))
+            return PointerIDLookupTable::getSpecialID(ptr);
+
+        if (!_table)
+            setTable(getPointerIDs(ptr.target));
+        assert(_table == getPointerIDs(ptr.target) &&
+               "Pointers to nodes of different graphs in one set");
+        auto id = _table->getOrCreate(ptr);
+        auto target = _table->getOrCreate({ptr.target, 0});
+        return getValue(target, id);
+    }
+
+    // return the number of the pointer or 0 if the pointer cannot be
+    // in the set
+    ValueT findPointerValue(const Pointer &ptr) const {
+        if (PointerIDLookupTable::isSpecial(ptr))
+            return PointerIDLookupTable::getSpecialID(ptr);
+        if (!_table)
+            return 0;
+        auto id = _table->get(ptr);
+        auto target = _table->get({ptr.target, 0});
+        return id == 0 || target == 0 ? 0 : getValue(target, id);
+    }
+
+    static ValueT getValue(size_t targetID, size_t id) {
+        assert(targetID < (ValueT{1} << (ID_BITS - 1)) &&
+               id < (ValueT{1} << ID_BITS) && "Too many pointers");
+        return (static_cast<ValueT>(targetID) << ID_BITS) | id;
+    }
+
+    // Get the prefix shared by the numbers of all pointers to the target
+    // and its length. Return false if there is no pointer to the target.
+    bool getTargetPrefix(PSNode *target, ValueT &prefix,
+                         unsigned &bits) const {
+        if (PointerIDLookupTable::isSpecial({target, 0})) {
+            prefix = PointerIDLookupTable::getSpecialID({target, 0});
+            bits = ADT::BDDManager::BITS - PointerIDLookupTable::OFFSET_BITS;
+            return true;
+        }
+
+        auto targetID = _table ? _table->get({target, 0}) : 0;
+        if (targetID == 0)
+            return false;
+        prefix = getValue(targetID, 0);
+        bits = ADT::BDDManager::BITS - ID_BITS;
+        return true;
+    }
+
+    Pointer getPointer(ValueT value) const {
+        if (PointerIDLookupTable::isSpecialID(value))
+            return PointerIDLookupTable::getSpecialPointer(value);
+        return PointerIDLookupTable::getPointer(
+                _table, value & ((ValueT{1} << ID_BITS) - 1));
+    }
+
+    bool addValue(ValueT value) {
+        auto &M = getManager();
+        Retained single(M, M.singleton(value));
+        return reset(M.unite(_bdd, single));
+    }
+
+    bool addWithUnknownOffset(PSNode *node) {
+        auto value = getPointerValue({node, Offset::UNKNOWN});
+        if (!getManager().contains(_bdd, value)) {
+            removeAny(node);
+            return addValue(value);
+        }
+        return false; // we already had it
+    }
+
+  public:
+    BDDPointsToSet() = default;
+    explicit BDDPointsToSet(const std::initializer_list<Pointer> &elems) {
+        add(elems);
+    }
+
+    BDDPointsToSet(const BDDPointsToSet &rhs)
+            : _bdd(rhs._bdd), _size(rhs._size), _table(rhs._table),
+              _manager(rhs._manager) {
+        getManager().retain(_bdd);
+    }
+
+    BDDPointsToSet(BDDPointsToSet &&rhs) noexcept
+            : _bdd(rhs._bdd), _size(rhs._size), _table(rhs._table),
+              _manager(rhs._manager) {
+        rhs._bdd = ADT::BDDManager::EMPTY;
+        rhs._size = 0;
+    }
+
+    BDDPointsToSet &operator=(BDDPointsToSet rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    ~BDDPointsToSet() { release(getManager(), _bdd); }
+
+    bool add(PSNode *target, Offset off) { return add(Pointer(target, off)); }
+
+    bool add(const Pointer &ptr) {
+        if (has({ptr.target, Offset::UNKNOWN})) {
+            return false;
+        }
+        if (ptr.offset.isUnknown()) {
+            return addWithUnknownOffset(ptr.target);
+        }
+        return addValue(getPointerValue(ptr));
+    }
+
+    template <typename ContainerTy>
+    bool add(const ContainerTy &C) {
+        bool changed = false;
+        for (const auto &ptr : C)
+            changed |= add(ptr);
+        return changed;
+    }
+
+    bool add(const BDDPointsToSet &S) {
+        if (!_table && S._table)
+            setTable(S._table);
+        assert((!S._table || S._table == _table) &&
+               "Pointers to nodes of different graphs in one set");
+        auto &M = getManager();
+        Retained other(M, getBDDOf(S));
+        return reset(M.unite(_bdd, other));
+    }
+
+    bool remove(const Pointer &ptr) {
+        auto value = findPointerValue(ptr);
+        if (value == 0)
+            return false;
+        auto &M = getManager();
+        Retained single(M, M.singleton(value));
+        return reset(M.subtract(_bdd, single));
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    bool removeAny(PSNode *target) {
+        ValueT prefix;
+        unsigned bits;
+        if (!getTargetPrefix(target, prefix, bits))
+            return false;
+        auto &M = getManager();
+        Retained pointers(M, M.withPrefix(prefix, bits));
+        return reset(M.subtract(_bdd, pointers));
+    }
+
+    void clear() {
+        release(getManager(), _bdd);
+        _bdd = ADT::BDDManager::EMPTY;
+        _size = 0;
+    }
+
+    bool pointsTo(const Pointer &ptr) const {
+        auto value = findPointerValue(ptr);
+        return value != 0 && getManager().contains(_bdd, value);
+    }
+
+    bool mayPointTo(const Pointer &ptr) const {
+        return pointsTo(ptr) || pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer &ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        ValueT prefix;
+        unsigned bits;
+        return getTargetPrefix(target, prefix, bits) &&
+               getManager().containsPrefix(_bdd, prefix, bits);
+    }
+
+    bool isSingleton() const { return _size == 1; }
+
+    bool empty() const { return _bdd == ADT::BDDManager::EMPTY; }
+
+    size_t count(const Pointer &ptr) const { return pointsTo(ptr); }
+
+    bool has(const Pointer &ptr) const { return count(ptr) > 0; }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+
+    bool hasNullWithOffset() const {
+        ValueT prefix;
+        unsigned bits;
+        getTargetPrefix(NULLPTR, prefix, bits);
+        auto &M = getManager();
+        Retained nulls(M, M.withPrefix(prefix, bits));
+        Retained inSet(M, M.intersect(_bdd, nulls));
+        Retained zero(M, M.singleton(prefix));
+        return inSet != ADT::BDDManager::EMPTY && inSet != zero;
+    }
+
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const { return _size; }
+
+    void swap(BDDPointsToSet &rhs) {
+        std::swap(_bdd, rhs._bdd);
+        std::swap(_size, rhs._size);
+        std::swap(_table, rhs._table);
+        std::swap(_manager, rhs._manager);
+    }
+
+    // The iterator takes the numbers of the pointers from the BDD
+    // when it is created (the BDD cannot be traversed without
+    // the manager that may be used by other threads).
+    class const_iterator {
+        const BDDPointsToSet *set{nullptr};
+        std::shared_ptr<const std::vector<ValueT>> values;
+        size_t pos{0};
+
+        const_iterator(const BDDPointsToSet *s, bool end = false) : set(s) {
+            if (!end && !s->empty())
+                values = std::make_shared<const std::vector<ValueT>>(
+                        s->getValues());
+        }
+
+        bool atEnd() const { return !values || pos == values->size(); }
+
+      public:
+        const_iterator &operator++() {
+            ++pos;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const { return set->getPointer((*values)[pos]); }
+
+        bool operator==(const const_iterator &rhs) const {
+            if (atEnd() || rhs.atEnd())
+                return atEnd() == rhs.atEnd();
+            return values == rhs.values && pos == rhs.pos;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class BDDPointsToSet;
+    };
+
+    const_iterator begin() const { return {this}; }
+    const_iterator end() const { return {this, true /* end */}; }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_BDDPOINTSTOSET_H
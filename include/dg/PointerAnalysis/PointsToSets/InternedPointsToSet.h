@@ -0,0 +1,354 @@
+#ifndef DG_INTERNEDPOINTSTOSET_H
+#define DG_INTERNEDPOINTSTOSET_H
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSets/InternedSetsPool.h"
+#include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
+
+namespace dg {
+namespace pta {
+
+class PSNode;
+
+///
+// Points-to set that is only a reference to an immutable hash-consed
+// set of pointer IDs (see InternedSetsPool). Equal sets share the same
+// object, so copying the set and comparing sets is cheap and unions
+// of sets are memoized. Every change of the set creates (or finds)
+// a new interned set. The set holds a reference to the interned set,
+// so the pool can free the sets that are no longer used.
+class InternedPointsToSet {
+    using SetT = InternedSetsPool::Set;
+    using IDsT = InternedSetsPool::IDsT;
+
+    const SetT *_set{nullptr};
+    // The table of IDs of the graph whose nodes are pointed to by
+    // the pointers in this set. It is nullptr while the set contains only
+    // pointers to special nodes (these do not need any table).
+    PointerIDLookupTable *_table{nullptr};
+
+    InternedSetsPool &getPool() const {
+        return _table ? _table->getInternedSets() : getSpecialInternedSets();
+    }
+
+    const IDsT &getIDs() const {
+        static const IDsT empty;
+        return _set ? _set->getIDs() : empty;
+    }
+
+    // take the already retained set S
+    bool reset(const SetT *S) {
+        bool changed = S != _set;
+        if (_set)
+            _set->release();
+        _set = S;
+        return changed;
+    }
+
+    bool setIDs(IDsT &&ids) { return reset(getPool().intern(std::move(ids))); }
+
+    static bool containsID(const IDsT &ids, size_t id) {
+        return std::binary_search(ids.begin(), ids.end(), id);
+    }
+
+    bool containsID(size_t id) const { return containsID(getIDs(), id); }
+
+    // if the pointer doesn't have ID, it's assigned one
+    size_t getPointerID(const Pointer &ptr) {
+        PointerIDLookupTable::bindTable(_table, ptr.target);
+        return PointerIDLookupTable::getID(ptr);
+    }
+
+    // return the ID of the pointer or 0 if the pointer cannot be in the set
+    size_t findPointerID(const Pointer &ptr) const {
+        if (PointerIDLookupTable::isSpecial(ptr))
+            return PointerIDLookupTable::getSpecialID(ptr);
+        return _table ? _table->get(ptr) : 0;
+    }
+
+    Pointer getPointer(size_t id) const {
+        return PointerIDLookupTable::getPointer(_table, id);
+    }
+
+    bool addID(size_t id) {
+        const auto &ids = getIDs();
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id)
+            return false;
+
+        IDsT newIDs;
+        newIDs.reserve(ids.size() + 1);
+        newIDs.insert(newIDs.end(), ids.begin(), it);
+        newIDs.push_back(id);
+        newIDs.insert(newIDs.end(), it, ids.end());
+        return setIDs(std::move(newIDs));
+    }
+
+    static bool insertID(IDsT &ids, size_t id) {
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id)
+            return false;
+        ids.insert(it, id);
+        return true;
+    }
+
+    void removeAnyFrom(IDsT &ids, PSNode *target) const {
+        ids.erase(std::remove_if(ids.begin(), ids.end(),
+                                 [this, target](size_t id) {
+                                     return getPointer(id).target == target;
+                                 }),
+                  ids.end());
+    }
+
+    // add the pointer to the (not interned) sorted IDs,
+    // the same as add(ptr) does with the interned set
+    void addTo(IDsT &ids, const Pointer &ptr) {
+        if (ptr.offset.isUnknown()) {
+            auto ptrid = getPointerID(ptr);
+            if (!containsID(ids, ptrid)) {
+                removeAnyFrom(ids, ptr.target);
+                insertID(ids, ptrid);
+            }
+            return;
+        }
+
+        auto unknown = findPointerID({ptr.target, Offset::UNKNOWN});
+        if (unknown != 0 && containsID(ids, unknown))
+            return;
+        insertID(ids, getPointerID(ptr));
+    }
+
+    bool addWithUnknownOffset(PSNode *node) {
+        auto ptrid = getPointerID({node, Offset::UNKNOWN});
+        if (!containsID(ptrid)) {
+            removeAny(node);
+            return addID(ptrid);
+        }
+        return false; // we already had it
+    }
+
+  public:
+    InternedPointsToSet() = default;
+    explicit InternedPointsToSet(const std::initializer_list<Pointer> &elems) {
+        add(elems);
+    }
+
+    InternedPointsToSet(const InternedPointsToSet &rhs)
+            : _set(rhs._set), _table(rhs._table) {
+        if (_set)
+            _set->retain();
+    }
+
+    InternedPointsToSet(InternedPointsToSet &&rhs) noexcept
+            : _set(rhs._set), _table(rhs._table) {
+        rhs._set = nullptr;
+    }
+
+    InternedPointsToSet &operator=(InternedPointsToSet rhs) {
+        swap(rhs);
+        return *this;
+    }
+
+    ~InternedPointsToSet() {
+        if (_set)
+            _set->release();
+    }
+
+    bool add(PSNode *target, Offset off) { return add(Pointer(target, off)); }
+
+    bool add(const Pointer &ptr) {
+        if (has({ptr.target, Offset::UNKNOWN})) {
+            return false;
+        }
+        if (ptr.offset.isUnknown()) {
+            return addWithUnknownOffset(ptr.target);
+        }
+        return addID(getPointerID(ptr));
+    }
+
+    // add all the pointers at once, so that only the resulting set
+    // is interned
+    template <typename ContainerTy>
+    bool add(const ContainerTy &C) {
+        IDsT ids = getIDs();
+        for (const auto &ptr : C)
+            addTo(ids, ptr);
+        if (ids == getIDs())
+            return false;
+        return setIDs(std::move(ids));
+    }
+
+    bool add(const InternedPointsToSet &S) {
+        if (!S._set)
+            return false;
+
+        // The memoized unions are keyed by the sets, so both operands
+        // must be from the pool of the result. A set without a table
+        // is in the pool of special sets that may free it independently
+        // of the graph's pool, so it is interned into the graph's pool.
+        auto oldSize = size();
+        if (!_table && S._table) {
+            _table = S._table;
+            setIDs(IDsT(getIDs()));
+        }
+        assert((!S._table || S._table == _table) &&
+               "Pointers to nodes of different graphs in one set");
+
+        if (_table && !S._table) {
+            const SetT *other = getPool().intern(IDsT(S.getIDs()));
+            reset(getPool().getUnion(_set, other));
+            other->release();
+        } else {
+            reset(getPool().getUnion(_set, S._set));
+        }
+        return size() != oldSize;
+    }
+
+    bool remove(const Pointer &ptr) {
+        auto id = findPointerID(ptr);
+        if (id == 0 || !containsID(id))
+            return false;
+
+        IDsT newIDs;
+        const auto &ids = getIDs();
+        newIDs.reserve(ids.size() - 1);
+        std::remove_copy(ids.begin(), ids.end(), std::back_inserter(newIDs),
+                         id);
+        return setIDs(std::move(newIDs));
+    }
+
+    bool remove(PSNode *target, Offset offset) {
+        return remove(Pointer(target, offset));
+    }
+
+    bool removeAny(PSNode *target) {
+        IDsT newIDs;
+        const auto &ids = getIDs();
+        newIDs.reserve(ids.size());
+        for (auto ptrID : ids) {
+            if (getPointer(ptrID).target != target)
+                newIDs.push_back(ptrID);
+        }
+
+        if (newIDs.size() == ids.size())
+            return false;
+        return setIDs(std::move(newIDs));
+    }
+
+    void clear() { reset(nullptr); }
+
+    bool pointsTo(const Pointer &ptr) const {
+        auto id = findPointerID(ptr);
+        return id != 0 && containsID(id);
+    }
+
+    bool mayPointTo(const Pointer &ptr) const {
+        return pointsTo(ptr) || pointsTo(Pointer(ptr.target, Offset::UNKNOWN));
+    }
+
+    bool mustPointTo(const Pointer &ptr) const {
+        assert(!ptr.offset.isUnknown() && "Makes no sense");
+        return pointsTo(ptr) && isSingleton();
+    }
+
+    bool pointsToTarget(PSNode *target) const {
+        for (auto ptrid : getIDs()) {
+            if (getPointer(ptrid).target == target) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isSingleton() const { return size() == 1; }
+
+    bool empty() const { return _set == nullptr; }
+
+    size_t count(const Pointer &ptr) const { return pointsTo(ptr); }
+
+    bool has(const Pointer &ptr) const { return count(ptr) > 0; }
+
+    bool hasUnknown() const { return pointsToTarget(UNKNOWN_MEMORY); }
+
+    bool hasNull() const { return pointsToTarget(NULLPTR); }
+
+    bool hasNullWithOffset() const {
+        for (auto ptrid : getIDs()) {
+            const auto &ptr = getPointer(ptrid);
+            if (ptr.target == NULLPTR && *ptr.offset != 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool hasInvalidated() const { return pointsToTarget(INVALIDATED); }
+
+    size_t size() const { return getIDs().size(); }
+
+    void swap(InternedPointsToSet &rhs) {
+        std::swap(_set, rhs._set);
+        std::swap(_table, rhs._table);
+    }
+
+    // Equal sets share the interned set unless one of them is bound
+    // to the table of a graph and the other is not (then the sets
+    // are from different pools)
+    bool operator==(const InternedPointsToSet &rhs) const {
+        return _set == rhs._set || (_set && rhs._set && *_set == *rhs._set);
+    }
+
+    bool operator!=(const InternedPointsToSet &rhs) const {
+        return !operator==(rhs);
+    }
+
+    class const_iterator {
+        const InternedPointsToSet *set;
+        typename IDsT::const_iterator container_it;
+
+        const_iterator(const InternedPointsToSet *s, bool end = false)
+                : set(s), container_it(end ? s->getIDs().end()
+                                           : s->getIDs().begin()) {}
+
+      public:
+        const_iterator &operator++() {
+            container_it++;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto tmp = *this;
+            operator++();
+            return tmp;
+        }
+
+        Pointer operator*() const { return set->getPointer(*container_it); }
+
+        bool operator==(const const_iterator &rhs) const {
+            return container_it == rhs.container_it;
+        }
+
+        bool operator!=(const const_iterator &rhs) const {
+            return !operator==(rhs);
+        }
+
+        friend class InternedPointsToSet;
+    };
+
+    const_iterator begin() const { return {this}; }
+    const_iterator end() const { return {this, true /* end */}; }
+
+    friend class const_iterator;
+};
+
+} // namespace pta
+} // namespace dg
+
+#endif // DG_INTERNEDPOINTSTOSET_H
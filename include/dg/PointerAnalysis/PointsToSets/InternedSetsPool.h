@@ -0,0 +1,229 @@
+#ifndef DG_PTSETS_INTERNEDSETSPOOL_H_
+#define DG_PTSETS_INTERNEDSETSPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace dg {
+
+///
+// Storage of hash-consed (interned) sets of pointer IDs.
+// Every set is stored only once and it is never changed, so equal sets
+// are represented by the same object and can be compared by comparing
+// the pointers to the objects. The empty set is represented by nullptr.
+// The pool also memoizes the results of unions of the sets.
+//
+// The sets are reference counted. intern() and getUnion() return
+// a retained set that must be released by the caller. Sets without
+// references are not freed at once (they may be found again soon),
+// but the pool sweeps them whenever the number of stored sets doubles.
+// The sets that are still referenced when the pool is destroyed
+// are freed by their last release().
+class InternedSetsPool {
+  public:
+    using IDTy = size_t;
+    // sorted IDs of pointers
+    using IDsT = std::vector<IDTy>;
+
+    class Set {
+        IDsT _ids;
+        size_t _hash;
+        mutable std::atomic<size_t> _refs{0};
+        // the pool was destroyed, the set is freed by the last release
+        bool _orphan{false};
+
+        static size_t computeHash(const IDsT &ids) {
+            size_t h = ids.size();
+            for (auto id : ids)
+                h ^= std::hash<IDTy>()(id) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+
+        friend class InternedSetsPool;
+
+      public:
+        explicit Set(IDsT &&ids)
+                : _ids(std::move(ids)), _hash(computeHash(_ids)) {}
+        Set(const Set &) = delete;
+        Set &operator=(const Set &) = delete;
+
+        const IDsT &getIDs() const { return _ids; }
+        size_t getHash() const { return _hash; }
+
+        void retain() const { _refs.fetch_add(1, std::memory_order_relaxed); }
+
+        void release() const {
+            if (_refs.fetch_sub(1, std::memory_order_acq_rel) == 1 && _orphan)
+                delete this;
+        }
+
+        bool operator==(const Set &rhs) const {
+            return _hash == rhs._hash && _ids == rhs._ids;
+        }
+    };
+
+    explicit InternedSetsPool(bool concurrent = false)
+            : _concurrent(concurrent) {}
+    InternedSetsPool(const InternedSetsPool &) = delete;
+    InternedSetsPool &operator=(const InternedSetsPool &) = delete;
+
+    ~InternedSetsPool() {
+        for (Set *S : _sets) {
+            if (S->_refs.load(std::memory_order_acquire) == 0)
+                delete S;
+            else
+                S->_orphan = true;
+        }
+    }
+
+    // Get the set with the given (sorted) IDs
+    const Set *intern(IDsT &&ids) {
+        assert(std::is_sorted(ids.begin(), ids.end()));
+        if (ids.empty())
+            return nullptr;
+
+        if (_concurrent) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _intern(std::move(ids));
+        }
+        return _intern(std::move(ids));
+    }
+
+    // Get the union of the sets. The result is memoized.
+    const Set *getUnion(const Set *A, const Set *B) {
+        if (!A || A == B)
+            return retained(B);
+        if (!B)
+            return retained(A);
+        // the union is commutative
+        if (std::less<const Set *>()(B, A))
+            std::swap(A, B);
+
+        if (_concurrent) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _getUnion(A, B);
+        }
+        return _getUnion(A, B);
+    }
+
+    // the number of stored sets (including the unreferenced sets
+    // that were not swept yet)
+    size_t size() const { return _sets.size(); }
+
+    // Allow using the pool from several threads at once.
+    // Must not be switched while the pool is used by other threads.
+    void setConcurrent(bool b) { _concurrent = b; }
+
+  private:
+    struct SetHash {
+        size_t operator()(const Set *S) const { return S->getHash(); }
+    };
+
+    struct SetEq {
+        bool operator()(const Set *A, const Set *B) const { return *A == *B; }
+    };
+
+    struct PairHash {
+        size_t operator()(const std::pair<const Set *, const Set *> &p) const {
+            auto h = std::hash<const Set *>()(p.first);
+            return h ^ (std::hash<const Set *>()(p.second) + 0x9e3779b9 +
+                        (h << 6) + (h >> 2));
+        }
+    };
+
+    std::unordered_set<Set *, SetHash, SetEq> _sets;
+    std::unordered_map<std::pair<const Set *, const Set *>, const Set *,
+                       PairHash>
+            _unions;
+    // sweep when the number of sets reaches this number
+    size_t _sweepLimit{1024};
+
+    std::mutex _mutex;
+    bool _concurrent{false};
+
+    static const Set *retained(const Set *S) {
+        if (S)
+            S->retain();
+        return S;
+    }
+
+    static bool isDead(const Set *S) {
+        return S->_refs.load(std::memory_order_acquire) == 0;
+    }
+
+    // free the sets that have no references
+    // and the memoized unions that use them
+    void _sweep() {
+        for (auto it = _unions.begin(); it != _unions.end();) {
+            if (isDead(it->first.first) || isDead(it->first.second) ||
+                isDead(it->second))
+                it = _unions.erase(it);
+            else
+                ++it;
+        }
+
+        for (auto it = _sets.begin(); it != _sets.end();) {
+            if (isDead(*it)) {
+                delete *it;
+                it = _sets.erase(it);
+            } else
+                ++it;
+        }
+
+        _sweepLimit = std::max<size_t>(1024, 2 * _sets.size());
+    }
+
+    const Set *_intern(IDsT &&ids) {
+        Set tmp(std::move(ids));
+        auto it = _sets.find(&tmp);
+        if (it != _sets.end())
+            return retained(*it);
+
+        if (_sets.size() >= _sweepLimit)
+            _sweep();
+
+        Set *S = new Set(std::move(tmp._ids));
+        _sets.insert(S);
+        return retained(S);
+    }
+
+    const Set *_getUnion(const Set *A, const Set *B) {
+        auto it = _unions.find({A, B});
+        if (it != _unions.end())
+            return retained(it->second);
+
+        IDsT ids;
+        ids.reserve(A->getIDs().size() + B->getIDs().size());
+        std::set_union(A->getIDs().begin(), A->getIDs().end(),
+                       B->getIDs().begin(), B->getIDs().end(),
+                       std::back_inserter(ids));
+        // reuse the operands if the union is one of them
+        const Set *res = ids.size() == A->getIDs().size()   ? retained(A)
+                         : ids.size() == B->getIDs().size() ? retained(B)
+                                                            : nullptr;
+        if (!res)
+            res = _intern(std::move(ids));
+        _unions.emplace(std::make_pair(A, B), res);
+        return res;
+    }
+};
+
+// The pool of sets that contain only pointers to the special nodes
+// (NULLPTR, UNKNOWN_MEMORY, INVALIDATED). These pointers do not belong
+// to any graph, so the sets are shared by all graphs. There are only
+// few such sets, so the pool is never freed. The pool is always
+// in the concurrent mode.
+InternedSetsPool &getSpecialInternedSets();
+
+} // namespace dg
+
+#endif
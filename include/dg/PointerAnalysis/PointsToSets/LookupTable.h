@@ -1,7 +1,13 @@
 #ifndef DG_PTSETS_LOOKUPTABLE_H_
 #define DG_PTSETS_LOOKUPTABLE_H_
 
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
@@ -10,11 +16,34 @@
 #include "dg/ADT/Map.h"
 #endif
 
+#include "dg/ADT/BDD.h"
 #include "dg/Offset.h"
 #include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSets/InternedSetsPool.h"
 
 namespace dg {
 
+namespace pta {
+class PSNode;
+}
+
+class PointerIDLookupTable;
+
+// The table of IDs of pointers to the given node
+// (the table of the graph that contains the node)
+PointerIDLookupTable *getPointerIDs(const pta::PSNode *node);
+
+///
+// The table that assigns IDs to pointers. Every PointerGraph has its own
+// table for pointers to its nodes, so the table is freed together with
+// the graph and analyses of different graphs do not share any state.
+// Pointers to the special nodes (NULLPTR, UNKNOWN_MEMORY, INVALIDATED)
+// do not belong to any graph and get their IDs without any table,
+// see getSpecialID().
+//
+// The table can be switched to the concurrent mode in which it can be used
+// from several threads at once. Then the pointers are split into shards
+// according to their targets and only the shard is locked.
 class PointerIDLookupTable {
   public:
     using IDTy = size_t;
@@ -23,35 +52,233 @@ class PointerIDLookupTable {
 #if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
     using PtrToIDMap = dg::HashMap<PSNode *, dg::HashMap<dg::Offset, IDTy>>;
 #else
-    // we create the lookup table statically and there is a bug in GCC
-    // that breaks statically created std::unordered_map.
+    // there is a bug in GCC that breaks statically created
+    // std::unordered_map (and the table used to be static).
     // So if we have not Hopscotch map, use std::map instead.
     using PtrToIDMap = dg::Map<PSNode *, dg::Map<dg::Offset, IDTy>>;
 #endif
 
+    PointerIDLookupTable() {
+        for (auto &chunk : _chunks)
+            chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    PointerIDLookupTable(const PointerIDLookupTable &) = delete;
+    PointerIDLookupTable &operator=(const PointerIDLookupTable &) = delete;
+
+    ~PointerIDLookupTable() {
+        for (auto &chunk : _chunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+        // the BDDs of sets that outlive the table are still valid
+        _bdds->destroy();
+    }
+
+    // Return true if the pointer points to one of the special nodes
+    static bool isSpecial(const Pointer &ptr) {
+        return ptr.target == pta::NULLPTR ||
+               ptr.target == pta::UNKNOWN_MEMORY ||
+               ptr.target == pta::INVALIDATED;
+    }
+
+    static bool isSpecialID(IDTy id) { return id & SPECIAL_BIT; }
+
+    // The ID of a pointer to a special node is composed of the bit
+    // SPECIAL_BIT, the index of the node and the offset.
+    // Offsets that do not fit into the ID are taken as unknown.
+    static IDTy getSpecialID(const Pointer &ptr) {
+        assert(isSpecial(ptr));
+        IDTy idx = ptr.target == pta::NULLPTR          ? 0
+                   : ptr.target == pta::UNKNOWN_MEMORY ? 1
+                                                       : 2;
+        IDTy off = ptr.offset.isUnknown() || *ptr.offset >= OFFSET_MASK
+                           ? OFFSET_MASK
+                           : *ptr.offset;
+        return SPECIAL_BIT | (idx << OFFSET_BITS) | off;
+    }
+
+    static Pointer getSpecialPointer(IDTy id) {
+        assert(isSpecialID(id));
+        IDTy idx = (id & ~SPECIAL_BIT) >> OFFSET_BITS;
+        IDTy off = id & OFFSET_MASK;
+        PSNode *target = idx == 0   ? pta::NULLPTR
+                         : idx == 1 ? pta::UNKNOWN_MEMORY
+                                    : pta::INVALIDATED;
+        return {target, off == OFFSET_MASK ? Offset::UNKNOWN : Offset(off)};
+    }
+
+    // Helpers for points-to sets that do not keep the table:
+    // get or create the ID of the pointer in the table of the target
+    // of the pointer, set 'table' to the table of the node if it is not
+    // set yet, and get the pointer with the ID from the table
+    static IDTy getID(const Pointer &ptr);
+    static void bindTable(PointerIDLookupTable *&table, const PSNode *node);
+    static Pointer getPointer(const PointerIDLookupTable *table, IDTy id);
+
+    // Numbering of nodes for the points-to sets that keep nodes and offsets
+    // separately. The special nodes have IDs 1 - 3, other nodes use the ID
+    // of the pointer to the node with offset 0 (moved by 3).
+    static IDTy getNodeID(PSNode *node);
+    static PSNode *getNode(const PointerIDLookupTable *table, IDTy id);
+
     // this will get a new ID for the pointer if not present
     IDTy getOrCreate(const Pointer &ptr) {
-        auto res = get(ptr);
+        if (isSpecial(ptr))
+            return getSpecialID(ptr);
+
+        auto &shard = getShard(ptr);
+        if (_concurrent) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return _getOrCreate(shard, ptr);
+        }
+        return _getOrCreate(shard, ptr);
+    }
+
+    // get the ID of the pointer or 0 if the pointer has no ID
+    IDTy get(const Pointer &ptr) const {
+        if (isSpecial(ptr))
+            return getSpecialID(ptr);
+
+        const auto &shard = getShard(ptr);
+        if (_concurrent) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return _get(shard, ptr);
+        }
+        return _get(shard, ptr);
+    }
+
+    // The pointers are never moved in memory, so this method
+    // does not lock the table even in the concurrent mode.
+    // The caller must have obtained the ID in a way that synchronizes
+    // with the creation of the ID (which is the case when the ID comes
+    // from a points-to set that the thread may read).
+    Pointer get(IDTy id) const {
+        if (isSpecialID(id))
+            return getSpecialPointer(id);
+
+        assert(id > 0 && id <= size());
+        size_t chunkStart;
+        auto k = getChunk(id - 1, chunkStart);
+        return _chunks[k].load(std::memory_order_relaxed)[id - 1 - chunkStart];
+    }
+
+    // the number of pointers in the table (the special pointers
+    // are not in the table)
+    size_t size() const { return _lastID.load(std::memory_order_relaxed); }
+
+    // The interned points-to sets of pointers from this table
+    InternedSetsPool &getInternedSets() { return _internedSets; }
+
+    // The BDDs of points-to sets of pointers from this table
+    ADT::BDDManager &getBDDs() { return *_bdds; }
+
+    // Allow calling getOrCreate() and get() from several threads at once.
+    // Must not be switched while the table is used by other threads.
+    void setConcurrent(bool b) {
+        _concurrent = b;
+        _internedSets.setConcurrent(b);
+        _bdds->setConcurrent(b);
+    }
+
+    // the number of lowest bits of the ID of a special pointer
+    // that are taken by the offset
+    static const unsigned OFFSET_BITS = sizeof(IDTy) * 8 - 3;
+
+  private:
+    static const IDTy SPECIAL_BIT = static_cast<IDTy>(1)
+                                    << (sizeof(IDTy) * 8 - 1);
+    static const IDTy OFFSET_MASK = (static_cast<IDTy>(1) << OFFSET_BITS) - 1;
+
+    static const unsigned SHARDS_NUM = 16;
+
+    struct Shard {
+        // PSNode -> (Offset -> id)
+        // Not space efficient, but we need mainly the time efficiency
+        // here...
+        PtrToIDMap ptrToID;
+        mutable std::mutex mutex;
+    };
+
+    std::array<Shard, SHARDS_NUM> _shards;
+
+    // The pointers indexed by their IDs (starting from 0, that is,
+    // pointer = _chunks[...][id - 1 - ...]). The chunks double their size,
+    // the k-th chunk stores the pointers from CHUNK_BASE * (2^k - 1)
+    // to CHUNK_BASE * (2^(k + 1) - 1) (exclusive), so the pointers never
+    // move and the IDs can be read without locking.
+    static const unsigned CHUNK_BASE_BITS = 8;
+    static const size_t CHUNK_BASE = 1 << CHUNK_BASE_BITS;
+    std::array<std::atomic<Pointer *>, sizeof(IDTy) * 8 - CHUNK_BASE_BITS>
+            _chunks;
+    std::atomic<IDTy> _lastID{0};
+
+    InternedSetsPool _internedSets;
+    ADT::BDDManager *_bdds{new ADT::BDDManager()};
+
+    bool _concurrent{false};
+
+    static unsigned log2(size_t n) {
+        assert(n > 0);
+        return sizeof(unsigned long long) * 8 - 1 -
+               __builtin_clzll(static_cast<unsigned long long>(n));
+    }
+
+    static size_t getChunk(size_t idx, size_t &chunkStart) {
+        auto bits = log2(idx + CHUNK_BASE);
+        chunkStart = (static_cast<size_t>(1) << bits) - CHUNK_BASE;
+        return bits - CHUNK_BASE_BITS;
+    }
+
+    static size_t getShardIdx(const Pointer &ptr) {
+        // the nodes are aligned, ignore the lowest bits
+        auto h = reinterpret_cast<uintptr_t>(ptr.target) >> 4;
+        return (h ^ (h >> 8)) % SHARDS_NUM;
+    }
+
+    Shard &getShard(const Pointer &ptr) { return _shards[getShardIdx(ptr)]; }
+
+    const Shard &getShard(const Pointer &ptr) const {
+        return _shards[getShardIdx(ptr)];
+    }
+
+    void store(IDTy id, const Pointer &ptr) {
+        size_t chunkStart;
+        auto k = getChunk(id - 1, chunkStart);
+        assert(k < _chunks.size());
+        Pointer *chunk = _chunks[k].load(std::memory_order_acquire);
+        if (!chunk) {
+            auto *newChunk = new Pointer[CHUNK_BASE << k];
+            if (_chunks[k].compare_exchange_strong(chunk, newChunk,
+                                                   std::memory_order_acq_rel))
+                chunk = newChunk;
+            else // other thread created the chunk
+                delete[] newChunk;
+        }
+        chunk[id - 1 - chunkStart] = ptr;
+    }
+
+    IDTy _getOrCreate(Shard &shard, const Pointer &ptr) {
+        auto res = _get(shard, ptr);
         if (res != 0)
             return res;
 
-        _idToPtr.push_back(ptr);
-        res = _idToPtr.size();
+        res = _lastID.fetch_add(1) + 1;
+        store(res, ptr);
 #ifndef NDEBUG
         bool r =
 #endif
-                _ptrToID[ptr.target].put(ptr.offset, res);
+                shard.ptrToID[ptr.target].put(ptr.offset, res);
 
         assert(r && "Duplicated ID!");
         assert(get(res) == ptr);
-        assert(res == get(ptr));
+        assert(res == _get(shard, ptr));
         assert(res > 0 && "ID must always be greater than 0");
+        assert(!isSpecialID(res) && "Too many pointers");
         return res;
     }
 
-    IDTy get(const Pointer &ptr) const {
-        auto it = _ptrToID.find(ptr.target);
-        if (it == _ptrToID.end()) {
+    static IDTy _get(const Shard &shard, const Pointer &ptr) {
+        auto it = shard.ptrToID.find(ptr.target);
+        if (it == shard.ptrToID.end()) {
             return 0; // invalid ID
         }
         auto it2 = it->second.find(ptr.offset);
@@ -59,23 +286,58 @@ class PointerIDLookupTable {
             return 0;
         return it2->second;
     }
+};
 
-    const Pointer &get(IDTy id) const {
-        assert(id - 1 < _idToPtr.size());
-        return _idToPtr[id - 1];
-    }
+inline PointerIDLookupTable::IDTy
+PointerIDLookupTable::getID(const Pointer &ptr) {
+    if (isSpecial(ptr))
+        return getSpecialID(ptr);
+    return getPointerIDs(ptr.target)->getOrCreate(ptr);
+}
 
-  private:
-    // PSNode -> (Offset -> id)
-    // Not space efficient, but we need mainly the time efficiency here...
-    // NOTE: unfortunately, atm, we cannot use the id of the target for hashing
-    // because it would break repeated runs of the analysis
-    // as multiple graphs will contain nodes with the same id
-    // (and resetting the state is really painful, I tried that,
-    // but just didn't succeed).
-    PtrToIDMap _ptrToID;
-    std::vector<Pointer> _idToPtr; // starts from 0 (pointer = idVector[id - 1])
-};
+inline void PointerIDLookupTable::bindTable(PointerIDLookupTable *&table,
+                                            const PSNode *node) {
+    if (isSpecial({const_cast<PSNode *>(node), 0}))
+        return;
+    if (!table)
+        table = getPointerIDs(node);
+    assert(table == getPointerIDs(node) &&
+           "Pointers to nodes of different graphs in one set");
+}
+
+inline pta::Pointer
+PointerIDLookupTable::getPointer(const PointerIDLookupTable *table, IDTy id) {
+    if (isSpecialID(id))
+        return getSpecialPointer(id);
+    assert(table && "Have a pointer but not the table");
+    return table->get(id);
+}
+
+inline PointerIDLookupTable::IDTy
+PointerIDLookupTable::getNodeID(PSNode *node) {
+    if (node == pta::NULLPTR)
+        return 1;
+    if (node == pta::UNKNOWN_MEMORY)
+        return 2;
+    if (node == pta::INVALIDATED)
+        return 3;
+    return getPointerIDs(node)->getOrCreate({node, 0}) + 3;
+}
+
+inline pta::PSNode *
+PointerIDLookupTable::getNode(const PointerIDLookupTable *table, IDTy id) {
+    switch (id) {
+    case 1:
+        return pta::NULLPTR;
+    case 2:
+        return pta::UNKNOWN_MEMORY;
+    case 3:
+        return pta::INVALIDATED;
+    default:
+        assert(table && "Have a node but not the table");
+        return table->get(id - 3).target;
+    }
+}
 
 /*
 class PointerIDLookupTable {
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "LookupTable.h"
@@ -15,21 +16,45 @@ namespace pta {
 class PSNode;
 
 class PointerIdPointsToSet {
-    static PointerIDLookupTable lookupTable;
-
 #if defined(HAVE_TSL_HOPSCOTCH) || (__clang__)
     using PointersT = ADT::SparseBitvectorHashImpl;
 #else
     using PointersT = ADT::SparseBitvector;
 #endif
     PointersT pointers;
+    // The table of IDs of the graph whose nodes are pointed to by
+    // the pointers in this set. It is nullptr while the set contains only
+    // pointers to special nodes (these do not need any table).
+    PointerIDLookupTable *_table{nullptr};
+
+    PointerIDLookupTable *getTable(const Pointer &ptr) {
+        if (!_table)
+            _table = getPointerIDs(ptr.target);
+        assert(_table == getPointerIDs(ptr.target) &&
+               "Pointers to nodes of different graphs in one set");
+        return _table;
+    }
 
     // if the pointer doesn't have ID, it's assigned one
-    static size_t getPointerID(const Pointer &ptr) {
-        return lookupTable.getOrCreate(ptr);
+    size_t getPointerID(const Pointer &ptr) {
+        if (PointerIDLookupTable::isSpecial(ptr))
+            return PointerIDLookupTable::getSpecialID(ptr);
+        return getTable(ptr)->getOrCreate(ptr);
     }
 
-    static const Pointer &getPointer(size_t id) { return lookupTable.get(id); }
+    // return the ID of the pointer or 0 if the pointer cannot be in the set
+    size_t findPointerID(const Pointer &ptr) const {
+        if (PointerIDLookupTable::isSpecial(ptr))
+            return PointerIDLookupTable::getSpecialID(ptr);
+        return _table ? _table->get(ptr) : 0;
+    }
+
+    Pointer getPointer(size_t id) const {
+        if (PointerIDLookupTable::isSpecialID(id))
+            return PointerIDLookupTable::getSpecialPointer(id);
+        assert(_table && "Have a pointer but not the table");
+        return _table->get(id);
+    }
 
     bool addWithUnknownOffset(PSNode *node) {
         auto ptrid = getPointerID({node, Offset::UNKNOWN});
@@ -66,10 +91,17 @@ class PointerIdPointsToSet {
         return changed;
     }
 
-    bool add(const PointerIdPointsToSet &S) { return pointers.set(S.pointers); }
+    bool add(const PointerIdPointsToSet &S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table) &&
+               "Pointers to nodes of different graphs in one set");
+        return pointers.set(S.pointers);
+    }
 
     bool remove(const Pointer &ptr) {
-        return pointers.unset(getPointerID(ptr));
+        auto id = findPointerID(ptr);
+        return id != 0 && pointers.unset(id);
     }
 
     bool remove(PSNode *target, Offset offset) {
@@ -81,7 +113,7 @@ class PointerIdPointsToSet {
         tmp.reserve(pointers.size());
         bool removed = false;
         for (const auto &ptrID : pointers) {
-            if (lookupTable.get(ptrID).target != target) {
+            if (getPointer(ptrID).target != target) {
                 tmp.set(ptrID);
             } else {
                 removed = true;
@@ -96,7 +128,8 @@ class PointerIdPointsToSet {
     void clear() { pointers.reset(); }
 
     bool pointsTo(const Pointer &ptr) const {
-        return pointers.get(getPointerID(ptr));
+        auto id = findPointerID(ptr);
+        return id != 0 && pointers.get(id);
     }
 
     bool mayPointTo(const Pointer &ptr) const {
@@ -145,13 +178,18 @@ class PointerIdPointsToSet {
 
     size_t size() const { return pointers.size(); }
 
-    void swap(PointerIdPointsToSet &rhs) { pointers.swap(rhs.pointers); }
+    void swap(PointerIdPointsToSet &rhs) {
+        pointers.swap(rhs.pointers);
+        std::swap(_table, rhs._table);
+    }
 
     class const_iterator {
+        const PointerIdPointsToSet *set;
         typename PointersT::const_iterator container_it;
 
-        const_iterator(const PointersT &pointers, bool end = false)
-                : container_it(end ? pointers.end() : pointers.begin()) {}
+        const_iterator(const PointerIdPointsToSet *s, bool end = false)
+                : set(s), container_it(end ? s->pointers.end()
+                                           : s->pointers.begin()) {}
 
       public:
         const_iterator &operator++() {
@@ -165,7 +203,7 @@ class PointerIdPointsToSet {
             return tmp;
         }
 
-        Pointer operator*() const { return {lookupTable.get(*container_it)}; }
+        Pointer operator*() const { return set->getPointer(*container_it); }
 
         bool operator==(const const_iterator &rhs) const {
             return container_it == rhs.container_it;
@@ -178,8 +216,8 @@ class PointerIdPointsToSet {
         friend class PointerIdPointsToSet;
     };
 
-    const_iterator begin() const { return {pointers}; }
-    const_iterator end() const { return {pointers, true /* end */}; }
+    const_iterator begin() const { return {this}; }
+    const_iterator end() const { return {this, true /* end */}; }
 
     friend class const_iterator;
 };
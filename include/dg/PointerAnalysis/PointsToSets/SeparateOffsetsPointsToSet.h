@@ -3,9 +3,12 @@
 
 #include "dg/ADT/Bitvector.h"
 #include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
 
+#include <cassert>
 #include <cstdlib>
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace dg {
@@ -16,18 +19,13 @@ class PSNode;
 class SeparateOffsetsPointsToSet {
     ADT::SparseBitvector nodes;
     ADT::SparseBitvector offsets;
-    static std::map<PSNode *, size_t> ids; // nodes are numbered 1, 2, ...
-    static std::vector<PSNode *>
-            idVector; // starts from 0 (node = idVector[id - 1])
+    // the table of IDs of the graph of the pointed nodes
+    // (nullptr while there are only pointers to special nodes)
+    PointerIDLookupTable *_table{nullptr};
 
     // if the node doesn't have ID, it is assigned one
     static size_t getNodeID(PSNode *node) {
-        auto it = ids.find(node);
-        if (it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(node);
-        return ids.emplace_hint(it, node, ids.size() + 1)->second;
+        return PointerIDLookupTable::getNodeID(node);
     }
 
   public:
@@ -37,6 +35,7 @@ class SeparateOffsetsPointsToSet {
     }
 
     bool add(PSNode *target, Offset off) {
+        PointerIDLookupTable::bindTable(_table, target);
         if (offsets.get(Offset::UNKNOWN)) {
             return !nodes.set(getNodeID(target));
         }
@@ -50,6 +49,10 @@ class SeparateOffsetsPointsToSet {
     bool add(const Pointer &ptr) { return add(ptr.target, ptr.offset); }
 
     bool add(const SeparateOffsetsPointsToSet &S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table) &&
+               "Pointers to nodes of different graphs in one set");
         bool changed = nodes.set(S.nodes);
         return offsets.set(S.offsets) || changed;
     }
@@ -105,20 +108,23 @@ class SeparateOffsetsPointsToSet {
     void swap(SeparateOffsetsPointsToSet &rhs) {
         nodes.swap(rhs.nodes);
         offsets.swap(rhs.offsets);
+        std::swap(_table, rhs._table);
     }
 
     // iterates through all the possible combinations of nodes and their offsets
     // stored in this points-to set
     class const_iterator {
+        const PointerIDLookupTable *table;
         typename ADT::SparseBitvector::const_iterator nodes_it;
         typename ADT::SparseBitvector::const_iterator nodes_end;
         typename ADT::SparseBitvector::const_iterator offsets_it;
         typename ADT::SparseBitvector::const_iterator offsets_begin;
         typename ADT::SparseBitvector::const_iterator offsets_end;
 
-        const_iterator(const ADT::SparseBitvector &nodes,
+        const_iterator(const PointerIDLookupTable *table,
+                       const ADT::SparseBitvector &nodes,
                        const ADT::SparseBitvector &offsets, bool end = false)
-                : nodes_it(end ? nodes.end() : nodes.begin()),
+                : table(table), nodes_it(end ? nodes.end() : nodes.begin()),
                   nodes_end(nodes.end()), offsets_it(offsets.begin()),
                   offsets_begin(offsets.begin()), offsets_end(offsets.end()) {
             if (nodes_it == nodes_end) {
@@ -145,7 +151,7 @@ class SeparateOffsetsPointsToSet {
         }
 
         Pointer operator*() const {
-            return {idVector[*nodes_it - 1], *offsets_it};
+            return {PointerIDLookupTable::getNode(table, *nodes_it), *offsets_it};
         }
 
         bool operator==(const const_iterator &rhs) const {
@@ -159,8 +165,10 @@ class SeparateOffsetsPointsToSet {
         friend class SeparateOffsetsPointsToSet;
     };
 
-    const_iterator begin() const { return {nodes, offsets}; }
-    const_iterator end() const { return {nodes, offsets, true /* end */}; }
+    const_iterator begin() const { return {_table, nodes, offsets}; }
+    const_iterator end() const {
+        return {_table, nodes, offsets, true /* end */};
+    }
 
     friend class const_iterator;
 };
@@ -4,10 +4,12 @@
 #include <cassert>
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "dg/ADT/Bitvector.h"
 #include "dg/PointerAnalysis/Pointer.h"
+#include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
 #include "dg/util/iterators.h"
 
 namespace dg {
@@ -19,18 +21,13 @@ class SmallOffsetsPointsToSet {
     static const size_t MAX_OFFSET = 63;
     ADT::SparseBitvector pointers;
     std::set<Pointer> largePointers;
-    static std::map<PSNode *, size_t> ids; // nodes are numbered 1,2, ...
-    static std::vector<PSNode *>
-            idVector; // starts from 0 (node = idVector[id - 1])
+    // the table of IDs of the graph of the pointed nodes
+    // (nullptr while there are only pointers to special nodes)
+    PointerIDLookupTable *_table{nullptr};
 
     // if the node doesn't have ID, it's assigned one
     static size_t getNodeID(PSNode *node) {
-        auto it = ids.find(node);
-        if (it != ids.end()) {
-            return it->second;
-        }
-        idVector.push_back(node);
-        return ids.emplace_hint(it, node, ids.size() + 1)->second;
+        return PointerIDLookupTable::getNodeID(node);
     }
 
     static size_t getNodePosition(PSNode *node) {
@@ -60,6 +57,7 @@ class SmallOffsetsPointsToSet {
     }
 
     bool add(PSNode *target, Offset off) {
+        PointerIDLookupTable::bindTable(_table, target);
         if (has({target, Offset::UNKNOWN})) {
             return false;
         }
@@ -75,6 +73,10 @@ class SmallOffsetsPointsToSet {
     bool add(const Pointer &ptr) { return add(ptr.target, ptr.offset); }
 
     bool add(const SmallOffsetsPointsToSet &S) {
+        if (!_table)
+            _table = S._table;
+        assert((!S._table || S._table == _table) &&
+               "Pointers to nodes of different graphs in one set");
         bool changed = pointers.set(S.pointers);
         for (const auto &ptr : S.largePointers) {
             changed |= largePointers.insert(ptr).second;
@@ -165,20 +167,23 @@ class SmallOffsetsPointsToSet {
     void swap(SmallOffsetsPointsToSet &rhs) {
         pointers.swap(rhs.pointers);
         largePointers.swap(rhs.largePointers);
+        std::swap(_table, rhs._table);
     }
 
     size_t overflowSetSize() const { return largePointers.size(); }
 
     // iterates over the bitvector first, then over the set
     class const_iterator {
+        const PointerIDLookupTable *table;
         typename ADT::SparseBitvector::const_iterator bitvector_it;
         typename ADT::SparseBitvector::const_iterator bitvector_end;
         typename std::set<Pointer>::const_iterator set_it;
         bool secondContainer;
 
-        const_iterator(const ADT::SparseBitvector &pointers,
+        const_iterator(const PointerIDLookupTable *table,
+                       const ADT::SparseBitvector &pointers,
                        const std::set<Pointer> &largePointers, bool end = false)
-                : bitvector_it(end ? pointers.end() : pointers.begin()),
+                : table(table), bitvector_it(end ? pointers.end() : pointers.begin()),
                   bitvector_end(pointers.end()),
                   set_it(end ? largePointers.end() : largePointers.begin()),
                   secondContainer(end) {
@@ -212,8 +217,9 @@ class SmallOffsetsPointsToSet {
                 size_t nodeID =
                         ((*bitvector_it - offsetID) / (MAX_OFFSET + 1)) + 1;
                 return offsetID == MAX_OFFSET
-                               ? Pointer(idVector[nodeID - 1], Offset::UNKNOWN)
-                               : Pointer(idVector[nodeID - 1], offsetID);
+                               ? Pointer(PointerIDLookupTable::getNode(table, nodeID),
+                                         Offset::UNKNOWN)
+                               : Pointer(PointerIDLookupTable::getNode(table, nodeID), offsetID);
             }
             return *set_it;
         }
@@ -229,9 +235,9 @@ class SmallOffsetsPointsToSet {
         friend class SmallOffsetsPointsToSet;
     };
 
-    const_iterator begin() const { return {pointers, largePointers}; }
+    const_iterator begin() const { return {_table, pointers, largePointers}; }
     const_iterator end() const {
-        return {pointers, largePointers, true /* end */};
+        return {_table, pointers, largePointers, true /* end */};
     }
 
     friend class const_iterator;
@@ -7,6 +7,7 @@
 #include <set>
 
 #include "dg/ADT/IntervalsList.h"
+#include "dg/ADT/SortedVectorSet.h"
 #include "dg/Offset.h"
 
 namespace dg {
@@ -108,8 +109,10 @@ using DefSite = GenericDefSite<RWNode>;
 
 extern RWNode *UNKNOWN_MEMORY;
 
-// FIXME: change this std::set to std::map (target->offsets)
-class DefSiteSet : public std::set<DefSite> {
+// FIXME: change this to a map (target->offsets)
+// The set is kept in a sorted vector, nodes have only few
+// def-sites and the sets are mostly just iterated over.
+class DefSiteSet : public ADT::SortedVectorSet<DefSite> {
   public:
     DefSiteSet intersect(const DefSiteSet &rhs) const {
         std::map<DefSite::NodeTy *, IntervalsList> lhssites;
@@ -128,7 +131,7 @@ class DefSiteSet : public std::set<DefSite> {
             auto rit = rhssites.find(lit.first);
             if (rit != rhssites.end()) {
                 for (const auto &I : lit.second.intersectWith(rit->second)) {
-                    retval.emplace(lit.first, I.start, I.length());
+                    retval.insert(DefSite(lit.first, I.start, I.length()));
                 }
             }
         }
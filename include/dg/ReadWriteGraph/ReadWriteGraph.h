@@ -4,6 +4,7 @@
 #include <memory>
 #include <vector>
 
+#include "dg/ADT/Arena.h"
 #include "dg/BFS.h"
 #include "dg/ReadWriteGraph/RWBBlock.h"
 #include "dg/ReadWriteGraph/RWNode.h"
@@ -16,9 +17,14 @@ namespace dda {
 
 class ReadWriteGraph {
     size_t lastNodeID{0};
-    using NodesT = std::vector<std::unique_ptr<RWNode>>;
+    using NodesT = std::vector<RWNode *>;
     using SubgraphsT = std::vector<std::unique_ptr<RWSubgraph>>;
 
+    // The nodes are allocated in the arena, so that creating them
+    // does not need an allocation for every single node. The nodes still
+    // own their def-sites and edges in containers, so they are destroyed
+    // one by one; only their memory is freed at once.
+    ADT::Arena _arena;
     NodesT _nodes;
     SubgraphsT _subgraphs;
     RWSubgraph *_entry{nullptr};
@@ -48,10 +54,45 @@ class ReadWriteGraph {
         subgraph_iterator end() { return {subgraphs.end()}; }
     };
 
+    void destroy() {
+        // destroy the subgraphs before the nodes (as the subgraphs were
+        // destroyed before the nodes when the nodes were in unique_ptrs)
+        _subgraphs.clear();
+        _entry = nullptr;
+        // the memory of the nodes is owned by the arena
+        for (auto *n : _nodes)
+            n->~RWNode();
+        _nodes.clear();
+    }
+
   public:
     ReadWriteGraph() = default;
-    ReadWriteGraph(ReadWriteGraph &&) = default;
-    ReadWriteGraph &operator=(ReadWriteGraph &&) = default;
+    ReadWriteGraph(ReadWriteGraph &&rhs)
+            : lastNodeID(rhs.lastNodeID), _arena(std::move(rhs._arena)),
+              _nodes(std::move(rhs._nodes)),
+              _subgraphs(std::move(rhs._subgraphs)), _entry(rhs._entry) {
+        // the moved-from graph is empty
+        rhs.lastNodeID = 0;
+        rhs._nodes.clear();
+        rhs._entry = nullptr;
+    }
+    ReadWriteGraph(const ReadWriteGraph &) = delete;
+
+    ReadWriteGraph &operator=(ReadWriteGraph &&rhs) {
+        if (this == &rhs)
+            return *this;
+        destroy();
+        lastNodeID = rhs.lastNodeID;
+        _arena.swap(rhs._arena);
+        _nodes.swap(rhs._nodes);
+        _subgraphs = std::move(rhs._subgraphs);
+        _entry = rhs._entry;
+        rhs.lastNodeID = 0;
+        rhs._entry = nullptr;
+        return *this;
+    }
+
+    ~ReadWriteGraph() { destroy(); }
 
     RWSubgraph *getEntry() { return _entry; }
     const RWSubgraph *getEntry() const { return _entry; }
@@ -63,14 +104,14 @@ class ReadWriteGraph {
 
     RWNode *getNode(unsigned id) {
         assert(id - 1 < _nodes.size());
-        auto *n = _nodes[id - 1].get();
+        auto *n = _nodes[id - 1];
         assert(n->getID() == id);
         return n;
     }
 
     const RWNode *getNode(unsigned id) const {
         assert(id - 1 < _nodes.size());
-        auto *n = _nodes[id - 1].get();
+        auto *n = _nodes[id - 1];
         assert(n->getID() == id);
         return n;
     }
@@ -78,16 +119,16 @@ class ReadWriteGraph {
     RWNode &create(RWNodeType t) {
         switch (t) {
             case RWNodeType::CALL:
-                _nodes.emplace_back(new RWNodeCall(++lastNodeID));
+                _nodes.push_back(_arena.create<RWNodeCall>(++lastNodeID));
                 break;
             case RWNodeType::FORK:
-                _nodes.emplace_back(new RWNodeFork(++lastNodeID));
+                _nodes.push_back(_arena.create<RWNodeFork>(++lastNodeID));
                 break;
             default:
-                _nodes.emplace_back(new RWNode(++lastNodeID, t));
+                _nodes.push_back(_arena.create<RWNode>(++lastNodeID, t));
         }
 
-        return *_nodes.back().get();
+        return *_nodes.back();
     }
 
     RWSubgraph &createSubgraph() {
@@ -2,7 +2,9 @@
 #define DG_SLICING_H_
 
 #include <set>
+#include <vector>
 
+#include "dg/ADT/Bitvector.h"
 #include "dg/ADT/Queue.h"
 #include "dg/DependenceGraph.h"
 #include "dg/legacy/Analysis.h"
@@ -126,6 +128,163 @@ class WalkAndMark
     }
 };
 
+///
+// The nodes (and blocks and graphs) that are in one slice. Unlike
+// WalkAndMark, this does not store the slice ID into the nodes, but keeps
+// the slice in bitsets of node IDs and only reads the graph. Therefore,
+// more slices of one graph can be marked at once (e.g., in more threads).
+// The slice is stored into the nodes by apply() and then the graph can be
+// sliced as usual.
+template <typename NodeT>
+class SliceMarking {
+    using Queue = dg::ADT::QueueFIFO<NodeT *>;
+
+    bool forward_slice{false};
+    // IDs of the nodes in the slice
+    ADT::SparseBitvector nodes;
+    // the nodes that were marked (including the unmarked ones)
+    std::vector<NodeT *> markedNodes;
+    std::set<BBlock<NodeT> *> markedBlocks;
+    std::set<DependenceGraph<NodeT> *> markedGraphs;
+
+    // Walk the same edges as WalkAndMark does from the nodes 'start'
+    // and mark all the visited nodes. If 'walkedBlocks' is given,
+    // the blocks of the visited nodes are stored there.
+    void walk(const std::set<NodeT *> &start, bool forward,
+              std::set<BBlock<NodeT> *> *walkedBlocks) {
+        // every walk visits the nodes again, a node that is already
+        // in the slice may lead to new nodes in the forward slice
+        ADT::SparseBitvector visited;
+        Queue queue;
+        auto enqueue = [&visited, &queue](NodeT *n) {
+            if (!visited.set(n->getID()))
+                queue.push(n);
+        };
+
+        for (NodeT *n : start)
+            enqueue(n);
+
+        while (!queue.empty()) {
+            NodeT *n = queue.pop();
+            if (!nodes.set(n->getID()))
+                markedNodes.push_back(n);
+
+#ifdef ENABLE_CFG
+            if (BBlock<NodeT> *B = n->getBBlock()) {
+                markedBlocks.insert(B);
+                if (walkedBlocks)
+                    walkedBlocks->insert(B);
+
+                if (forward) {
+                    for (auto it = n->control_begin(), et = n->control_end();
+                         it != et; ++it)
+                        enqueue(*it);
+
+                    if (n == B->getLastNode()) {
+                        for (BBlock<NodeT> *CD : B->controlDependence()) {
+                            for (auto *cdnd : CD->getNodes())
+                                enqueue(cdnd);
+                        }
+                    }
+                } else {
+                    for (BBlock<NodeT> *CD : B->revControlDependence())
+                        enqueue(CD->getLastNode());
+                }
+            }
+#endif
+
+            if (DependenceGraph<NodeT> *dg = n->getDG()) {
+                markedGraphs.insert(dg);
+                if (!forward) {
+                    NodeT *entry = dg->getEntry();
+                    assert(entry && "No entry node in dg");
+                    enqueue(entry);
+                }
+            }
+
+            if (forward) {
+                for (auto it = n->data_begin(), et = n->data_end(); it != et;
+                     ++it)
+                    enqueue(*it);
+                for (auto it = n->use_begin(), et = n->use_end(); it != et;
+                     ++it)
+                    enqueue(*it);
+                for (auto it = n->interference_begin(),
+                          et = n->interference_end();
+                     it != et; ++it)
+                    enqueue(*it);
+            } else {
+                for (auto it = n->rev_control_begin(),
+                          et = n->rev_control_end();
+                     it != et; ++it)
+                    enqueue(*it);
+                for (auto it = n->rev_data_begin(), et = n->rev_data_end();
+                     it != et; ++it)
+                    enqueue(*it);
+                for (auto it = n->user_begin(), et = n->user_end(); it != et;
+                     ++it)
+                    enqueue(*it);
+                for (auto it = n->interference_begin(),
+                          et = n->interference_end();
+                     it != et; ++it)
+                    enqueue(*it);
+                for (auto it = n->rev_interference_begin(),
+                          et = n->rev_interference_end();
+                     it != et; ++it)
+                    enqueue(*it);
+            }
+        }
+    }
+
+  public:
+    SliceMarking(bool forward_slc = false) : forward_slice(forward_slc) {}
+
+    ///
+    // Add the nodes dependent on 'start' to the slice (the same nodes
+    // as Slicer::mark() marks).
+    void mark(NodeT *start) {
+        std::set<BBlock<NodeT> *> blocks;
+        walk({start}, forward_slice, forward_slice ? &blocks : nullptr);
+
+        // make the forward slice executable, see Slicer::mark()
+        if (forward_slice) {
+            std::set<NodeT *> inslice;
+#ifdef ENABLE_CFG
+            for (auto *BB : blocks) {
+                for (auto *nd : BB->getNodes()) {
+                    if (isMarked(nd)) {
+                        inslice.insert(nd);
+                    }
+                }
+            }
+#endif
+            if (!inslice.empty())
+                walk(inslice, false, nullptr);
+        }
+    }
+
+    // remove the node from the slice
+    void unmark(NodeT *n) { nodes.unset(n->getID()); }
+
+    bool isMarked(const NodeT *n) const { return nodes.get(n->getID()); }
+    bool isForward() const { return forward_slice; }
+    size_t size() const { return nodes.size(); }
+
+    ///
+    // Store the slice into the nodes, blocks and graphs as 'slice_id',
+    // so that the graph can be sliced by Slicer::slice().
+    void apply(uint32_t slice_id) const {
+        for (auto *dg : markedGraphs)
+            dg->setSlice(slice_id);
+#ifdef ENABLE_CFG
+        for (auto *B : markedBlocks)
+            B->setSlice(slice_id);
+#endif
+        for (auto *n : markedNodes)
+            n->setSlice(isMarked(n) ? slice_id : 0);
+    }
+};
+
 struct SlicerStatistics {
     SlicerStatistics() = default;
 
@@ -18,6 +18,21 @@
 namespace dg {
 namespace vr {
 
+// Orders buckets by their ids, so the order does not depend on where
+// the buckets were allocated and a copy of a graph has the same order
+// of buckets. Buckets can be searched also by the id.
+struct BucketIdLess {
+    using is_transparent = void;
+
+    static size_t id(const std::unique_ptr<Bucket> &b) { return b->id; }
+    static size_t id(size_t i) { return i; }
+
+    template <typename L, typename R>
+    bool operator()(const L &lt, const R &rt) const {
+        return id(lt) < id(rt);
+    }
+};
+
 template <typename T>
 class RelationsGraph {
   public:
@@ -40,7 +55,7 @@ class RelationsGraph {
     }
 
   private:
-    using UniqueBucketSet = std::set<std::unique_ptr<Bucket>>;
+    using UniqueBucketSet = std::set<std::unique_ptr<Bucket>, BucketIdLess>;
 
     class EdgeIterator {
         using BucketIterator = UniqueBucketSet::iterator;
@@ -137,7 +152,7 @@ class RelationsGraph {
 
     //*********************** end iterator stuff **********************
 
-    T &reported;
+    T *reported;
     UniqueBucketSet buckets;
     size_t lastId = 0;
 
@@ -154,19 +169,16 @@ class RelationsGraph {
                     pair.second = to;
             }
         }
-        reported.areMerged(to, from);
+        reported->areMerged(to, from);
         to.merge(from);
         erase(from);
         return true;
     }
 
     UniqueBucketSet::iterator getItFor(const Bucket &bucket) const {
-        for (auto it = buckets.begin(); it != buckets.end(); ++it) {
-            if (**it == bucket)
-                return it;
-        }
-        assert(0 && "unreachable");
-        abort();
+        auto it = buckets.find(bucket.id);
+        assert(it != buckets.end() && "unreachable");
+        return it;
     }
 
     static RelationsMap &filterResult(const Relations &relations,
@@ -281,9 +293,40 @@ class RelationsGraph {
     }
 
   public:
-    RelationsGraph(T &r) : reported(r) {}
+    RelationsGraph(T &r) : reported(&r) {}
     RelationsGraph(const RelationsGraph &) = delete;
 
+    // the copy has the same buckets (with the same ids) and relations
+    // as the other graph
+    RelationsGraph(T &r, const RelationsGraph &other)
+            : reported(&r), lastId(other.lastId) {
+        for (const auto &bucketPtr : other.buckets)
+            buckets.emplace_hint(buckets.end(), new Bucket(bucketPtr->id));
+
+        for (const auto &bucketPtr : other.buckets) {
+            Bucket &bucket = *getItFor(*bucketPtr)->get();
+            for (Relations::Type type : Relations::all) {
+                if (type == Relations::EQ)
+                    continue;
+                for (const Bucket &related : bucketPtr->relatedBuckets[type])
+                    bucket.relatedBuckets[type].sure_emplace(
+                            *getItFor(related)->get());
+            }
+        }
+
+        for (const auto &pair : other.borderBuckets)
+            borderBuckets.emplace_back(pair.first,
+                                       *getBucket(pair.second.get().id));
+    }
+
+    // the graph reports merging of buckets to the given object
+    void setReported(T &r) { reported = &r; }
+
+    const Bucket *getBucket(size_t id) const {
+        auto it = buckets.find(id);
+        return it == buckets.end() ? nullptr : it->get();
+    }
+
     using iterator = EdgeIterator;
 
     Relations relationsBetween(const Bucket &lt, const Bucket &rt) const {
@@ -17,7 +17,8 @@ class LLVMPointerAnalysis;
 
 namespace llvmdg {
 class CallGraph;
-}
+class CDCache;
+} // namespace llvmdg
 
 class LLVMControlDependenceAnalysis {
   public:
@@ -28,14 +29,21 @@ class LLVMControlDependenceAnalysis {
     const LLVMControlDependenceAnalysisOptions _options;
     std::unique_ptr<LLVMControlDependenceAnalysisImpl> _impl{nullptr};
     std::unique_ptr<LLVMControlDependenceAnalysisImpl> _interprocImpl{nullptr};
+    // intraprocedural dependencies of functions kept between runs
+    std::unique_ptr<llvmdg::CDCache> _cache{nullptr};
 
     void initializeImpl(LLVMPointerAnalysis *pta = nullptr,
                         llvmdg::CallGraph *cg = nullptr);
 
+    ValVec _getCachedDependencies(const llvm::Instruction *I);
+    ValVec _getCachedDependencies(const llvm::BasicBlock *b);
+    void _computeCached(const llvm::Function *F);
+
     template <typename ValT>
     ValVec _getDependencies(ValT v) {
         assert(_impl);
-        auto ret = _impl->getDependencies(v);
+        auto ret = _cache ? _getCachedDependencies(v)
+                          : _impl->getDependencies(v);
 
         if (getOptions().interproceduralCD()) {
             assert(_interprocImpl);
@@ -61,10 +69,10 @@ class LLVMControlDependenceAnalysis {
   public:
     LLVMControlDependenceAnalysis(const llvm::Module *module,
                                   LLVMControlDependenceAnalysisOptions opts,
-                                  LLVMPointerAnalysis *pta = nullptr)
-            : _module(module), _options(std::move(opts)) {
-        initializeImpl(pta);
-    }
+                                  LLVMPointerAnalysis *pta = nullptr);
+
+    // writes the new results to the cache file (if any)
+    ~LLVMControlDependenceAnalysis();
 
     // public API
     const llvm::Module *getModule() const { return _module; }
@@ -83,8 +91,13 @@ class LLVMControlDependenceAnalysis {
     // or the whole module if the function is nullptr.
     // (so you don't want to call that if you want
     //  on demand)
+    // With the cache file, only the functions that are not
+    // in the cache are computed.
     void compute(const llvm::Function *F = nullptr) {
-        _impl->compute(F);
+        if (_cache)
+            _computeCached(F);
+        else
+            _impl->compute(F);
         if (getOptions().interproceduralCD())
             _interprocImpl->compute(F);
     }
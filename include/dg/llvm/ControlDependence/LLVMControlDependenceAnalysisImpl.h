@@ -3,6 +3,7 @@
 
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisOptions.h"
 
@@ -50,6 +51,14 @@ class LLVMControlDependenceAnalysisImpl {
     //  on demand)
     virtual void compute(const llvm::Function *F = nullptr) = 0;
 
+    // Compute control dependencies for the given functions. The analyses
+    // that compute every function separately do it in parallel.
+    virtual void
+    computeFunctions(const std::vector<const llvm::Function *> &functions) {
+        for (const auto *F : functions)
+            compute(F);
+    }
+
     /// Getters of dependencies for a value
     virtual ValVec getDependencies(const llvm::Instruction *) = 0;
     virtual ValVec getDependent(const llvm::Instruction *) = 0;
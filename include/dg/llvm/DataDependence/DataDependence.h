@@ -83,6 +83,16 @@ class LLVMDataDependenceAnalysis {
         return DDA->getDefinitions(use);
     }
 
+    std::vector<std::vector<RWNode *>>
+    getDefinitions(const std::vector<DefinitionsQuery> &queries) {
+        return DDA->getDefinitions(queries);
+    }
+
+    bool getKnownDefinitions(const DefinitionsQuery &query,
+                             std::vector<RWNode *> &defs) const {
+        return DDA->getKnownDefinitions(query, defs);
+    }
+
     std::vector<RWNode *> getDefinitions(llvm::Instruction *where,
                                          llvm::Value *mem, const Offset &off,
                                          const Offset &len) {
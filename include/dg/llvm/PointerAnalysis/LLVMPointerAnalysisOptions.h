@@ -8,13 +8,20 @@ namespace dg {
 
 struct LLVMPointerAnalysisOptions : public LLVMAnalysisOptions,
                                     PointerAnalysisOptions {
-    enum class AnalysisType { fi, fs, inv, svf } analysisType{AnalysisType::fi};
+    enum class AnalysisType {
+        fi,
+        fs,
+        inv,
+        sfs,
+        svf
+    } analysisType{AnalysisType::fi};
 
     bool threads{false};
 
     bool isFS() const { return analysisType == AnalysisType::fs; }
     bool isFSInv() const { return analysisType == AnalysisType::inv; }
     bool isFI() const { return analysisType == AnalysisType::fi; }
+    bool isSFS() const { return analysisType == AnalysisType::sfs; }
     bool isSVF() const { return analysisType == AnalysisType::svf; }
 };
 
@@ -13,6 +13,7 @@
 #include "dg/PointerAnalysis/PointerAnalysisFI.h"
 #include "dg/PointerAnalysis/PointerAnalysisFS.h"
 #include "dg/PointerAnalysis/PointerAnalysisFSInv.h"
+#include "dg/PointerAnalysis/PointerAnalysisSFS.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
 #include "dg/PointerAnalysis/PointerGraphOptimizations.h"
 
@@ -93,6 +94,12 @@ class DGLLVMPointerAnalysisImpl : public PTType {
                               const LLVMPointerAnalysisOptions &opts)
             : PTType(PS, opts), builder(b) {}
 
+    // the hooks for threads (handleJoin) read the points-to sets
+    // of nodes directly, so the sets must not be shared
+    bool canCollapseCycles() const override {
+        return !builder->threads() && PTType::canCollapseCycles();
+    }
+
     // build new subgraphs on calls via pointer
     bool functionPointerCall(PSNode *callsite, PSNode *called) override {
         using namespace pta;
@@ -319,6 +326,9 @@ class DGLLVMPointerAnalysis : public LLVMPointerAnalysis {
         } else if (options.isFSInv()) {
             PTA.reset(new DGLLVMPointerAnalysisImpl<pta::PointerAnalysisFSInv>(
                     PS, _builder.get(), options));
+        } else if (options.isSFS()) {
+            PTA.reset(new DGLLVMPointerAnalysisImpl<pta::PointerAnalysisSFS>(
+                    PS, _builder.get(), options));
         } else {
             assert(0 && "Wrong pointer analysis");
             abort();
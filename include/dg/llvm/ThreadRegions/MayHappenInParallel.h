@@ -1,50 +1,110 @@
 #ifndef MAYHAPPENINPARALLEL_H
 #define MAYHAPPENINPARALLEL_H
 
-#include <map>
 #include <ostream>
-#include <set>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "ThreadRegion.h"
+#include "dg/ADT/Bitvector.h"
 
 class MayHappenInParallel {
-    using MHPPair = std::pair<const ThreadRegion *, const ThreadRegion *>;
-    using MHPRelationGraph = std::set<MHPPair>;
+    using RegionsSet = dg::ADT::SparseBitvector;
+    using MHPPair = std::pair<unsigned, unsigned>;
 
     const ThreadRegion *rootRegion_;
-    std::map<const ThreadRegion *, std::set<const ThreadRegion *>> mhpInfo_;
+    // the regions reachable from the root region, numbered densely
+    // in the order in which they were found
+    std::vector<const ThreadRegion *> regions_;
+    std::unordered_map<const ThreadRegion *, unsigned> regionIndex_;
+    // the i-th set holds the numbers of regions that may happen
+    // in parallel with the i-th region (the relation is symmetric)
+    std::vector<RegionsSet> mhpInfo_;
     size_t relationCount_ = 0;
 
-    static const std::set<const ThreadRegion *> emptyRegion_;
+    static const RegionsSet emptyRegion_;
 
   public:
+    // the regions that may happen in parallel with a region,
+    // it is valid as long as the analysis exists
+    class RegionsView {
+        const std::vector<const ThreadRegion *> *regions_;
+        const RegionsSet *set_;
+
+      public:
+        RegionsView(const std::vector<const ThreadRegion *> &regions,
+                    const RegionsSet &set)
+                : regions_(&regions), set_(&set) {}
+
+        class const_iterator {
+            const std::vector<const ThreadRegion *> *regions_;
+            RegionsSet::const_iterator it_;
+
+          public:
+            const_iterator(const std::vector<const ThreadRegion *> &regions,
+                           RegionsSet::const_iterator it)
+                    : regions_(&regions), it_(it) {}
+
+            const ThreadRegion *operator*() const { return (*regions_)[*it_]; }
+
+            const_iterator &operator++() {
+                ++it_;
+                return *this;
+            }
+
+            bool operator==(const const_iterator &rhs) const {
+                return it_ == rhs.it_;
+            }
+
+            bool operator!=(const const_iterator &rhs) const {
+                return !operator==(rhs);
+            }
+        };
+
+        const_iterator begin() const { return {*regions_, set_->begin()}; }
+        const_iterator end() const { return {*regions_, set_->end()}; }
+        bool empty() const { return set_->empty(); }
+        size_t size() const { return set_->size(); }
+    };
+
     MayHappenInParallel(const ThreadRegion *rootRegion);
 
     void run();
 
-    const std::set<const ThreadRegion *> &
-    parallelRegions(const ThreadRegion *threadRegion);
+    RegionsView parallelRegions(const ThreadRegion *threadRegion) const;
 
     void printEdges(std::ostream &ostream) const;
     size_t countRelations() const;
 
   private:
-    // we do this to save space, as the MHP relation is symetric
-    static MHPPair createMHPPair(const ThreadRegion *first,
-                                 const ThreadRegion *second) {
-        if (first < second) {
-            return {first, second};
-        }
-
-        return {second, first};
+    void numberRegions();
+
+    // the regions to which the MHP information of a region propagates
+    template <typename FunT>
+    static void forEachSuccessor(const ThreadRegion *region, FunT fn) {
+        for (const auto *succ : region->directSuccessors())
+            fn(succ);
+        for (const auto *succ : region->calledSuccessors())
+            fn(succ);
+        if (const auto *succ = region->interestingCallSuccessor())
+            fn(succ);
+        for (const auto *succ : region->forkedSuccessors())
+            fn(succ);
     }
 
+    // the regions from which the i-th region propagates
+    // (transitively) its MHP information, including the region itself
+    std::vector<RegionsSet> computeSuccessorsClosure() const;
+
+    // the pairs created by the forks that end the region
+    void addForkPairs(unsigned region, std::vector<MHPPair> &pairs) const;
+
     // warning: this is only used internally, the result may be an
     // underestimation of the real MHP relation
-    MHPRelationGraph findInitialMHP() const;
+    std::vector<MHPPair> findInitialMHP() const;
 
-    MHPRelationGraph runAnalysis() const;
+    void runAnalysis();
 };
 
 #endif // MAYHAPPENINPARALLEL_H
@@ -8,6 +8,7 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
 
+#include <atomic>
 #include <vector>
 
 #include "GraphElements.h"
@@ -41,6 +42,8 @@ class RelationsAnalyzer {
     // or possibly set of values defined at given location
     StructureAnalyzer &structure;
 
+    std::atomic<size_t> processedLocations{0};
+
     // ********************** points to invalidation ********************** //
     static bool isIgnorableIntrinsic(llvm::Intrinsic::ID id);
     bool isSafe(I inst) const;
@@ -170,14 +173,31 @@ class RelationsAnalyzer {
 
     // ************************* topmost ******************************* //
     void processOperation(VRLocation *source, VRLocation *target, VROp *op);
-    bool passFunction(const llvm::Function &function, bool print);
+    // pass the relations to the location from its predecessors,
+    // return true if the relations of the location changed
+    bool processLocation(VRLocation &location);
+    unsigned analyzeFunction(const llvm::Function &function, unsigned maxPass);
 
   public:
     RelationsAnalyzer(const llvm::Module &m, const VRCodeGraph &g,
                       StructureAnalyzer &sa)
             : module(m), codeGraph(g), structure(sa) {}
 
-    unsigned analyze(unsigned maxPass);
+    // Compute the relations in every location. The locations of a function
+    // are processed in passes until a fixpoint is reached, but at most
+    // maxPass passes are made. A pass processes only the successors
+    // of changed locations and the loop joins whose loops contain a changed
+    // location. Joins may change also other locations (e.g., the entry
+    // of the function), so the fixpoint is accepted only when a pass over
+    // all locations changes nothing. The passes are counted as if every
+    // pass processed all locations. Returns the maximal number of passes
+    // made over a function. The functions are analyzed independently
+    // of each other, with more workers they are analyzed in parallel
+    // (the results do not depend on the number of workers).
+    unsigned analyze(unsigned maxPass, unsigned workers = 1);
+
+    // the number of times (any) location was processed
+    size_t getProcessedLocationsNum() const { return processedLocations; }
 
     static std::vector<V> getFroms(const ValueRelations &rels, V val);
     static HandlePtr getHandleFromFroms(const ValueRelations &rels,
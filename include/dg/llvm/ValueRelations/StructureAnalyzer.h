@@ -8,6 +8,7 @@
 #include <llvm/IR/Value.h>
 
 #include <algorithm>
+#include <mutex>
 
 #include "GraphElements.h"
 #include "StructureElements.h"
@@ -42,6 +43,11 @@ class StructureAnalyzer {
     std::map<const llvm::Function *, std::vector<Precondition>>
             preconditionsMap;
     std::map<const llvm::Function *, std::vector<BorderValue>> borderValues;
+    // preconditions and border values are added during the relations
+    // analysis, which may analyze more functions at once; the vector
+    // for a function is used only by the thread analyzing that function,
+    // the lock guards only the maps
+    mutable std::mutex functionInfoMutex;
 
     void categorizeEdges();
 
@@ -5,6 +5,7 @@
 #include <llvm/IR/Value.h>
 
 #include <map>
+#include <memory>
 
 #ifndef NDEBUG
 #include "getValName.h"
@@ -35,19 +36,56 @@ struct ValueRelations {
     friend class RelationsGraph;
     friend class ValueIterator;
 
-    RelGraph graph;
+    // The relations are shared (copy-on-write) between ValueRelations
+    // that hold the same relations, e.g., locations that do not change
+    // the relations of their predecessor. A copy keeps the ids of buckets,
+    // so handles are searched by the ids and a handle that was taken
+    // before the relations were copied can still be used.
+    struct Data {
+        RelGraph graph;
+        ValToBucket valToBucket;
+        BucketToVals bucketToVals;
+
+        // incremented with every change of the relations
+        unsigned version = 0;
+        // the relations that these relations were copied from (and their
+        // version at that time) and whether the relations were only added
+        // since then
+        std::weak_ptr<Data> base;
+        unsigned baseVersion = 0;
+        bool extendsBase = false;
+
+        Data(ValueRelations &owner) : graph(owner) {}
+        Data(ValueRelations &owner, const Data &other);
+    };
 
-    ValToBucket valToBucket;
-    BucketToVals bucketToVals;
+    std::shared_ptr<Data> data;
+    // the shared relations that were copied for a modification,
+    // they are used again if the modification does not change anything
+    std::shared_ptr<Data> sharedData;
     std::vector<bool> validAreas;
 
     bool changed = false;
 
+    // get the relations for modification, copy them if they are shared
+    Data &mut();
+
+    RelGraph &graph() { return mut().graph; }
+    const RelGraph &graph() const { return data->graph; }
+    ValToBucket &valToBucket() { return mut().valToBucket; }
+    const ValToBucket &valToBucket() const { return data->valToBucket; }
+    BucketToVals &bucketToVals() { return mut().bucketToVals; }
+    const BucketToVals &bucketToVals() const { return data->bucketToVals; }
+
     // ****************************** get ********************************* //
-    static HandlePtr maybeGet(Handle h) { return &h; }
+    HandlePtr maybeGet(Handle h) const { return graph().getBucket(h.id); }
     HandlePtr maybeGet(V val) const;
 
-    static std::pair<BRef, bool> get(Handle h) { return {h, false}; }
+    std::pair<BRef, bool> get(Handle h) {
+        HandlePtr mH = maybeGet(h);
+        assert(mH && "the handle is not from these relations");
+        return {*mH, false};
+    }
     std::pair<BRef, bool> get(size_t id);
     std::pair<BRef, bool> get(V val);
 
@@ -64,15 +102,20 @@ struct ValueRelations {
     // ************************* general unset **************************** //
     void unset(Relations rels) {
         assert(!rels.has(Relations::EQ));
-        bool ch = graph.unset(rels);
+        bool ch = graph().unset(rels);
         updateChanged(ch);
+        if (ch)
+            data->extendsBase = false;
     }
     void unset(Relations::Type rel) { unset(Relations().set(rel)); }
     template <typename X>
     void unset(const X &val, Relations rels) {
+        mut();
         if (HandlePtr mH = maybeGet(val)) {
-            bool ch = graph.unset(*mH, rels);
+            bool ch = graph().unset(*mH, rels);
             updateChanged(ch);
+            if (ch)
+                data->extendsBase = false;
         }
     }
     template <typename X>
@@ -111,7 +154,7 @@ struct ValueRelations {
         bool isEnd = false;
 
         const VectorSet<V> &getCurrentEqual() const {
-            return vr.bucketToVals.find(bucketIt->first)->second;
+            return vr.bucketToVals().find(bucketIt->first)->second;
         }
 
         void updateCurrent() {
@@ -143,7 +186,7 @@ struct ValueRelations {
         // for begin iterator
         RelatedValueIterator(const ValueRelations &v, Handle start,
                              const Relations &allowedEdges)
-                : vr(v), related(vr.graph.getRelated(start, allowedEdges)),
+                : vr(v), related(vr.graph().getRelated(start, allowedEdges)),
                   bucketIt(related.begin()),
                   valueIt(getCurrentEqual().begin()) {
             assert(allowedEdges.has(Relations::EQ) &&
@@ -243,10 +286,15 @@ struct ValueRelations {
     void add(V val, Handle h, VectorSet<V> &vals);
     std::pair<BRef, bool> add(V val, Handle h);
     void areMerged(Handle to, Handle from);
-    void updateChanged(bool ch) { changed |= ch; }
+    void updateChanged(bool ch) {
+        if (ch) {
+            changed = true;
+            ++data->version;
+        }
+    }
 
   public:
-    ValueRelations() : graph(*this) {}
+    ValueRelations() : data(std::make_shared<Data>(*this)) {}
     ValueRelations(const ValueRelations &) = delete;
 
     using rel_iterator = RelatedValueIterator;
@@ -275,13 +323,14 @@ struct ValueRelations {
     // ****************************** set ********************************* //
     template <typename X, typename Y>
     void set(const X &lt, Relations::Type rel, const Y &rt) {
+        mut();
         auto ltHPair = get(lt);
         auto rtHPair = get(rt);
         if (rtHPair.second) {
             ltHPair = get(lt);
             assert(!ltHPair.second);
         }
-        bool ch = graph.addRelation(ltHPair.first, rel, rtHPair.first);
+        bool ch = graph().addRelation(ltHPair.first, rel, rtHPair.first);
         updateChanged(ch);
     }
     template <typename X, typename Y>
@@ -368,7 +417,7 @@ struct ValueRelations {
     bool has(const X &val, Relations rels) const {
         HandlePtr mVal = maybeGet(val);
         return mVal && ((rels.has(Relations::EQ) &&
-                         bucketToVals.find(*mVal)->second.size() > 1) ||
+                         bucketToVals().find(*mVal)->second.size() > 1) ||
                         mVal->hasAnyRelation(rels.set(Relations::EQ, false)));
     }
     template <typename X>
@@ -381,7 +430,7 @@ struct ValueRelations {
         HandlePtr mLt = maybeGet(lt);
         HandlePtr mRt = maybeGet(rt);
 
-        return mLt && mRt && graph.haveConflictingRelation(*mLt, rel, *mRt);
+        return mLt && mRt && graph().haveConflictingRelation(*mLt, rel, *mRt);
     }
     template <typename X, typename Y>
     bool hasConflictingRelation(const X &lt, const Y &rt,
@@ -420,8 +469,8 @@ struct ValueRelations {
     begin_buckets(const Relations &rels = allRelations) const;
     RelGraph::iterator end_buckets() const;
 
-    const ValToBucket &getValToBucket() const { return valToBucket; }
-    const BucketToVals &getBucketToVals() const { return bucketToVals; }
+    const ValToBucket &getValToBucket() const { return valToBucket(); }
+    const BucketToVals &getBucketToVals() const { return bucketToVals(); }
 
     // ****************************** get ********************************* //
     const VectorSet<V> &getEqual(Handle h) const;
@@ -437,7 +486,7 @@ struct ValueRelations {
         HandlePtr mH = maybeGet(val);
         if (!mH)
             return {};
-        return graph.getRelated(*mH, rels);
+        return graph().getRelated(*mH, rels);
     }
 
     std::vector<V> getDirectlyRelated(V val, const Relations &rels) const;
@@ -473,20 +522,22 @@ struct ValueRelations {
 
     // ************************** placeholder ***************************** //
     Handle newBorderBucket(size_t id) {
-        Handle h = graph.getBorderBucket(id);
-        bucketToVals[h];
+        mut();
+        Handle h = graph().getBorderBucket(id);
+        bucketToVals()[h];
         return h;
     }
 
     template <typename X>
     Handle newPlaceholderBucket(const X &from) {
+        mut();
         HandlePtr mH = maybeGet(from);
         if (mH && mH->hasRelation(Relations::PT)) {
             return mH->getRelated(Relations::PT);
         }
 
-        Handle h = graph.getNewBucket();
-        bucketToVals[h];
+        Handle h = graph().getNewBucket();
+        bucketToVals()[h];
         return h;
     }
     void erasePlaceholderBucket(Handle h);
@@ -496,9 +547,17 @@ struct ValueRelations {
     static bool compare(C lt, Relations rels, C rt);
     static Relations compare(C lt, C rt);
     bool merge(const ValueRelations &other, Relations relations = allRelations);
+    // Also ends a modification of the relations: if the relations were
+    // copied from shared relations and they did not change, they are shared
+    // again (and handles taken since the copy must not be used anymore).
     bool unsetChanged() {
         bool old = changed;
         changed = false;
+        if (sharedData) {
+            if (!old)
+                data = std::move(sharedData);
+            sharedData.reset();
+        }
         return old;
     }
     bool holdsAnyRelations() const;
@@ -5,40 +5,30 @@
 #include <memory>
 
 ///
-// Shared pointer with copy-on-write support
+// Shared pointer with copy-on-write support. The pointed object
+// may be shared by several pointers and it is copied on the first
+// write through a pointer that does not hold it exclusively.
 template <typename T>
 class cow_shared_ptr : public std::shared_ptr<T> {
-    // am I the owner of the copy?
-    bool owner{true};
-
   public:
     cow_shared_ptr() = default;
     cow_shared_ptr(T *p) : std::shared_ptr<T>(p) {}
-    cow_shared_ptr(cow_shared_ptr &&) = delete;
-    cow_shared_ptr(const cow_shared_ptr &rhs)
-            : std::shared_ptr<T>(rhs), owner(false) {}
-
-    void reset(T *p) {
-        owner = true;
-        std::shared_ptr<T>::reset(p);
-    }
 
     const T *get() const { return std::shared_ptr<T>::get(); }
     const T *operator->() const { return get(); }
     const T *operator*() const { return get(); }
 
-    T *getWritable() {
-        if (owner)
-            return std::shared_ptr<T>::get();
+    // is the object shared with some other pointer?
+    bool isShared() const { return std::shared_ptr<T>::use_count() > 1; }
 
-        // create a copy of the object and claim the ownership
-        assert(!owner);
-        if (get() != nullptr) {
-            reset(new T(*get()));
-        } else {
-            reset(new T());
+    T *getWritable() {
+        if (get() == nullptr) {
+            std::shared_ptr<T>::reset(new T());
+        } else if (isShared()) {
+            // create a copy of the object and claim the ownership
+            std::shared_ptr<T>::reset(new T(*get()));
         }
-        assert(owner); // set in reset() method
+        assert(!isShared());
         return std::shared_ptr<T>::get();
     }
 };
@@ -0,0 +1,49 @@
+#ifndef DG_UTIL_PARALLEL_H_
+#define DG_UTIL_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace dg {
+
+///
+// Call fn(i) for every i in 0 ... n - 1 using at most 'workers' threads
+// (the calling thread is one of them). The threads take the indices
+// in chunks of 'chunk' consecutive indices. With one worker (or few
+// indices) the function is called sequentially in the order of indices.
+template <typename FunT>
+void parallelFor(size_t workers, size_t n, FunT fn, size_t chunk = 8) {
+    workers = std::min(workers, (n + chunk - 1) / chunk);
+    if (workers <= 1) {
+        for (size_t i = 0; i < n; ++i)
+            fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        while (true) {
+            size_t b = next.fetch_add(chunk);
+            if (b >= n)
+                break;
+            size_t e = std::min(b + chunk, n);
+            for (size_t i = b; i < e; ++i)
+                fn(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t i = 1; i < workers; ++i)
+        threads.emplace_back(work);
+    work();
+    for (auto &t : threads)
+        t.join();
+}
+
+} // namespace dg
+
+#endif // DG_UTIL_PARALLEL_H_
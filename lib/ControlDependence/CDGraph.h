@@ -3,10 +3,11 @@
 
 #include <cassert>
 #include <memory>
-#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "dg/ADT/Bitvector.h"
 #include "dg/BBlockBase.h"
 
 namespace dg {
@@ -38,13 +39,11 @@ class CDNode : public ElemWithEdges<CDNode> {
 /////
 class CDGraph {
     using NodesVecT = std::vector<std::unique_ptr<CDNode>>;
-    // using NodesPtrVecT = ADT::SparseBitvector;
-    // FIXME ^^
-    using PredicatesT = std::set<CDNode *>;
+    // the IDs of nodes that have more than one successor
+    using PredicatesT = ADT::SparseBitvector;
 
     std::string _name;
     NodesVecT _nodes;
-    // NodesPtrVecT _predicates;
     PredicatesT _predicates;
 
     // iterator over the subgraphs that unwraps the unique_ptr
@@ -73,38 +72,43 @@ class CDGraph {
         node_iterator end() { return node_iterator(nodes.end()); }
     };
 
-    // iterator over the predicates
-    /*
-    struct predicate_iterator : public NodesPtrVecT::const_iterator {
-        NodesVecT& _nodes;
+    // iterator over the predicates (in the order of their IDs)
+    struct predicate_iterator : public PredicatesT::const_iterator {
+        const NodesVecT *_nodes;
 
-        predicate_iterator(NodesVecT& nodes, const typename
-    NodesPtrVecT::const_iterator& it) : NodesPtrVecT::const_iterator(it),
-    _nodes(nodes) {} predicate_iterator(const predicate_iterator&) = default;
+        predicate_iterator(const NodesVecT &nodes,
+                           const typename PredicatesT::const_iterator &it)
+                : PredicatesT::const_iterator(it), _nodes(&nodes) {}
+        predicate_iterator(const predicate_iterator &) = default;
 
-        CDNode *operator*() {
-            auto id = NodesPtrVecT::const_iterator::operator*();
-            assert(id - 1 < _nodes.size());
-            return this->_nodes[id - 1].get();
-        };
-        CDNode *operator->() {
-            auto id = NodesPtrVecT::const_iterator::operator*();
-            assert(id - 1 < _nodes.size());
-            return this->_nodes[id - 1].get();
-        };
+        CDNode *operator*() const {
+            auto id = PredicatesT::const_iterator::operator*();
+            assert(id - 1 < _nodes->size());
+            return (*_nodes)[id - 1].get();
+        }
+        CDNode *operator->() const { return operator*(); }
+
+        predicate_iterator &operator++() {
+            PredicatesT::const_iterator::operator++();
+            return *this;
+        }
     };
 
     struct predicates_range {
-        NodesVecT& nodes;
-        NodesPtrVecT& predicates;
-        predicates_range(NodesVecT& n, NodesPtrVecT& b) : nodes(n),
-    predicates(b) {}
-
-        predicate_iterator begin() { return predicate_iterator(nodes,
-    predicates.begin()); } predicate_iterator end() { return
-    predicate_iterator(nodes, predicates.end()); }
+        const NodesVecT &nodes;
+        const PredicatesT &predicates;
+        predicates_range(const NodesVecT &n, const PredicatesT &b)
+                : nodes(n), predicates(b) {}
+
+        predicate_iterator begin() const {
+            return predicate_iterator(nodes, predicates.begin());
+        }
+        predicate_iterator end() const {
+            return predicate_iterator(nodes, predicates.end());
+        }
+        size_t size() const { return predicates.size(); }
+        bool empty() const { return predicates.empty(); }
     };
-    */
 
   public:
     CDGraph(std::string name = "") : _name(std::move(name)) {}
@@ -126,7 +130,7 @@ class CDGraph {
     void addNodeSuccessor(CDNode &nd, CDNode &succ) {
         nd.addSuccessor(&succ);
         if (nd.successors().size() > 1) {
-            _predicates.insert(&nd);
+            _predicates.set(nd.getID());
         }
     }
 
@@ -147,39 +151,31 @@ class CDGraph {
     size_t size() const { return _nodes.size(); }
     bool empty() const { return _nodes.empty(); }
 
-    /*
-    predicate_iterator predicates_begin() { return predicate_iterator(_nodes,
-    _predicates.begin()); } predicate_iterator predicates_end() { return
-    predicate_iterator(_nodes, _predicates.end()); } predicates_range
-    predicates() { return predicates_range(_nodes, _predicates); }
-    */
-
-    decltype(_predicates.begin()) predicates_begin() {
-        return _predicates.begin();
+    predicate_iterator predicates_begin() const {
+        return predicate_iterator(_nodes, _predicates.begin());
     }
-    decltype(_predicates.end()) predicates_end() { return _predicates.end(); }
-    decltype(_predicates.begin()) predicates_begin() const {
-        return _predicates.begin();
+    predicate_iterator predicates_end() const {
+        return predicate_iterator(_nodes, _predicates.end());
     }
-    decltype(_predicates.end()) predicates_end() const {
-        return _predicates.end();
+    predicates_range predicates() const {
+        return predicates_range(_nodes, _predicates);
     }
-    PredicatesT &predicates() { return _predicates; }
-    const PredicatesT &predicates() const { return _predicates; }
-
-    /*
-    bool isPredicate(const CDNode& nd) const {
-        return _predicates.get(nd.getID());
-    }
-    */
 
     bool isPredicate(const CDNode &nd) const {
-        return _predicates.count(const_cast<CDNode *>(&nd)) > 0;
+        return _predicates.get(nd.getID());
     }
 
     const std::string &getName() const { return _name; }
 };
 
+///
+// Control dependencies stored as rows of bits indexed by the IDs of nodes
+// (nodes of CDGraph are numbered densely from 1, so the row 0 is unused).
+// The i-th row of the forward relation holds the IDs of the predicates
+// on which the node with ID i depends, the i-th row of the reverse
+// relation holds the IDs of the nodes that depend on the predicate with ID i.
+using CDRowsT = std::vector<ADT::SparseBitvector>;
+
 } // namespace dg
 
 #endif
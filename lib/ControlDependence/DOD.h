@@ -5,6 +5,7 @@
 #include <map>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 #include <dg/ADT/Bitvector.h>
 #include <dg/ADT/Queue.h>
@@ -27,27 +28,28 @@ class AllMaxPath {
         unsigned short counter;
     };
 
-    std::unordered_map<CDNode *, Info> data;
+    // indexed by the IDs of nodes
+    std::vector<Info> data;
 
     void compute(CDGraph &graph, CDNode *target) {
         // initialize nodes
         for (auto *nd : graph) {
-            data[nd].counter = nd->successors().size();
+            data[nd->getID()].counter = nd->successors().size();
         }
 
         // initialize the search
-        data[target].colors.set(target->getID());
+        data[target->getID()].colors.set(target->getID());
         ADT::QueueLIFO<CDNode *> queue;
         queue.push(target);
 
         // search!
         while (!queue.empty()) {
             auto *node = queue.pop();
-            assert(data[node].colors.get(target->getID()) &&
+            assert(data[node->getID()].colors.get(target->getID()) &&
                    "A non-colored node in queue");
 
             for (auto *pred : node->predecessors()) {
-                auto &D = data[pred];
+                auto &D = data[pred->getID()];
                 --D.counter;
                 if (D.counter == 0) {
                     D.colors.set(target->getID());
@@ -63,11 +65,13 @@ class AllMaxPath {
     ResultT compute(CDGraph &graph) {
         ResultT res;
 
-        data.reserve(graph.size());
+        // the result refers to the rows, so do not resize the vector later
+        data.clear();
+        data.resize(graph.size() + 1);
 
         for (auto *nd : graph) {
             compute(graph, nd);
-            res.emplace(nd, data[nd].colors);
+            res.emplace(nd, data[nd->getID()].colors);
         }
 
         return res;
@@ -83,7 +87,7 @@ class DOD {
     // the ternary relation. However, the effect on the results of slicing
     // is usually small. There is a flag that computes the relation
     // as ternary.
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRowsT;
     using ColoringT = ADT::SparseBitvector;
 
   private:
@@ -386,10 +390,10 @@ class DOD {
                 //                                     << gncur->getID() <<
                 //                                     "}");
 
-                CD[gcur].insert(p);
-                CD[gncur].insert(p);
-                revCD[p].insert(gcur);
-                revCD[p].insert(gncur);
+                CD[gcur->getID()].set(p->getID());
+                CD[gncur->getID()].set(p->getID());
+                revCD[p->getID()].set(gcur->getID());
+                revCD[p->getID()].set(gncur->getID());
 
                 ncur = ncur->getSingleSuccessor();
             } while (!(CAp.isBlue(ncur) || CAp.isRed(ncur)));
@@ -409,8 +413,8 @@ class DOD {
         do {
             auto *gcur = CAp.getGNode(cur);
             assert(gcur);
-            CD[gcur].insert(p);
-            revCD[p].insert(gcur);
+            CD[gcur->getID()].set(p->getID());
+            revCD[p->getID()].set(gcur->getID());
             // DBG(cda, p->getID() << " - dod -> " << gcur->getID());
             cur = cur->getSingleSuccessor();
         } while (!(CAp.isBlue(cur) || CAp.isRed(cur)));
@@ -421,8 +425,8 @@ class DOD {
         do {
             auto *gcur = CAp.getGNode(cur);
             assert(gcur);
-            CD[gcur].insert(p);
-            revCD[p].insert(gcur);
+            CD[gcur->getID()].set(p->getID());
+            revCD[p->getID()].set(gcur->getID());
             // DBG(cda, p->getID() << " - dod -> " << gcur->getID());
             cur = cur->getSingleSuccessor();
         } while (!(CAp.isBlue(cur) || CAp.isRed(cur)));
@@ -455,8 +459,8 @@ class DOD {
 
   public:
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph.size() + 1);
+        ResultT revCD(graph.size() + 1);
 
         DBG_SECTION_BEGIN(cda, "Computing DOD for all predicates");
 
@@ -475,7 +479,7 @@ class DOD {
         }
 
         DBG_SECTION_END(cda, "Finished computing DOD for all predicates");
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
@@ -485,7 +489,7 @@ class DODRanganath {
     // NOTE: although DOD is a ternary relation, we treat it as binary
     // by breaking a->(b, c) to (a, b) and (a, c). It is less precise,
     // but our API is not prepared for the ternary relation.
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRowsT;
     enum class Color { WHITE, BLACK, UNCOLORED };
 
     struct Info {
@@ -605,8 +609,8 @@ class DODRanganath {
 
   public:
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph.size() + 1);
+        ResultT revCD(graph.size() + 1);
 
         DBG(cda, "Computing DOD (Ranganath)");
 
@@ -624,16 +628,16 @@ class DODRanganath {
                         // DBG(cda, "DOD: " << n->getID() << " -> {"
                         //                 << p->getID() << ", " << m->getID()
                         //                 << "}");
-                        CD[m].insert(n);
-                        CD[p].insert(n);
-                        revCD[n].insert(m);
-                        revCD[n].insert(n);
+                        CD[m->getID()].set(n->getID());
+                        CD[p->getID()].set(n->getID());
+                        revCD[n->getID()].set(m->getID());
+                        revCD[n->getID()].set(n->getID());
                     }
                 }
             }
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
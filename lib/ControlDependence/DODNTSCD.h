@@ -35,16 +35,16 @@ class DODNTSCD : public DOD {
         // FIXME: we could do that faster
         for (auto *n : graph) {
             if (nodes1.get(n->getID()) ^ nodes2.get(n->getID())) {
-                CD[n].insert(p);
-                revCD[p].insert(n);
+                CD[n->getID()].set(p->getID());
+                revCD[p->getID()].set(n->getID());
             }
         }
     }
 
   public:
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph.size() + 1);
+        ResultT revCD(graph.size() + 1);
 
         DBG_SECTION_BEGIN(cda, "Computing DOD for all predicates");
 
@@ -64,7 +64,7 @@ class DODNTSCD : public DOD {
         }
 
         DBG_SECTION_END(cda, "Finished computing DOD for all predicates");
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
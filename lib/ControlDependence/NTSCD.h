@@ -1,140 +1,205 @@
 #ifndef DG_NTSCD_H
 #define DG_NTSCD_H
 
-#include <map>
+#include <cstdint>
 #include <set>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "CDGraph.h"
+#include "dg/ADT/Bitvector.h"
 #include "dg/ADT/Queue.h"
 #include "dg/ADT/SetQueue.h"
 
 namespace dg {
 
 class NTSCD {
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
-
-    struct Info {
-        unsigned color{0};
+    using ResultT = CDRowsT;
+
+    // the state of nodes in the search for one target,
+    // the nodes with an old stamp were not visited yet
+    struct TargetInfo {
+        unsigned stamp{0};
+        unsigned counter{0};
+        bool colored{false};
     };
 
-    std::unordered_map<CDNode *, Info> data;
+    std::vector<TargetInfo> targetData;
+    unsigned lastStamp{0};
+
+    // the colors of nodes for one batch of targets, indexed by the IDs
+    // of nodes: the i-th bit is set if the node is colored by the i-th
+    // target of the batch
+    std::vector<uint64_t> colors;
+
+    static const unsigned BATCH_SIZE = 64;
+
+    // Color the nodes for the targets with IDs first, ..., first + 63
+    // at once. A node is colored by a target if it is the target or if all
+    // its successors are colored by the target, so the words are the least
+    // solution of
+    //   colors[n] = bit(n) | (AND of colors[s] for successors s of n)
+    // and every change of a word is propagated to the predecessors.
+    // Unlike a row of targets for every node, this takes memory linear
+    // in the size of the graph.
+    void computeColors(CDGraph &graph, unsigned first) {
+        colors.assign(graph.size() + 1, 0);
+
+        std::vector<CDNode *> frontier;
+        std::vector<bool> queued(graph.size() + 1);
+        auto enqueuePredecessors = [&](CDNode *nd) {
+            for (auto *pred : nd->predecessors()) {
+                if (!queued[pred->getID()]) {
+                    queued[pred->getID()] = true;
+                    frontier.push_back(pred);
+                }
+            }
+        };
 
-    void compute(CDGraph &graph, CDNode *target, ResultT &CD, ResultT &revCD) {
-        std::set<CDNode *> frontier;
-        std::set<CDNode *> new_frontier;
+        for (unsigned i = 0; i < BATCH_SIZE && first + i <= graph.size();
+             ++i) {
+            auto *target = graph.getNode(first + i);
+            colors[target->getID()] = uint64_t{1} << i;
+            enqueuePredecessors(target);
+        }
 
-        // color the target node
-        data[target].color = target->getID();
-        for (auto *pred : target->predecessors()) {
-            if (data[pred].color != target->getID()) {
-                frontier.insert(pred);
+        while (!frontier.empty()) {
+            auto *nd = frontier.back();
+            frontier.pop_back();
+            queued[nd->getID()] = false;
+
+            uint64_t common = ~uint64_t{0};
+            for (auto *succ : nd->successors()) {
+                common &= colors[succ->getID()];
             }
-        }
 
-        bool progress;
-        do {
-            progress = false;
-            new_frontier.clear();
-
-            for (auto *nd : frontier) {
-                assert(!nd->successors().empty());
-                // do all successors have the right color?
-                bool colorit = true;
-                for (auto *succ : nd->successors()) {
-                    if (data[succ].color != target->getID()) {
-                        colorit = false;
-                        break;
-                    }
-                }
+            // the words only grow, so the union gives the new word
+            auto &word = colors[nd->getID()];
+            if ((word | common) != word) {
+                word |= common;
+                enqueuePredecessors(nd);
+            }
+        }
+    }
 
-                // color the node and enqueue its predecessors
-                if (colorit) {
-                    data[nd].color = target->getID();
-                    for (auto *pred : nd->predecessors()) {
-                        if (data[pred].color != target->getID()) {
-                            new_frontier.insert(pred);
-                        }
-                    }
-                    progress = true;
+  public:
+    // Returns the IDs of the predicates on which the target depends.
+    // Only the nodes from which the target is reached are visited,
+    // so this is cheaper than compute(graph) when we need
+    // the dependencies of only a few nodes.
+    ADT::SparseBitvector compute(CDGraph &graph, CDNode *target) {
+        if (targetData.size() <= graph.size())
+            targetData.resize(graph.size() + 1);
+        ++lastStamp;
+
+        auto visit = [&](CDNode *nd) -> TargetInfo & {
+            auto &D = targetData[nd->getID()];
+            if (D.stamp != lastStamp) {
+                D.stamp = lastStamp;
+                D.counter = nd->successors().size();
+                D.colored = false;
+            }
+            return D;
+        };
+
+        // color the target and then every node whose successors
+        // are all colored, remember the uncolored nodes that have
+        // a colored successor
+        std::vector<CDNode *> queue{target};
+        std::vector<CDNode *> frontier;
+        visit(target).colored = true;
+        while (!queue.empty()) {
+            auto *nd = queue.back();
+            queue.pop_back();
+
+            for (auto *pred : nd->predecessors()) {
+                auto &D = visit(pred);
+                if (D.colored)
+                    continue;
+                if (--D.counter == 0) {
+                    D.colored = true;
+                    queue.push_back(pred);
                 } else {
-                    // re-queue the node as nothing happend
-                    new_frontier.insert(nd);
+                    frontier.push_back(pred);
                 }
             }
+        }
 
-            new_frontier.swap(frontier);
-        } while (progress);
-
-        // iterate over frontier set, not over predicates -- only
-        // the predicates that are in the frontier set may have colored
+        // the uncolored predicates in the frontier have both colored
         // and uncolored successors
-        for (auto *predicate : frontier) {
-            if (!graph.isPredicate(*predicate))
-                continue;
-            bool has_colored = false;
-            bool has_uncolored = false;
-            for (auto *succ : predicate->successors()) {
-                if (data[succ].color == target->getID())
-                    has_colored = true;
-                if (data[succ].color != target->getID())
-                    has_uncolored = true;
-            }
-
-            if (has_colored && has_uncolored) {
-                CD[target].insert(predicate);
-                revCD[predicate].insert(target);
-            }
+        ADT::SparseBitvector deps;
+        for (auto *nd : frontier) {
+            if (!targetData[nd->getID()].colored && graph.isPredicate(*nd))
+                deps.set(nd->getID());
         }
+
+        return deps;
     }
 
-  public:
     // returns control dependencies and reverse control dependencies
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph.size() + 1);
+        ResultT revCD(graph.size() + 1);
 
-        data.reserve(graph.size());
+        // a predicate depends on the targets that color some of its
+        // successors, but do not color the predicate itself (then not all
+        // successors are colored, so it has also an uncolored successor)
+        for (unsigned first = 1; first <= graph.size(); first += BATCH_SIZE) {
+            computeColors(graph, first);
 
-        for (auto *nd : graph) {
-            compute(graph, nd, CD, revCD);
+            for (auto *predicate : graph.predicates()) {
+                uint64_t targets = 0;
+                for (auto *succ : predicate->successors()) {
+                    targets |= colors[succ->getID()];
+                }
+                targets &= ~colors[predicate->getID()];
+
+                for (unsigned i = 0; targets != 0; ++i, targets >>= 1) {
+                    if (targets & 1) {
+                        CD[first + i].set(predicate->getID());
+                        revCD[predicate->getID()].set(first + i);
+                    }
+                }
+            }
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
 class NTSCD2 {
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRowsT;
 
     struct Info {
         unsigned colored{false};
         unsigned short counter;
     };
 
-    std::unordered_map<CDNode *, Info> data;
+    // indexed by the IDs of nodes
+    std::vector<Info> data;
 
     void compute(CDGraph &graph, CDNode *target) {
         // initialize nodes
         for (auto *nd : graph) {
-            auto &D = data[nd];
+            auto &D = data[nd->getID()];
             D.colored = false;
             D.counter = nd->successors().size();
         }
 
         // initialize the search
-        data[target].colored = true;
+        data[target->getID()].colored = true;
         ADT::QueueLIFO<CDNode *> queue;
         queue.push(target);
 
         // search!
         while (!queue.empty()) {
             auto *node = queue.pop();
-            assert(data[node].colored && "A non-colored node in queue");
+            assert(data[node->getID()].colored &&
+                   "A non-colored node in queue");
 
             for (auto *pred : node->predecessors()) {
-                auto &D = data[pred];
+                auto &D = data[pred->getID()];
                 --D.counter;
                 if (D.counter == 0) {
                     D.colored = true;
@@ -147,10 +212,10 @@ class NTSCD2 {
   public:
     // returns control dependencies and reverse control dependencies
     std::pair<ResultT, ResultT> compute(CDGraph &graph) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph.size() + 1);
+        ResultT revCD(graph.size() + 1);
 
-        data.reserve(graph.size());
+        data.resize(graph.size() + 1);
 
         for (auto *nd : graph) {
             compute(graph, nd);
@@ -159,20 +224,20 @@ class NTSCD2 {
                 bool has_colored = false;
                 bool has_uncolored = false;
                 for (auto *succ : predicate->successors()) {
-                    if (data[succ].colored)
+                    if (data[succ->getID()].colored)
                         has_colored = true;
-                    if (!data[succ].colored)
+                    if (!data[succ->getID()].colored)
                         has_uncolored = true;
                 }
 
                 if (has_colored && has_uncolored) {
-                    CD[nd].insert(predicate);
-                    revCD[predicate].insert(nd);
+                    CD[nd->getID()].set(predicate->getID());
+                    revCD[predicate->getID()].set(nd->getID());
                 }
             }
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
@@ -181,7 +246,7 @@ class NTSCD2 {
 /// can compute incorrect results (it behaves differently when
 /// LIFO or FIFO or some other type of queue is used).
 class NTSCDRanganath {
-    using ResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using ResultT = CDRowsT;
 
     // symbol t_{mn}
     struct Symbol : public std::pair<CDNode *, CDNode *> {
@@ -248,8 +313,8 @@ class NTSCDRanganath {
     // the workbag and so on.
     std::pair<ResultT, ResultT> compute(CDGraph &graph,
                                         bool doFixpoint = true) {
-        ResultT CD;
-        ResultT revCD;
+        ResultT CD(graph.size() + 1);
+        ResultT revCD(graph.size() + 1);
 
         S.reserve(2 * graph.predicates().size());
 
@@ -295,13 +360,13 @@ class NTSCDRanganath {
                 //    symb.second->getID() << ")");
                 //}
                 if (!Snp.empty() && Snp.size() < p->successors().size()) {
-                    CD[n].insert(p);
-                    revCD[p].insert(n);
+                    CD[n->getID()].set(p->getID());
+                    revCD[p->getID()].set(n->getID());
                 }
             }
         }
 
-        return {CD, revCD};
+        return {std::move(CD), std::move(revCD)};
     }
 };
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <set>
 #include <vector>
 
@@ -6,6 +7,7 @@
 //#include "dg/BBlocksBuilder.h"
 
 #include "dg/util/debug.h"
+#include "dg/util/parallel.h"
 
 namespace dg {
 namespace dda {
@@ -39,24 +41,33 @@ std::vector<RWNode *> MemorySSATransformation::findDefinitions(RWNode *node) {
     // to the node (we must do that always, because adding PHI
     // nodes changes the definitions)
     auto D = findDefinitionsInBlock(node);
-    std::vector<RWNode *> defs;
+    auto defs = findDefinitions(node, D);
+
+    DBG_SECTION_END(dda,
+                    "Done searching definitions for node " << node->getID());
+    return defs;
+}
+
+std::vector<RWNode *> MemorySSATransformation::findDefinitions(RWNode *node,
+                                                               Definitions &D) {
+    auto *block = node->getBBlock();
+    assert(block && "Need bblock");
 
+    std::vector<RWNode *> defs;
     for (const auto &ds : node->getUses()) {
         assert(ds.target && "Target is null");
 
         // add the definitions from the beginning of this block to the defs
         // container
-        auto defSet = D.get(ds);
-        assert((!defSet.empty() || D.unknownWrites.empty()) &&
+        auto found = D.gather(ds, defs);
+        (void) found;
+        assert((found > 0 || D.unknownWrites.empty()) &&
                "BUG: if we found no definitions, also unknown writes must be "
                "empty");
-        defs.insert(defs.end(), defSet.begin(), defSet.end());
 
         addUncoveredFromPredecessors(block, D, ds, defs);
     }
 
-    DBG_SECTION_END(dda,
-                    "Done searching definitions for node " << node->getID());
     return defs;
 }
 
@@ -80,11 +91,11 @@ MemorySSATransformation::findDefinitions(RWNode *node, const DefSite &ds) {
 
     // add the definitions from the beginning of this block to the defs
     // container
-    auto defSet = D.get(ds);
-    assert((!defSet.empty() || D.unknownWrites.empty()) &&
+    auto found = D.gather(ds, defs);
+    (void) found;
+    assert((found > 0 || D.unknownWrites.empty()) &&
            "BUG: if we found no definitions, also unknown writes must be "
            "empty");
-    defs.insert(defs.end(), defSet.begin(), defSet.end());
 
     addUncoveredFromPredecessors(block, D, ds, defs);
 
@@ -241,11 +252,12 @@ MemorySSATransformation::findDefinitions(RWBBlock *block, const DefSite &ds) {
 
     // Find known definitions.
     auto &D = getBBlockDefinitions(block, &ds);
-    auto defSet = D.get(ds);
-    assert((!defSet.empty() || D.unknownWrites.empty()) &&
+    std::vector<RWNode *> defs;
+    auto found = D.gather(ds, defs);
+    (void) found;
+    assert((found > 0 || D.unknownWrites.empty()) &&
            "BUG: if we found no definitions, also unknown writes must be "
            "empty");
-    std::vector<RWNode *> defs(defSet.begin(), defSet.end());
 
     addUncoveredFromPredecessors(block, D, ds, defs);
 
@@ -253,7 +265,7 @@ MemorySSATransformation::findDefinitions(RWBBlock *block, const DefSite &ds) {
 }
 
 bool MemorySSATransformation::callMayDefineTarget(RWNodeCall *C,
-                                                  RWNode *target) {
+                                                  RWNode *target) const {
     // check if this call may define the memory at all
     for (auto &callee : C->getCallees()) {
         auto *subg = callee.getSubgraph();
@@ -263,10 +275,9 @@ bool MemorySSATransformation::callMayDefineTarget(RWNodeCall *C,
                 return true;
             }
         } else {
-            auto &si = getSubgraphInfo(subg);
-            computeModRef(subg, si);
-            assert(si.modref.isInitialized());
-            if (si.modref.mayDefineOrUnknown(target)) {
+            const auto *si = getSubgraphInfo(subg);
+            assert(si && si->modref.isInitialized());
+            if (si->modref.mayDefineOrUnknown(target)) {
                 return true;
             }
         }
@@ -283,7 +294,6 @@ void MemorySSATransformation::findDefinitionsInSubgraph(RWNode *phi,
                       "Searching definitions in subgraph " << subg->getName());
     auto &summary = getSubgraphSummary(subg);
     auto &si = getSubgraphInfo(subg);
-    computeModRef(subg, si);
     assert(si.modref.isInitialized());
 
     // Add the definitions that we have found in previous exploration
@@ -343,11 +353,11 @@ void MemorySSATransformation::addDefinitionsFromCalledValue(
     // FIXME: cache this somehow ?
     D.update(calledValue);
 
-    auto defSet = D.get(ds);
-    assert((!defSet.empty() || D.unknownWrites.empty()) &&
+    auto found = D.gather(ds, defs);
+    (void) found;
+    assert((found > 0 || D.unknownWrites.empty()) &&
            "BUG: if we found no definitions, also unknown writes must be "
            "empty");
-    defs.insert(defs.end(), defSet.begin(), defSet.end());
     addUncoveredFromPredecessors(C->getBBlock(), D, ds, defs);
     phi->addDefUse(defs);
 }
@@ -565,7 +575,6 @@ void MemorySSATransformation::fillDefinitionsFromCall(Definitions &D,
             }
         } else {
             auto &si = getSubgraphInfo(subg);
-            computeModRef(subg, si);
             assert(si.modref.isInitialized());
 
             for (const auto &it : si.modref.maydef) {
@@ -729,25 +738,89 @@ MemorySSATransformation::findAllDefinitions(RWNode *from) {
     DBG_SECTION_END(dda, "MemorySSA - finding all definitions for node "
                                  << from->getID() << " done");
 
-    auto values = defs.definitions.values();
-    values.insert(defs.unknownWrites.begin(), defs.unknownWrites.end());
-    return std::vector<RWNode *>(values.begin(), values.end());
+    std::vector<RWNode *> values(defs.unknownWrites.begin(),
+                                 defs.unknownWrites.end());
+    defs.definitions.forEachValue(
+            [&values](RWNode *n) { values.push_back(n); });
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+void MemorySSATransformation::performLvnOfAllBlocks() {
+    std::vector<std::pair<RWSubgraph *, SubgraphInfo *>> subgraphs;
+    subgraphs.reserve(graph.size());
+    for (auto *subg : graph.subgraphs()) {
+        subgraphs.emplace_back(subg, &getSubgraphInfo(subg));
+    }
+
+    // every subgraph is processed by one thread, so the threads
+    // do not share the infos about blocks
+    parallelFor(options.workers, subgraphs.size(), [&subgraphs](size_t i) {
+        auto *subg = subgraphs[i].first;
+        auto &si = *subgraphs[i].second;
+        for (auto *b : subg->bblocks()) {
+            auto &bi = si.getBBlockInfo(b);
+            if (!bi.isCallBlock() && !bi.getDefinitions().isProcessed())
+                performLvn(bi.getDefinitions(), b);
+        }
+    });
 }
 
 void MemorySSATransformation::computeAllDefinitions() {
     DBG_SECTION_BEGIN(dda, "Computing definitions for all uses (requested)");
+
+    // LVN of blocks does not depend on the search for definitions,
+    // do it for all blocks at once (it is done even with one thread,
+    // so that the results are the same)
+    performLvnOfAllBlocks();
+
+    std::vector<RWNode *> uses;
     for (auto *subg : graph.subgraphs()) {
         for (auto *b : subg->bblocks()) {
             for (auto *n : b->getNodes()) {
-                if (n->isUse()) {
-                    if (!n->defuse.initialized()) {
-                        n->addDefUse(findDefinitions(n));
-                        assert(n->defuse.initialized());
-                    }
-                }
+                if (n->isUse() && !n->defuse.initialized())
+                    uses.push_back(n);
+            }
+        }
+    }
+
+    // The definitions from the beginning of blocks to the uses are found
+    // by threads. The search for the rest of the definitions creates PHI
+    // nodes, so it is performed by one thread in the original order.
+    // The uses are processed in batches to bound the used memory.
+    const size_t BATCH = 1024;
+    std::vector<Definitions> blockDefs(std::min(BATCH, uses.size()));
+    // the sizes of blocks when blockDefs were computed
+    std::vector<size_t> blockSizes(blockDefs.size());
+
+    for (size_t b = 0; b < uses.size(); b += BATCH) {
+        const size_t n = std::min(BATCH, uses.size() - b);
+        parallelFor(options.workers, n, [&](size_t i) {
+            auto *use = uses[b + i];
+            blockDefs[i] = Definitions();
+            blockSizes[i] = 0;
+            if (!use->usesUnknown() && use->getBBlock()) {
+                blockDefs[i] = findDefinitionsInBlock(use);
+                blockSizes[i] = use->getBBlock()->size();
             }
+        });
+
+        for (size_t i = 0; i < n; ++i) {
+            auto *use = uses[b + i];
+            assert(!use->defuse.initialized());
+            // the nodes only get inserted into blocks, so if the block
+            // has the same size, the definitions are still valid
+            if (blockSizes[i] > 0 &&
+                blockSizes[i] == use->getBBlock()->size()) {
+                use->addDefUse(findDefinitions(use, blockDefs[i]));
+            } else {
+                use->addDefUse(findDefinitions(use));
+            }
+            assert(use->defuse.initialized());
         }
     }
+
     DBG_SECTION_END(dda, "Computing definitions for all uses finished");
 }
 
@@ -790,56 +863,128 @@ RWNode *MemorySSATransformation::insertUse(RWNode *where, RWNode *mem,
     return &use;
 }
 
-static void recGatherNonPhisDefs(RWNode *phi,
-                                 dg::ADT::SparseBitvectorHashImpl &phis,
-                                 dg::ADT::SparseBitvectorHashImpl &ret,
-                                 bool intraproc = false) {
+///
+// Get the non-PHI definitions that reach the PHI node 'phi' through PHI nodes.
+// The results are computed for the whole strongly connected components
+// of the graph of PHI nodes (the PHI nodes in one SCC have the same
+// non-PHI definitions) in the order given by the iterative Tarjan's
+// algorithm, so the results of the called SCCs are ready when the SCC
+// is finished. The results are cached and shared by the PHI nodes of
+// the SCC. The PHI nodes are complete after the search that created them,
+// so the cache is valid until new PHI nodes are created.
+const ADT::SparseBitvectorHashImpl &
+MemorySSATransformation::getNonPhiDefs(RWNode *phi) {
     assert(phi->isPhi());
-    // set returns the previous value, so if its 'true',
-    // we already had the phi
-    if (phis.set(phi->getID()))
-        return; // we already visited this phi
 
-    for (auto *n : phi->defuse) {
-        if (!n->isPhi()) {
-            ret.set(n->getID());
-        } else {
-            if (intraproc && n->isInOut()) {
-                ret.set(n->getID());
-            } else {
-                recGatherNonPhisDefs(n, phis, ret, intraproc);
+    auto &cache = _nonPhiDefs;
+    if (cache.phis != _phis.size()) {
+        cache.scc.clear();
+        cache.defs.clear();
+        cache.phis = _phis.size();
+    }
+
+    auto it = cache.scc.find(phi);
+    if (it != cache.scc.end())
+        return cache.defs[it->second];
+
+    struct Info {
+        unsigned dfsid{0};
+        unsigned lowpt{0};
+        bool onstack{false};
+    };
+    std::unordered_map<const RWNode *, Info> info;
+    std::vector<RWNode *> stack;
+    // (PHI node, the next operand of the PHI node)
+    using OperandIt = decltype(phi->defuse.begin());
+    std::vector<std::pair<RWNode *, OperandIt>> dfs;
+    unsigned index = 0;
+
+    auto visit = [&](RWNode *n) {
+        auto &I = info[n];
+        I.dfsid = I.lowpt = ++index;
+        I.onstack = true;
+        stack.push_back(n);
+        dfs.emplace_back(n, n->defuse.begin());
+    };
+
+    visit(phi);
+    while (!dfs.empty()) {
+        auto *cur = dfs.back().first;
+        auto &opit = dfs.back().second;
+        if (opit != cur->defuse.end()) {
+            auto *op = *opit;
+            ++opit;
+            if (!op->isPhi() || cache.scc.count(op) > 0)
+                continue;
+
+            auto &OI = info[op];
+            if (OI.dfsid == 0) {
+                visit(op);
+            } else if (OI.onstack) {
+                auto &CI = info[cur];
+                CI.lowpt = std::min(CI.lowpt, OI.dfsid);
             }
+            continue;
+        }
+
+        dfs.pop_back();
+        auto &CI = info[cur];
+        if (!dfs.empty()) {
+            auto &PI = info[dfs.back().first];
+            PI.lowpt = std::min(PI.lowpt, CI.lowpt);
         }
+
+        if (CI.lowpt != CI.dfsid)
+            continue;
+
+        // 'cur' is the root of an SCC, pop the SCC from the stack
+        const unsigned sccidx = cache.defs.size();
+        auto sccbegin = stack.end();
+        do {
+            --sccbegin;
+            info[*sccbegin].onstack = false;
+            cache.scc.emplace(*sccbegin, sccidx);
+        } while (*sccbegin != cur);
+
+        ADT::SparseBitvectorHashImpl defs;
+        for (auto nit = sccbegin; nit != stack.end(); ++nit) {
+            for (auto *op : (*nit)->defuse) {
+                if (!op->isPhi()) {
+                    assert(op->getID() > 0);
+                    defs.set(op->getID());
+                    continue;
+                }
+                auto opscc = cache.scc[op];
+                if (opscc != sccidx)
+                    defs.set(cache.defs[opscc]);
+            }
+        }
+        stack.erase(sccbegin, stack.end());
+        cache.defs.push_back(std::move(defs));
     }
+
+    assert(stack.empty());
+    return cache.defs[cache.scc[phi]];
 }
 
-// recursivelu replace all phi values with its non-phi definitions
+// replace all phi values with their non-phi definitions
 template <typename ContT>
-std::vector<RWNode *> gatherNonPhisDefs(ReadWriteGraph *graph,
-                                        const ContT &nodes,
-                                        bool intraproc = false) {
-    dg::ADT::SparseBitvectorHashImpl ret; // use set to get rid of duplicates
-    dg::ADT::SparseBitvectorHashImpl
-            phis; // set of visited phi nodes - to check the fixpoint
-
-    for (auto n : nodes) {
+std::vector<RWNode *>
+MemorySSATransformation::gatherNonPhisDefs(ContT &nodes) {
+    ADT::SparseBitvectorHashImpl ret; // use set to get rid of duplicates
+    for (auto *n : nodes) {
         if (!n->isPhi()) {
             assert(n->getID() > 0);
             ret.set(n->getID());
         } else {
-            if (intraproc && n->isInOut()) {
-                assert(n->getID() > 0);
-                ret.set(n->getID());
-            } else {
-                recGatherNonPhisDefs(n, phis, ret, intraproc);
-            }
+            ret.set(getNonPhiDefs(n));
         }
     }
 
     std::vector<RWNode *> retval;
     retval.reserve(ret.size());
     for (auto i : ret) {
-        retval.push_back(graph->getNode(i));
+        retval.push_back(graph.getNode(i));
     }
     return retval;
 }
@@ -850,7 +995,7 @@ std::vector<RWNode *> MemorySSATransformation::getDefinitions(RWNode *use) {
         use->addDefUse(findDefinitions(use));
         assert(use->defuse.initialized());
     }
-    return gatherNonPhisDefs(getGraph(), use->defuse);
+    return gatherNonPhisDefs(use->defuse);
 }
 
 // return the reaching definitions of ('mem', 'off', 'len')
@@ -862,12 +1007,236 @@ MemorySSATransformation::getDefinitions(RWNode *where, RWNode *mem,
     return getDefinitions(use);
 }
 
+std::vector<std::vector<RWNode *>> MemorySSATransformation::getDefinitions(
+        const std::vector<DefinitionsQuery> &queries) {
+    DBG_SECTION_BEGIN(dda, "Answering " << queries.size() << " queries");
+
+    std::vector<std::vector<RWNode *>> ret(queries.size());
+
+    // group the queries by blocks (in the order of the first query
+    // from the block, so that the PHI nodes are created in a fixed order)
+    std::vector<RWBBlock *> blocks;
+    std::unordered_map<RWBBlock *, std::vector<size_t>> blockQueries;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto *block = queries[i].where->getBBlock();
+        if (!block) {
+            // unreachable or a subnode of a call, no definitions
+            continue;
+        }
+        auto &Q = blockQueries[block];
+        if (Q.empty())
+            blocks.push_back(block);
+        Q.push_back(i);
+    }
+
+    for (auto *block : blocks) {
+        std::unordered_map<const RWNode *, std::vector<size_t>> nodeQueries;
+        for (auto i : blockQueries[block])
+            nodeQueries[queries[i].where].push_back(i);
+
+        // perform the LVN of the block once and answer the queries
+        // on the way (instead of inserting MU nodes into the block)
+        Definitions D;
+        for (RWNode *node : block->getNodes()) {
+            auto it = nodeQueries.find(node);
+            if (it != nodeQueries.end()) {
+                for (auto i : it->second) {
+                    const auto &q = queries[i];
+                    if (q.mem->isUnknown()) {
+                        auto defs = findAllDefinitions(node);
+                        ret[i] = gatherNonPhisDefs(defs);
+                        continue;
+                    }
+
+                    DefSite ds{q.mem, q.off, q.len};
+                    std::vector<RWNode *> defs;
+                    D.gather(ds, defs);
+                    for (auto &interval : D.uncovered(ds)) {
+                        DefSite uds{ds.target, interval.start,
+                                    interval.length()};
+                        auto preddefs = findDefinitionsInPredecessors(block, uds);
+                        if (!preddefs.empty() &&
+                            !block->getSinglePredecessor()) {
+                            // the definitions are represented by a new PHI
+                            // node from the beginning of this block, the
+                            // next queries from this block must see it
+                            assert(preddefs.size() == 1);
+                            auto *phi = preddefs[0];
+                            D.definitions.add(uds, phi);
+                            D.kills.add(uds, phi);
+                            if (!D.getUnknownWrites().empty()) {
+                                D.definitions.add(uds, D.getUnknownWrites());
+                            }
+                        }
+                        defs.insert(defs.end(), preddefs.begin(),
+                                    preddefs.end());
+                    }
+                    ret[i] = gatherNonPhisDefs(defs);
+                }
+                nodeQueries.erase(it);
+                if (nodeQueries.empty())
+                    break;
+            }
+            D.update(node);
+        }
+        assert(nodeQueries.empty() && "Did not find a queried node");
+    }
+
+    DBG_SECTION_END(dda, "Answering " << queries.size() << " queries done");
+    return ret;
+}
+
+///
+// Get the definitions of the block that were already found. 'tmp'
+// is used for blocks whose definitions were not computed yet.
+// Return nullptr if the definitions of 'ds' in the block cannot be
+// found without creating new PHI nodes.
+const Definitions *
+MemorySSATransformation::getKnownBBlockDefinitions(RWBBlock *b,
+                                                   const DefSite &ds,
+                                                   Definitions &tmp) const {
+    const auto *bi = getBBlockInfo(b);
+    if (bi && bi->getDefinitions().isProcessed())
+        return &bi->getDefinitions();
+
+    if (bi && bi->isCallBlock()) {
+        const auto &D = bi->getDefinitions();
+        // the search would create PHI nodes for the uncovered parts
+        // of the memory if the call may define it
+        if (!D.uncovered(ds).empty() &&
+            callMayDefineTarget(const_cast<RWNodeCall *>(bi->getCall()),
+                                ds.target)) {
+            return nullptr;
+        }
+        return &D;
+    }
+
+    // the same as performLvn(), but the result is not stored
+    for (RWNode *node : b->getNodes()) {
+        tmp.update(node);
+    }
+    return &tmp;
+}
+
+bool MemorySSATransformation::findKnownDefinitionsInPredecessors(
+        RWBBlock *block, const DefSite &ds, std::vector<RWNode *> &defs,
+        std::set<RWBBlock *> &path) const {
+    if (!block->hasPredecessors()) {
+        // the entry block, use the input PHI nodes that we already have
+        auto *subg = block->getSubgraph();
+        if (!canBeInput(ds.target, subg))
+            return true;
+
+        const auto *si = getSubgraphInfo(subg);
+        if (!si || !si->getSummary().inputs.undefinedIntervals(ds).empty())
+            return false;
+        si->getSummary().inputs.gather(ds, defs);
+        return true;
+    }
+
+    auto *pred = block->getSinglePredecessor();
+    if (!pred) {
+        // the search would create a PHI node
+        return false;
+    }
+
+    // a cycle of blocks with single predecessors
+    // (an unreachable loop), no definitions come from there
+    if (!path.insert(pred).second)
+        return true;
+
+    Definitions tmp;
+    const auto *D = getKnownBBlockDefinitions(pred, ds, tmp);
+    if (!D)
+        return false;
+
+    D->gather(ds, defs);
+    for (auto &interval : D->uncovered(ds)) {
+        if (!findKnownDefinitionsInPredecessors(
+                    pred, {ds.target, interval.start, interval.length()}, defs,
+                    path))
+            return false;
+    }
+
+    path.erase(pred);
+    return true;
+}
+
+///
+// Find the definitions using only the block definitions and PHI nodes
+// that we already have. The search follows the same path as the on-demand
+// search, but it gives up when it would need to create a PHI node.
+bool MemorySSATransformation::getKnownDefinitions(
+        const DefinitionsQuery &query, std::vector<RWNode *> &defs) const {
+    auto *block = query.where->getBBlock();
+    if (!block)
+        return true; // no definitions
+
+    if (query.mem->isUnknown())
+        return false;
+
+    DefSite ds{query.mem, query.off, query.len};
+    auto D = findDefinitionsInBlock(query.where);
+    std::vector<RWNode *> found;
+    D.gather(ds, found);
+    for (auto &interval : D.uncovered(ds)) {
+        std::set<RWBBlock *> path;
+        if (!findKnownDefinitionsInPredecessors(
+                    block, {ds.target, interval.start, interval.length()},
+                    found, path))
+            return false;
+    }
+
+    // replace the PHI nodes with their non-PHI definitions
+    // (use the cached results if they are valid, but do not update them)
+    const bool useCache = _nonPhiDefs.phis == _phis.size();
+    ADT::SparseBitvectorHashImpl ret;
+    ADT::SparseBitvectorHashImpl visited;
+    std::vector<RWNode *> worklist;
+    auto add = [&](RWNode *n) {
+        if (!n->isPhi()) {
+            assert(n->getID() > 0);
+            ret.set(n->getID());
+            return;
+        }
+        if (useCache) {
+            auto it = _nonPhiDefs.scc.find(n);
+            if (it != _nonPhiDefs.scc.end()) {
+                ret.set(_nonPhiDefs.defs[it->second]);
+                return;
+            }
+        }
+        if (!visited.set(n->getID()))
+            worklist.push_back(n);
+    };
+
+    for (auto *n : found)
+        add(n);
+    while (!worklist.empty()) {
+        auto *phi = worklist.back();
+        worklist.pop_back();
+        for (auto *n : phi->defuse)
+            add(n);
+    }
+
+    for (auto i : ret) {
+        // the nodes are not modified here, the caller gets them
+        // in the same way as from getDefinitions()
+        defs.push_back(const_cast<RWNode *>(graph.getNode(i)));
+    }
+    return true;
+}
+
 void MemorySSATransformation::run() {
     DBG_SECTION_BEGIN(dda, "Initializing MemorySSA analysis");
 
     initialize();
+    computeModRef();
 
+    // with more threads, compute all definitions eagerly,
     // the rest is on-demand :)
+    if (options.workers > 1)
+        computeAllDefinitions();
 
     DBG_SECTION_END(dda, "Initializing MemorySSA analysis finished");
 }
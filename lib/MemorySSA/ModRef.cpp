@@ -1,5 +1,11 @@
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "dg/MemorySSA/MemorySSA.h"
 #include "dg/util/debug.h"
+#include "dg/util/parallel.h"
 
 namespace dg {
 namespace dda {
@@ -21,17 +27,8 @@ static void modRefAdd(MR &modref, const C &c, RWNode *node, RWSubgraph *subg) {
     }
 }
 
-void MemorySSATransformation::computeModRef(RWSubgraph *subg,
-                                            SubgraphInfo &si) {
-    if (si.modref.isInitialized()) {
-        return;
-    }
-
-    DBG_SECTION_BEGIN(dda, "Computing modref for subgraph " << subg->getName());
-
-    // set it here due to recursive procedures
-    si.modref.setInitialized();
-
+void MemorySSATransformation::computeLocalModRef(RWSubgraph *subg,
+                                                 SubgraphInfo &si) {
     // iterate over the blocks (note: not over the infos, those
     // may not be created if the block was not used yet
     for (auto *b : subg->bblocks()) {
@@ -39,23 +36,17 @@ void MemorySSATransformation::computeModRef(RWSubgraph *subg,
         if (bi.isCallBlock()) {
             auto *C = bi.getCall();
             for (auto &callee : C->getCallees()) {
-                auto *csubg = callee.getSubgraph();
-                if (csubg) {
-                    auto &callsi = getSubgraphInfo(csubg);
-                    computeModRef(csubg, callsi);
-                    assert(callsi.modref.isInitialized());
-
-                    si.modref.add(callsi.modref);
-                } else {
-                    // undefined function
-                    modRefAdd(si.modref.maydef,
-                              callee.getCalledValue()->getDefines(), C, csubg);
-                    modRefAdd(si.modref.maydef,
-                              callee.getCalledValue()->getOverwrites(), C,
-                              csubg);
-                    modRefAdd(si.modref.mayref,
-                              callee.getCalledValue()->getUses(), C, csubg);
+                if (callee.getSubgraph()) {
+                    // added when processing the called subgraphs
+                    continue;
                 }
+                // undefined function
+                modRefAdd(si.modref.maydef,
+                          callee.getCalledValue()->getDefines(), C, nullptr);
+                modRefAdd(si.modref.maydef,
+                          callee.getCalledValue()->getOverwrites(), C, nullptr);
+                modRefAdd(si.modref.mayref, callee.getCalledValue()->getUses(),
+                          C, nullptr);
             }
         } else {
             // do not perform LVN if not needed, just scan the nodes
@@ -66,8 +57,153 @@ void MemorySSATransformation::computeModRef(RWSubgraph *subg,
             }
         }
     }
-    DBG_SECTION_END(dda, "Computing modref for subgraph " << subg->getName()
-                                                          << " done");
+}
+
+///
+// Compute ModRef information of all subgraphs bottom-up over the SCCs
+// of the call graph. The information of subgraphs in one SCC
+// (recursive procedures) is iterated to a fixpoint. SCCs that do not
+// call each other are processed in parallel if we have more workers.
+// The SCCs are computed by iterative Tarjan's algorithm, the call
+// chains can be really long.
+void MemorySSATransformation::computeModRef() {
+    DBG_SECTION_BEGIN(dda, "Computing modref for all subgraphs");
+
+    std::vector<RWSubgraph *> subgraphs;
+    std::vector<SubgraphInfo *> infos;
+    std::unordered_map<const RWSubgraph *, unsigned> ids;
+    for (auto *subg : graph.subgraphs()) {
+        ids.emplace(subg, subgraphs.size());
+        subgraphs.push_back(subg);
+        infos.push_back(&getSubgraphInfo(subg));
+    }
+
+    // the call graph
+    std::vector<std::vector<unsigned>> callees(subgraphs.size());
+    for (unsigned i = 0; i < subgraphs.size(); ++i) {
+        for (auto *b : subgraphs[i]->bblocks()) {
+            auto &bi = infos[i]->getBBlockInfo(b);
+            if (!bi.isCallBlock())
+                continue;
+            for (auto &callee : bi.getCall()->getCallees()) {
+                if (auto *csubg = callee.getSubgraph()) {
+                    auto &C = callees[i];
+                    auto id = ids[csubg];
+                    if (std::find(C.begin(), C.end(), id) == C.end())
+                        C.push_back(id);
+                }
+            }
+        }
+    }
+
+    struct Info {
+        unsigned dfsid{0};
+        unsigned lowpt{0};
+        bool onstack{false};
+    };
+    std::vector<Info> info(subgraphs.size());
+    std::vector<unsigned> stack;
+    // (subgraph, index of the next callee)
+    std::vector<std::pair<unsigned, size_t>> dfs;
+    // SCCs in the reverse topological order (callees first)
+    std::vector<std::vector<unsigned>> sccs;
+    std::vector<unsigned> sccOf(subgraphs.size());
+    unsigned index = 0;
+
+    auto visit = [&](unsigned n) {
+        info[n].dfsid = info[n].lowpt = ++index;
+        info[n].onstack = true;
+        stack.push_back(n);
+        dfs.emplace_back(n, 0);
+    };
+
+    for (unsigned root = 0; root < subgraphs.size(); ++root) {
+        if (info[root].dfsid != 0)
+            continue;
+
+        visit(root);
+        while (!dfs.empty()) {
+            unsigned cur = dfs.back().first;
+            if (dfs.back().second < callees[cur].size()) {
+                unsigned succ = callees[cur][dfs.back().second++];
+                if (info[succ].dfsid == 0) {
+                    visit(succ);
+                } else if (info[succ].onstack) {
+                    info[cur].lowpt =
+                            std::min(info[cur].lowpt, info[succ].dfsid);
+                }
+                continue;
+            }
+
+            dfs.pop_back();
+            if (!dfs.empty()) {
+                auto &PI = info[dfs.back().first];
+                PI.lowpt = std::min(PI.lowpt, info[cur].lowpt);
+            }
+
+            if (info[cur].lowpt != info[cur].dfsid)
+                continue;
+
+            sccs.emplace_back();
+            unsigned w;
+            do {
+                w = stack.back();
+                stack.pop_back();
+                info[w].onstack = false;
+                sccOf[w] = sccs.size() - 1;
+                sccs.back().push_back(w);
+            } while (w != cur);
+        }
+    }
+
+    // Group the SCCs by their height in the condensed call graph.
+    // The SCCs of one group do not call each other and the SCCs
+    // that they call are in the previous groups.
+    std::vector<unsigned> height(sccs.size(), 0);
+    std::vector<std::vector<unsigned>> groups;
+    for (unsigned i = 0; i < sccs.size(); ++i) {
+        for (auto n : sccs[i]) {
+            for (auto c : callees[n]) {
+                if (sccOf[c] != i)
+                    height[i] = std::max(height[i], height[sccOf[c]] + 1);
+            }
+        }
+        if (groups.size() <= height[i])
+            groups.resize(height[i] + 1);
+        groups[height[i]].push_back(i);
+    }
+
+    auto processSCC = [&](unsigned scc) {
+        for (auto n : sccs[scc])
+            computeLocalModRef(subgraphs[n], *infos[n]);
+
+        // add the information from the called subgraphs,
+        // iterate until the fixpoint is reached inside the SCC
+        bool changed;
+        do {
+            changed = false;
+            for (auto n : sccs[scc]) {
+                for (auto c : callees[n]) {
+                    if (c != n)
+                        changed |= infos[n]->modref.add(infos[c]->modref);
+                }
+            }
+            // SCCs with one subgraph do not need more iterations
+        } while (changed && sccs[scc].size() > 1);
+
+        for (auto n : sccs[scc])
+            infos[n]->modref.setInitialized();
+    };
+
+    for (auto &group : groups) {
+        parallelFor(options.workers, group.size(),
+                    [&](size_t i) { processSCC(group[i]); }, 1);
+    }
+
+    DBG_SECTION_END(dda, "Computing modref for " << subgraphs.size()
+                                                 << " subgraphs in "
+                                                 << sccs.size()
+                                                 << " SCCs done");
 }
 
 } // namespace dda
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "dg/PointerAnalysis/PointerAnalysis.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace pta {
+
+// Is the node just copying the pointers from its operands?
+// A cycle of such nodes has the same points-to set in every node.
+bool PointerAnalysis::isCopyNode(const PSNode *node) const {
+    switch (node->getType()) {
+    case PSNodeType::PHI:
+    case PSNodeType::CAST:
+        return true;
+    case PSNodeType::RETURN:
+    case PSNodeType::CALL_RETURN:
+        // call return adds invalidated pointers
+        // when tracking invalidated memory
+        return !options.invalidateNodes;
+    default:
+        return false;
+    }
+}
+
+///
+// Lazy cycle detection: if a copy node has the same points-to set as its
+// operand, the edge between them may be a part of a cycle. In that case,
+// search for cycles of copy nodes that contain the node and collapse them.
+// Every edge is checked only once.
+bool PointerAnalysis::detectCycles(PSNode *node) {
+    PSNode *rep = getRepresentative(node);
+    const auto &pts = rep->pointsTo;
+    if (pts.empty())
+        return false;
+
+    bool search = false;
+    for (PSNode *op : node->getOperands()) {
+        if (!isCopyNode(op))
+            continue;
+        PSNode *oprep = getRepresentative(op);
+        if (oprep == rep || oprep->pointsTo.size() != pts.size())
+            continue;
+        if (_checkedCopyEdges.emplace(op->getID(), node->getID()).second)
+            search = true;
+    }
+
+    if (!search)
+        return false;
+
+    // iterative Tarjan's algorithm on the copy nodes reachable
+    // from 'node' via def-use edges
+    struct Info {
+        unsigned dfsid{0};
+        unsigned lowpt{0};
+        bool onstack{false};
+    };
+    std::unordered_map<PSNode *, Info> info;
+    std::vector<PSNode *> stack;
+    // (node, index of the next user to process)
+    std::vector<std::pair<PSNode *, size_t>> dfs;
+    unsigned index = 0;
+    bool changed = false;
+
+    auto visit = [&](PSNode *n) {
+        auto &I = info[n];
+        I.dfsid = I.lowpt = ++index;
+        I.onstack = true;
+        stack.push_back(n);
+        dfs.emplace_back(n, 0);
+    };
+
+    visit(node);
+    while (!dfs.empty()) {
+        PSNode *cur = dfs.back().first;
+        size_t &idx = dfs.back().second;
+        const auto &users = cur->getUsers();
+
+        if (idx < users.size()) {
+            PSNode *user = users[idx++];
+            if (!isCopyNode(user))
+                continue;
+
+            auto it = info.find(user);
+            if (it == info.end()) {
+                visit(user);
+            } else if (it->second.onstack) {
+                auto &I = info[cur];
+                I.lowpt = std::min(I.lowpt, it->second.dfsid);
+            }
+            continue;
+        }
+
+        dfs.pop_back();
+        auto &I = info[cur];
+        if (!dfs.empty()) {
+            auto &PI = info[dfs.back().first];
+            PI.lowpt = std::min(PI.lowpt, I.lowpt);
+        }
+
+        if (I.lowpt != I.dfsid)
+            continue;
+
+        std::vector<PSNode *> scc;
+        PSNode *w;
+        do {
+            w = stack.back();
+            stack.pop_back();
+            info[w].onstack = false;
+            scc.push_back(w);
+        } while (w != cur);
+
+        if (scc.size() > 1)
+            changed |= collapse(scc);
+    }
+
+    return changed;
+}
+
+bool PointerAnalysis::collapse(const std::vector<PSNode *> &scc) {
+    std::vector<PSNode *> reps;
+    for (PSNode *n : scc) {
+        PSNode *rep = getRepresentative(n);
+        if (std::find(reps.begin(), reps.end(), rep) == reps.end())
+            reps.push_back(rep);
+    }
+
+    if (reps.size() < 2)
+        return false;
+
+    // use the node with the biggest points-to set as the representative
+    PSNode *rep = *std::max_element(
+            reps.begin(), reps.end(), [](PSNode *a, PSNode *b) {
+                return a->pointsTo.size() < b->pointsTo.size();
+            });
+
+    DBG(pta, "Collapsing " << scc.size() << " nodes into " << rep->getID());
+
+    if (_representatives.size() <= PG->getNodes().size())
+        _representatives.resize(PG->getNodes().size() + 1);
+
+    for (PSNode *other : reps) {
+        if (other == rep)
+            continue;
+        rep->pointsTo.add(other->pointsTo);
+        other->pointsTo.clear();
+        _representatives[other->getID()] = rep;
+    }
+
+    // the nodes in the cycle and their users must see the whole new
+    // points-to set and must be processed again
+    if (options.differencePropagation) {
+        auto &D = getDeltaInfo(rep);
+        D.prevChanged = D.changed = _round;
+        D.delta.clear();
+    }
+
+    for (PSNode *n : scc) {
+        if (options.differencePropagation) {
+            getDeltaInfo(n).processed = 0;
+            for (PSNode *user : n->getUsers())
+                getDeltaInfo(user).processed = 0;
+        }
+        enqueue(n);
+        for (PSNode *user : n->getUsers())
+            enqueue(user);
+    }
+
+    return true;
+}
+
+void PointerAnalysis::finalizeCollapsedNodes() {
+    for (size_t i = 0; i < _representatives.size(); ++i) {
+        if (_representatives[i] == nullptr)
+            continue;
+
+        PSNode *node = PG->getNodes()[i].get();
+        PSNode *rep = getRepresentative(node);
+        node->pointsTo.clear();
+        node->pointsTo.add(rep->pointsTo);
+        _collapsed.set(node, rep);
+    }
+}
+
+} // namespace pta
+} // namespace dg
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <vector>
+
+#include "dg/PointerAnalysis/PointerAnalysis.h"
+
+#include "dg/util/debug.h"
+#include "dg/util/parallel.h"
+
+namespace dg {
+namespace pta {
+
+// the minimal number of nodes for one thread,
+// smaller waves are not worth starting the threads
+static const size_t MIN_NODES_PER_WORKER = 64;
+// the number of nodes that a thread takes at once
+static const size_t NODES_CHUNK = 16;
+
+// marks of nodes in a wave
+static const char WRITTEN = 1;
+static const char READ = 2;
+
+///
+// Return true if processing the node changes only the points-to set
+// of the node (and the information for the difference propagation
+// of the node). Such nodes may be processed in parallel if they do
+// not read the points-to sets of each other.
+// Other nodes (STORE, MEMCPY, calls via pointers, ...) write memory
+// objects or change the graph.
+bool PointerAnalysis::processesOnlyItself(const PSNode *node) const {
+    switch (node->getType()) {
+    case PSNodeType::LOAD:
+    case PSNodeType::GEP:
+    case PSNodeType::CAST:
+    case PSNodeType::PHI:
+    case PSNodeType::RETURN:
+    case PSNodeType::CALL_RETURN:
+    case PSNodeType::CONSTANT:
+    case PSNodeType::ALLOC:
+    case PSNodeType::FUNCTION:
+    case PSNodeType::CALL:
+    case PSNodeType::ENTRY:
+    case PSNodeType::NOOP:
+    case PSNodeType::FREE:
+    case PSNodeType::INVALIDATE_OBJECT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Processing of these nodes does not change any points-to set
+static bool keepsPointsTo(const PSNode *node) {
+    switch (node->getType()) {
+    case PSNodeType::CONSTANT:
+    case PSNodeType::ALLOC:
+    case PSNodeType::FUNCTION:
+    case PSNodeType::CALL:
+    case PSNodeType::ENTRY:
+    case PSNodeType::NOOP:
+    case PSNodeType::FREE:
+    case PSNodeType::INVALIDATE_OBJECT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool PointerAnalysis::processWithHooks(PSNode *node) {
+    bool enq = false;
+    enq |= beforeProcessed(node);
+    enq |= processNode(node);
+    enq |= afterProcessed(node);
+    return enq;
+}
+
+void PointerAnalysis::processWave(const std::vector<PSNode *> &wave) {
+    if (wave.empty())
+        return;
+
+    const size_t nodesNum = PG->getNodes().size();
+    // the threads must not resize the vector
+    if (options.differencePropagation && _deltas.size() < nodesNum)
+        _deltas.resize(nodesNum);
+
+    const size_t workers =
+            std::min(static_cast<size_t>(options.workers),
+                     wave.size() / MIN_NODES_PER_WORKER);
+
+    // NOTE: not std::vector<bool>, threads write different elements
+    std::vector<char> enq(wave.size(), 0);
+    auto process = [&](size_t i) { enq[i] = processWithHooks(wave[i]); };
+    if (workers <= 1) {
+        for (size_t i = 0; i < wave.size(); ++i)
+            process(i);
+    } else {
+        prepareParallelProcessing();
+        PG->getPointerIDs().setConcurrent(true);
+        parallelFor(workers, wave.size(), process, NODES_CHUNK);
+        PG->getPointerIDs().setConcurrent(false);
+    }
+
+    _processedNodes += wave.size();
+
+    // enqueue in the order of processing,
+    // so that the next iteration is the same as with one thread
+    for (size_t i = 0; i < wave.size(); ++i) {
+        if (enq[i])
+            enqueue(wave[i]);
+    }
+}
+
+///
+// Process the nodes from 'to_process' such that the result is the same
+// as if they were processed one by one in the given order.
+// The nodes are split into waves of consecutive nodes such that
+// the nodes in a wave change only their own points-to sets
+// and no node of a wave reads the points-to set of another node
+// of the wave. The nodes in a wave are processed in parallel.
+// Other nodes are processed alone.
+void PointerAnalysis::parallelIteration() {
+    std::vector<PSNode *> wave;
+
+    auto newWave = [this, &wave]() {
+        processWave(wave);
+        wave.clear();
+        ++_waveStamp;
+        // new nodes could be created by the processed nodes
+        if (_waveMarks.size() < PG->getNodes().size())
+            _waveMarks.resize(PG->getNodes().size());
+    };
+
+    auto mark = [this](const PSNode *n) -> char {
+        const auto &M = _waveMarks[n->getID()];
+        return M.first == _waveStamp ? M.second : 0;
+    };
+
+    auto setMark = [this](const PSNode *n, char m) {
+        auto &M = _waveMarks[n->getID()];
+        if (M.first != _waveStamp) {
+            M.first = _waveStamp;
+            M.second = 0;
+        }
+        M.second |= m;
+    };
+
+    newWave();
+    for (PSNode *cur : to_process) {
+        if (!processesOnlyItself(cur)) {
+            newWave();
+            if (processWithHooks(cur))
+                enqueue(cur);
+            ++_processedNodes;
+            // the node could change the graph
+            newWave();
+            continue;
+        }
+
+        // the node must not change what a node in the wave reads
+        // and must not read what a node in the wave writes
+        bool conflict = !keepsPointsTo(cur) && mark(cur) != 0;
+        for (PSNode *op : cur->getOperands()) {
+            if (conflict)
+                break;
+            conflict = op != cur && (mark(op) & WRITTEN);
+        }
+        if (conflict)
+            newWave();
+
+        wave.push_back(cur);
+        if (!keepsPointsTo(cur))
+            setMark(cur, WRITTEN);
+        for (PSNode *op : cur->getOperands())
+            setMark(op, READ);
+    }
+
+    processWave(wave);
+}
+
+} // namespace pta
+} // namespace dg
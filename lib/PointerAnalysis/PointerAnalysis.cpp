@@ -31,17 +31,142 @@ static bool funHasAddressTaken(PSNode *node) {
     });
 }
 
+PointerAnalysis::DeltaInfo &
+PointerAnalysis::getDeltaInfo(const PSNode *node) {
+    if (_deltas.size() <= node->getID())
+        _deltas.resize(node->getID() + 1);
+    return _deltas[node->getID()];
+}
+
+// Get the pointers from the points-to set of the idx-th operand
+// of the node that the node has not seen yet. Returns nullptr
+// if there are no such pointers.
+const PointsToSetT *PointerAnalysis::getNewPointers(PSNode *node,
+                                                    size_t idx) {
+    PSNode *op = getRepresentative(node->getOperand(idx));
+    if (!options.differencePropagation)
+        return &op->pointsTo;
+
+    const auto &ND = getDeltaInfo(node);
+    // we have not processed the node yet or the operand is new
+    if (ND.processed == 0 || idx >= ND.operandsNum)
+        return &op->pointsTo;
+
+    // the operand and the node share the points-to set
+    if (op == getRepresentative(node))
+        return nullptr;
+
+    const auto &OD = getDeltaInfo(op);
+    if (OD.changed < ND.processed)
+        return nullptr;
+    // all the pointers added since the last processing of the node
+    // are in the delta
+    if (OD.prevChanged < ND.processed)
+        return &OD.delta;
+    return &op->pointsTo;
+}
+
+// Could the memory object change since the last processing of the node?
+bool PointerAnalysis::objectChanged(PSNode *node,
+                                    const MemoryObject *mo) const {
+    if (!options.differencePropagation || !canTrackObjectChanges())
+        return true;
+
+    if (_deltas.size() <= node->getID())
+        return true;
+    unsigned processed = _deltas[node->getID()].processed;
+    if (processed == 0)
+        return true;
+
+    auto it = _objectsChanged.find(mo);
+    return it != _objectsChanged.end() && it->second >= processed;
+}
+
+bool PointerAnalysis::addPointsTo(PSNode *node, const Pointer &ptr) {
+    node = getRepresentative(node);
+    if (!node->addPointsTo(ptr))
+        return false;
+
+    if (options.differencePropagation) {
+        auto &D = getDeltaInfo(node);
+        if (D.changed != _round) {
+            D.prevChanged = D.changed;
+            D.changed = _round;
+            D.delta.clear();
+        }
+        D.delta.add(ptr);
+    }
+
+    return true;
+}
+
+bool PointerAnalysis::addPointsTo(PSNode *node, const PointsToSetT &ptrs) {
+    if (!options.differencePropagation)
+        return getRepresentative(node)->addPointsTo(ptrs);
+
+    bool changed = false;
+    for (const auto &ptr : ptrs)
+        changed |= addPointsTo(node, ptr);
+    return changed;
+}
+
+bool PointerAnalysis::addPointsTo(PSNode *where, MemoryObject *mo,
+                                  const Offset &off, const Pointer &ptr) {
+    // do not ask for a writable object if there is nothing new
+    auto it = mo->find(off);
+    if (it != mo->end() && it->second.mayPointTo(ptr))
+        return false;
+
+    mo = getWritableObject(where, mo);
+    if (!mo->addPointsTo(off, ptr))
+        return false;
+    if (options.differencePropagation)
+        _objectsChanged[mo] = _round;
+    return true;
+}
+
+bool PointerAnalysis::addPointsTo(PSNode *where, MemoryObject *mo,
+                                  const Offset &off, const PointsToSetT &ptrs) {
+    if (ptrs.empty())
+        return false;
+
+    auto it = mo->find(off);
+    if (it != mo->end()) {
+        bool hasAll = true;
+        for (const auto &ptr : ptrs) {
+            if (!it->second.mayPointTo(ptr)) {
+                hasAll = false;
+                break;
+            }
+        }
+        if (hasAll)
+            return false;
+    }
+
+    mo = getWritableObject(where, mo);
+    if (!mo->addPointsTo(off, ptrs))
+        return false;
+    if (options.differencePropagation)
+        _objectsChanged[mo] = _round;
+    return true;
+}
+
 bool PointerAnalysis::processLoad(PSNode *node) {
     bool changed = false;
     PSNode *operand = node->getOperand(0);
 
-    if (operand->pointsTo.empty())
+    const auto &operandPts = getPointsTo(operand);
+    if (operandPts.empty())
         return error(operand, "Load's operand has no points-to set");
 
-    for (const Pointer &ptr : operand->pointsTo) {
+    // the pointers that we have not loaded from yet. From the other
+    // pointers, we must load only if the memory changed
+    const PointsToSetT *newPtrs = getNewPointers(node, 0);
+
+    for (const Pointer &ptr : operandPts) {
         if (ptr.isUnknown()) {
             // load from unknown pointer yields unknown pointer
-            changed |= node->addPointsTo(UnknownPointer);
+            changed |= addPointsTo(node, UnknownPointer);
             continue;
         }
 
@@ -62,14 +187,20 @@ bool PointerAnalysis::processLoad(PSNode *node) {
             if (target->isZeroInitialized())
                 // if the memory is zero initialized, then everything
                 // is fine, we add nullptr
-                changed |= node->addPointsTo(NullPointer);
+                changed |= addPointsTo(node, NullPointer);
             else
                 changed |= errorEmptyPointsTo(node, target);
 
             continue;
         }
 
+        const bool isNew = newPtrs == &operandPts ||
+                           (newPtrs && newPtrs->count(ptr) > 0);
+
         for (MemoryObject *o : objects) {
+            if (!isNew && !objectChanged(node, o))
+                continue;
+
             // is the offset to the memory unknown?
             // In that case everything can be referenced,
             // so we need to copy the whole points-to
@@ -79,7 +210,7 @@ bool PointerAnalysis::processLoad(PSNode *node) {
                 // FIXME: don't duplicate the code
                 if (o->pointsTo.empty()) {
                     if (target->isZeroInitialized())
-                        changed |= node->addPointsTo(NullPointer);
+                        changed |= addPointsTo(node, NullPointer);
                     else if (objects.size() == 1)
                         changed |= errorEmptyPointsTo(node, target);
                 }
@@ -87,7 +218,7 @@ bool PointerAnalysis::processLoad(PSNode *node) {
                 // we have some pointers - copy them all,
                 // since the offset is unknown
                 for (auto &it : o->pointsTo) {
-                    changed |= node->addPointsTo(it.second);
+                    changed |= addPointsTo(node, it.second);
                 }
 
                 // this is all that we can do here...
@@ -101,7 +232,7 @@ bool PointerAnalysis::processLoad(PSNode *node) {
                 // if the memory is zero initialized, then everything
                 // is fine, we add nullptr
                 if (target->isZeroInitialized())
-                    changed |= node->addPointsTo(NullPointer);
+                    changed |= addPointsTo(node, NullPointer);
                 // if we don't have a definition even with unknown offset
                 // it is an error
                 // FIXME: don't triplicate the code!
@@ -110,14 +241,14 @@ bool PointerAnalysis::processLoad(PSNode *node) {
             } else {
                 // we have pointers on that memory, so we can
                 // do the work
-                changed |= node->addPointsTo(it->second);
+                changed |= addPointsTo(node, it->second);
             }
 
             // plus always add the pointers at unknown offset,
             // since these can be what we need too
             it = o->pointsTo.find(Offset::UNKNOWN);
             if (it != o->pointsTo.end()) {
-                changed |= node->addPointsTo(it->second);
+                changed |= addPointsTo(node, it->second);
             }
         }
     }
@@ -135,7 +266,7 @@ bool PointerAnalysis::processMemcpy(PSNode *node) {
     std::vector<MemoryObject *> destObjects;
 
     // gather srcNode pointer objects
-    for (const Pointer &ptr : srcNode->pointsTo) {
+    for (const Pointer &ptr : getPointsTo(srcNode)) {
         assert(ptr.target && "Got nullptr as target");
 
         if (!canBeDereferenced(ptr))
@@ -150,7 +281,7 @@ bool PointerAnalysis::processMemcpy(PSNode *node) {
         }
 
         // gather destNode objects
-        for (const Pointer &dptr : destNode->pointsTo) {
+        for (const Pointer &dptr : getPointsTo(destNode)) {
             assert(dptr.target && "Got nullptr as target");
 
             if (!canBeDereferenced(dptr))
@@ -164,7 +295,7 @@ bool PointerAnalysis::processMemcpy(PSNode *node) {
                 return changed;
             }
 
-            changed |= processMemcpy(srcObjects, destObjects, ptr, dptr,
+            changed |= processMemcpy(node, srcObjects, destObjects, ptr, dptr,
                                      memcpy->getLength());
         }
     }
@@ -182,7 +313,8 @@ static Pointer unwrapConstants(const Pointer &ptr) {
     return {target, offset};
 }
 
-bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
+bool PointerAnalysis::processMemcpy(PSNode *node,
+                                    std::vector<MemoryObject *> &srcObjects,
                                     std::vector<MemoryObject *> &destObjects,
                                     const Pointer &sptr, const Pointer &dptr,
                                     Offset len) {
@@ -222,45 +354,54 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
 
     for (MemoryObject *destO : destObjects) {
         if (contains_null_somewhere)
-            changed |= destO->addPointsTo(Offset::UNKNOWN, NullPointer);
+            changed |= addPointsTo(node, destO, Offset::UNKNOWN, NullPointer);
 
         // copy every pointer from srcObjects that is in
         // the range to destination's objects
         for (MemoryObject *so : srcObjects) {
-            for (auto &src : so->pointsTo) { // src.first is offset,
-                                             // src.second is a PointToSet
-
-                // if the offset is inbound of the copied memory
-                // or we copy from unknown offset, or this pointer
-                // is on unknown offset, copy this pointer
-                if (src.first.isUnknown() || srcOffset.isUnknown() ||
-                    (srcOffset <= src.first &&
-                     (len.isUnknown() || *src.first - *srcOffset < *len))) {
-                    // copy the pointer, but shift it by the offsets
-                    // we are working with
-                    if (!src.first.isUnknown() && !srcOffset.isUnknown() &&
-                        !destOffset.isUnknown()) {
-                        // check that new offset does not overflow
-                        // Offset::UNKNOWN
-                        if (Offset::UNKNOWN - *destOffset <=
-                            *src.first - *srcOffset) {
-                            changed |= destO->addPointsTo(Offset::UNKNOWN,
-                                                          src.second);
-                            continue;
-                        }
-
-                        Offset newOff = *src.first - *srcOffset + *destOffset;
-                        if (newOff >= destO->node->getSize() ||
-                            newOff >= options.fieldSensitivity) {
-                            changed |= destO->addPointsTo(Offset::UNKNOWN,
-                                                          src.second);
-                        } else {
-                            changed |= destO->addPointsTo(newOff, src.second);
-                        }
-                    } else {
-                        changed |=
-                                destO->addPointsTo(Offset::UNKNOWN, src.second);
-                    }
+            // copying inside one object adds entries to the object
+            // that we iterate over, so work with a copy of it
+            MemoryObject tmpObject;
+            const MemoryObject *srcO = so;
+            if (so == destO) {
+                tmpObject = *so;
+                srcO = &tmpObject;
+            }
+
+            // the pointers on unknown offset may be anywhere
+            // in the copied memory
+            auto unknownIt = srcO->find(Offset::UNKNOWN);
+            if (unknownIt != srcO->end())
+                changed |= addPointsTo(node, destO, Offset::UNKNOWN,
+                                       unknownIt->second);
+
+            // the pointers on known offsets inbound of the copied memory
+            // (all of them if we copy from unknown offset)
+            auto range = srcO->getRange(srcOffset, len);
+            for (auto it = range.first; it != range.second; ++it) {
+                const Offset &off = it->first;
+                const PointsToSetT &ptrs = it->second;
+
+                // copy the pointer, but shift it by the offsets
+                // we are working with
+                if (srcOffset.isUnknown() || destOffset.isUnknown()) {
+                    changed |= addPointsTo(node, destO, Offset::UNKNOWN, ptrs);
+                    continue;
+                }
+
+                // check that new offset does not overflow
+                // Offset::UNKNOWN
+                if (Offset::UNKNOWN - *destOffset <= *off - *srcOffset) {
+                    changed |= addPointsTo(node, destO, Offset::UNKNOWN, ptrs);
+                    continue;
+                }
+
+                Offset newOff = *off - *srcOffset + *destOffset;
+                if (newOff >= destO->node->getSize() ||
+                    newOff >= options.fieldSensitivity) {
+                    changed |= addPointsTo(node, destO, Offset::UNKNOWN, ptrs);
+                } else {
+                    changed |= addPointsTo(node, destO, newOff, ptrs);
                 }
             }
         }
@@ -269,13 +410,55 @@ bool PointerAnalysis::processMemcpy(std::vector<MemoryObject *> &srcObjects,
     return changed;
 }
 
+bool PointerAnalysis::processStore(PSNode *node) {
+    bool changed = false;
+    std::vector<MemoryObject *> objects;
+
+    PSNode *value = node->getOperand(0);
+    PSNode *pointer = node->getOperand(1);
+    // the stored values and the targets that we have not seen yet
+    const PointsToSetT *newValues = getNewPointers(node, 0);
+    const PointsToSetT *newTargets = getNewPointers(node, 1);
+
+    const auto &targets = getPointsTo(pointer);
+    for (const Pointer &ptr : targets) {
+        assert(ptr.target && "Got nullptr as target");
+
+        if (!canBeDereferenced(ptr))
+            continue;
+
+        // store all values to new targets
+        // and only the new values to old targets
+        const PointsToSetT *values = &getPointsTo(value);
+        if (newTargets != &targets &&
+            !(newTargets && newTargets->count(ptr) > 0)) {
+            values = newValues;
+        }
+
+        if (!values)
+            continue;
+
+        objects.clear();
+        getMemoryObjects(node, ptr, objects);
+        for (MemoryObject *o : objects) {
+            changed |= addPointsTo(node, o, ptr.offset, *values);
+        }
+    }
+
+    return changed;
+}
+
 bool PointerAnalysis::processGep(PSNode *node) {
     bool changed = false;
 
     PSNodeGep *gep = PSNodeGep::get(node);
     assert(gep && "Non-GEP given");
 
-    for (const Pointer &ptr : gep->getSource()->pointsTo) {
+    const PointsToSetT *newPtrs = getNewPointers(node, 0);
+    if (!newPtrs)
+        return false;
+
+    for (const Pointer &ptr : *newPtrs) {
         Offset::type new_offset;
         if (ptr.offset.isUnknown() || gep->getOffset().isUnknown())
             // set it like this to avoid overflow when adding
@@ -288,9 +471,9 @@ bool PointerAnalysis::processGep(PSNode *node) {
         // to the begining of the memory - therefore make 0 exception
         if ((new_offset == 0 || new_offset < ptr.target->getSize()) &&
             new_offset < *options.fieldSensitivity)
-            changed |= node->addPointsTo(ptr.target, new_offset);
+            changed |= addPointsTo(node, Pointer(ptr.target, new_offset));
         else
-            changed |= node->addPointsTo(ptr.target, Offset::UNKNOWN);
+            changed |= addPointsTo(node, Pointer(ptr.target, Offset::UNKNOWN));
     }
 
     return changed;
@@ -309,19 +492,7 @@ bool PointerAnalysis::processNode(PSNode *node) {
         changed |= processLoad(node);
         break;
     case PSNodeType::STORE:
-        for (const Pointer &ptr : node->getOperand(1)->pointsTo) {
-            assert(ptr.target && "Got nullptr as target");
-
-            if (!canBeDereferenced(ptr))
-                continue;
-
-            objects.clear();
-            getMemoryObjects(node, ptr, objects);
-            for (MemoryObject *o : objects) {
-                changed |= o->addPointsTo(ptr.offset,
-                                          node->getOperand(0)->pointsTo);
-            }
-        }
+        changed |= processStore(node);
         break;
     case PSNodeType::INVALIDATE_OBJECT:
     case PSNodeType::FREE:
@@ -336,7 +507,8 @@ bool PointerAnalysis::processNode(PSNode *node) {
         break;
     case PSNodeType::CAST:
         // cast only copies the pointers
-        changed |= node->addPointsTo(node->getOperand(0)->pointsTo);
+        if (const auto *newPtrs = getNewPointers(node, 0))
+            changed |= addPointsTo(node, *newPtrs);
         break;
     case PSNodeType::CONSTANT:
         // maybe warn? It has no sense to insert the constants into the graph.
@@ -347,14 +519,17 @@ bool PointerAnalysis::processNode(PSNode *node) {
         break;
     case PSNodeType::CALL_RETURN:
         if (options.invalidateNodes) {
-            for (PSNode *op : node->operands) {
-                for (const Pointer &ptr : op->pointsTo) {
+            for (size_t i = 0, e = node->getOperandsNum(); i < e; ++i) {
+                const auto *newPtrs = getNewPointers(node, i);
+                if (!newPtrs)
+                    continue;
+                for (const Pointer &ptr : *newPtrs) {
                     if (!canBeDereferenced(ptr))
                         continue;
                     PSNodeAlloc *target = PSNodeAlloc::get(ptr.target);
                     assert(target && "Target is not memory allocation");
                     if (!target->isHeap() && !target->isGlobal()) {
-                        changed |= node->addPointsTo(INVALIDATED, 0);
+                        changed |= addPointsTo(node, Pointer(INVALIDATED, 0));
                     }
                 }
             }
@@ -364,55 +539,58 @@ bool PointerAnalysis::processNode(PSNode *node) {
         // gather pointers returned from subprocedure - the same way
         // as PHI works
     case PSNodeType::PHI:
-        for (PSNode *op : node->operands)
-            changed |= node->addPointsTo(op->pointsTo);
+        for (size_t i = 0, e = node->getOperandsNum(); i < e; ++i) {
+            if (const auto *newPtrs = getNewPointers(node, i))
+                changed |= addPointsTo(node, *newPtrs);
+        }
         break;
     case PSNodeType::CALL_FUNCPTR:
         // call via function pointer:
         // first gather the pointers that can be used to the
         // call and if something changes, let backend take some action
         // (for example build relevant subgraph)
-        for (const Pointer &ptr : node->getOperand(0)->pointsTo) {
-            // do not add pointers that do not point to functions
-            // (but do not do that when we are looking for invalidated
-            // memory as this may lead to undefined behavior)
-            if (!options.invalidateNodes &&
-                ptr.target->getType() != PSNodeType::FUNCTION)
-                continue;
-            // Functions that have not address taken cannot
-            // be called via a pointer
-            if (!funHasAddressTaken(ptr.target)) {
-                continue;
-            }
-            if (node->addPointsTo(ptr)) {
-                changed = true;
+        if (const auto *newPtrs = getNewPointers(node, 0)) {
+            for (const Pointer &ptr : *newPtrs) {
+                // do not add pointers that do not point to functions
+                // (but do not do that when we are looking for invalidated
+                // memory as this may lead to undefined behavior)
+                if (!options.invalidateNodes &&
+                    ptr.target->getType() != PSNodeType::FUNCTION)
+                    continue;
+                // Functions that have not address taken cannot
+                // be called via a pointer
+                if (!funHasAddressTaken(ptr.target)) {
+                    continue;
+                }
+                if (!addPointsTo(node, ptr))
+                    continue;
 
+                changed = true;
                 if (ptr.isValid() && !ptr.isInvalidated()) {
                     functionPointerCall(node, ptr.target);
                 } else {
                     error(node, "Calling invalid pointer as a function!");
-                    continue;
                 }
             }
         }
         break;
     case PSNodeType::FORK: // FORK works basically the same as FUNCPTR
-        for (const Pointer &ptr : node->getOperand(0)->pointsTo) {
-            // do not add pointers that do not point to functions
-            // (but do not do that when we are looking for invalidated
-            // memory as this may lead to undefined behavior)
-            if (!options.invalidateNodes &&
-                ptr.target->getType() != PSNodeType::FUNCTION)
-                continue;
+        if (const auto *newPtrs = getNewPointers(node, 0)) {
+            for (const Pointer &ptr : *newPtrs) {
+                // do not add pointers that do not point to functions
+                // (but do not do that when we are looking for invalidated
+                // memory as this may lead to undefined behavior)
+                if (!options.invalidateNodes &&
+                    ptr.target->getType() != PSNodeType::FUNCTION)
+                    continue;
+                if (!addPointsTo(node, ptr))
+                    continue;
 
-            if (node->addPointsTo(ptr)) {
                 changed = true;
-
                 if (ptr.isValid() && !ptr.isInvalidated()) {
                     handleFork(node, ptr.target);
                 } else {
                     error(node, "Calling invalid pointer in fork!");
-                    continue;
                 }
             }
         }
@@ -446,6 +624,15 @@ bool PointerAnalysis::processNode(PSNode *node) {
            "BUG: Did not set change but changed points-to sets");
 #endif
 
+    if (options.differencePropagation) {
+        auto &D = getDeltaInfo(node);
+        D.processed = _round;
+        D.operandsNum = node->getOperandsNum();
+    }
+
+    if (_collapseCycles && isCopyNode(node))
+        changed |= detectCycles(node);
+
     return changed;
 }
 
@@ -490,6 +677,12 @@ bool PointerAnalysis::run() {
 
     preprocess();
 
+    _collapseCycles = options.collapseCycles && canCollapseCycles();
+    // collapsing cycles shares points-to sets of nodes
+    // and changes the graph, do not mix it with threads
+    _parallel = options.workers > 1 && canProcessInParallel() &&
+                !_collapseCycles;
+
     // check that the current state of pointer analysis makes sense
     sanityCheck();
 
@@ -533,6 +726,10 @@ bool PointerAnalysis::run() {
     } while (!to_process.empty());
 
     DBG(pta, "Reached fixpoint after " << n << " iterations\n");
+    DBG(pta, "Processed " << _processedNodes << " nodes\n");
+    _iterations = n;
+
+    finalizeCollapsedNodes();
 
     assert(to_process.empty());
     assert(changed.empty());
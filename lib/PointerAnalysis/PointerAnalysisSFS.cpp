@@ -0,0 +1,359 @@
+#include <algorithm>
+
+#include "dg/PointerAnalysis/PointerAnalysisSFS.h"
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace pta {
+
+// the same filter as in the processing of nodes
+static inline bool canBeDereferenced(const Pointer &ptr) {
+    if (!ptr.isValid() || ptr.isInvalidated() || ptr.isUnknown())
+        return false;
+
+    return ptr.target->getType() != PSNodeType::FUNCTION;
+}
+
+static void getTargets(const PSNode *ptrNode, std::vector<PSNode *> &targets) {
+    for (const auto &ptr : ptrNode->pointsTo) {
+        if (canBeDereferenced(ptr))
+            targets.push_back(ptr.target);
+    }
+}
+
+bool PointerAnalysisSFS::defines(PSNode *n, PSNode *target) const {
+    auto it = _definedTargets.find(n);
+    if (it == _definedTargets.end())
+        return false;
+    return std::binary_search(it->second.begin(), it->second.end(), target);
+}
+
+const std::vector<PSNode *> &
+PointerAnalysisSFS::getReachingDefinitions(PSNode *n, PSNode *target) const {
+    static const std::vector<PSNode *> empty;
+
+    auto it = _reachingDefs.find(n);
+    if (it == _reachingDefs.end())
+        return empty;
+    auto dit = it->second.find(target);
+    if (dit == it->second.end())
+        return empty;
+    return dit->second;
+}
+
+PointerAnalysisSFS::MemoryMapT *PointerAnalysisSFS::getOrCreateMM(PSNode *n) {
+    MemoryMapT *mm = n->getData<MemoryMapT>();
+    if (!mm) {
+        mm = createMM();
+        n->setData<MemoryMapT>(mm);
+    }
+    return mm;
+}
+
+void PointerAnalysisSFS::computeMemorySSA() {
+    const auto &nodes = PG->getNodes();
+    const size_t N = nodes.size();
+
+    // The edges along which the memory flows. These are the inverse
+    // of the edges along which PointerAnalysisFS merges memory maps.
+    std::vector<std::vector<PSNode *>> succs(N);
+    for (const auto &nd : nodes) {
+        if (!nd)
+            continue;
+
+        PSNode *n = nd.get();
+        if (!needsMerge(n)) {
+            succs[n->getSinglePredecessor()->getID()].push_back(n);
+            continue;
+        }
+
+        for (PSNode *p : n->predecessors())
+            succs[p->getID()].push_back(n);
+        if (auto *CR = PSNodeCallRet::get(n)) {
+            for (auto *r : CR->getReturns())
+                succs[r->getID()].push_back(n);
+        }
+        if (auto *E = PSNodeEntry::get(n)) {
+            for (auto *c : E->getCallers())
+                succs[c->getID()].push_back(n);
+        }
+    }
+
+    // the root of the entry procedure takes the state of globals
+    PSNode *root = PG->getEntry()->getRoot();
+    for (PSNode *g : PG->getGlobals())
+        succs[g->getID()].push_back(root);
+
+    // gather the nodes that write and read memory objects
+    struct Accesses {
+        std::vector<PSNode *> defs;
+        std::vector<PSNode *> uses;
+    };
+    std::map<PSNode *, Accesses> accesses;
+    std::vector<PSNode *> targets;
+    for (const auto &nd : nodes) {
+        if (!nd)
+            continue;
+
+        PSNode *n = nd.get();
+        targets.clear();
+        if (n->getType() == PSNodeType::LOAD) {
+            getTargets(n->getOperand(0), targets);
+            for (PSNode *t : targets)
+                accesses[t].uses.push_back(n);
+            continue;
+        } else if (n->getType() == PSNodeType::STORE) {
+            getTargets(n->getOperand(1), targets);
+        } else if (auto *M = PSNodeMemcpy::get(n)) {
+            getTargets(M->getSource(), targets);
+            for (PSNode *t : targets)
+                accesses[t].uses.push_back(n);
+            targets.clear();
+            getTargets(M->getDestination(), targets);
+        } else {
+            continue;
+        }
+
+        // definitions
+        if (targets.empty())
+            continue;
+        for (PSNode *t : targets)
+            accesses[t].defs.push_back(n);
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()),
+                      targets.end());
+        _definedTargets[n] = targets;
+    }
+
+    // for every memory object and every its definition, search
+    // the nodes reachable from the definition without passing
+    // another definition of the object
+    std::vector<unsigned> visited(N, 0);
+    std::vector<char> accessing(N, 0);
+    std::vector<PSNode *> stack;
+    unsigned stamp = 0;
+
+    for (auto &it : accesses) {
+        PSNode *target = it.first;
+        auto &A = it.second;
+        for (PSNode *n : A.uses)
+            accessing[n->getID()] = 1;
+        // definitions stop the search
+        for (PSNode *n : A.defs)
+            accessing[n->getID()] = 2;
+
+        for (PSNode *def : A.defs) {
+            ++stamp;
+            assert(stack.empty());
+            stack.insert(stack.end(), succs[def->getID()].begin(),
+                         succs[def->getID()].end());
+
+            while (!stack.empty()) {
+                PSNode *cur = stack.back();
+                stack.pop_back();
+                if (visited[cur->getID()] == stamp)
+                    continue;
+                visited[cur->getID()] = stamp;
+
+                char acc = accessing[cur->getID()];
+                if (acc != 0) {
+                    auto &defs = _reachingDefs[cur][target];
+                    if (defs.empty() || defs.back() != def)
+                        defs.push_back(def);
+                    _defUses[def].push_back(cur);
+                }
+
+                if (acc == 2)
+                    continue;
+
+                stack.insert(stack.end(), succs[cur->getID()].begin(),
+                             succs[cur->getID()].end());
+            }
+        }
+
+        for (PSNode *n : A.uses)
+            accessing[n->getID()] = 0;
+        for (PSNode *n : A.defs)
+            accessing[n->getID()] = 0;
+    }
+
+    size_t edges = 0;
+    for (auto &it : _defUses) {
+        auto &uses = it.second;
+        std::sort(uses.begin(), uses.end());
+        uses.erase(std::unique(uses.begin(), uses.end()), uses.end());
+        edges += uses.size();
+    }
+
+    DBG(pta, "Memory SSA has " << accesses.size() << " objects, "
+                               << _definedTargets.size() << " definitions and "
+                               << edges << " def-use edges");
+    (void) edges;
+}
+
+// Clear the points-to sets that are computed by processing the nodes.
+// The nodes that change the graph (calls via pointers and threads)
+// keep their points-to sets, as the graph was already built
+// in the flow-insensitive stage.
+void PointerAnalysisSFS::resetPointsTo() {
+    for (const auto &nd : PG->getNodes()) {
+        if (!nd)
+            continue;
+
+        switch (nd->getType()) {
+        case PSNodeType::LOAD:
+        case PSNodeType::GEP:
+        case PSNodeType::CAST:
+        case PSNodeType::PHI:
+        case PSNodeType::CALL_RETURN:
+        case PSNodeType::RETURN:
+            nd->pointsTo.clear();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+bool PointerAnalysisSFS::run() {
+    DBG_SECTION_BEGIN(pta, "Running sparse flow-sensitive pointer analysis");
+
+    _stage = Stage::FI;
+    if (!PointerAnalysis::run()) {
+        DBG_SECTION_END(pta, "The flow-insensitive stage did not finish");
+        return false;
+    }
+
+    computeMemorySSA();
+
+    // the memory of the flow-insensitive stage is not needed anymore
+    _fiObjects.clear();
+    resetPointsTo();
+    resetSolverState();
+
+    _stage = Stage::SPARSE;
+    bool ret = PointerAnalysis::run();
+
+    DBG_SECTION_END(pta, "Running sparse flow-sensitive pointer analysis done");
+    return ret;
+}
+
+bool PointerAnalysisSFS::afterProcessed(PSNode *n) {
+    if (_stage == Stage::FI)
+        return false;
+
+    auto it = _definedTargets.find(n);
+    if (it == _definedTargets.end())
+        return false;
+
+    // the same strong update as in PointerAnalysisFS
+    PointsToSetT *overwritten = nullptr;
+    if (n->getType() == PSNodeType::STORE) {
+        if (!pointsToAllocationInLoop(n->getOperand(1)))
+            overwritten = &n->getOperand(1)->pointsTo;
+    }
+
+    // merge the reaching definitions of the memory that the node writes
+    bool changed = false;
+    MemoryMapT *mm = getOrCreateMM(n);
+    for (PSNode *target : it->second) {
+        for (PSNode *def : getReachingDefinitions(n, target)) {
+            MemoryMapT *dm = def->getData<MemoryMapT>();
+            if (!dm)
+                continue;
+            auto I = dm->find(target);
+            if (I != dm->end())
+                changed |= mergeObject(mm, target, I->second, overwritten);
+        }
+    }
+
+    return changed;
+}
+
+void PointerAnalysisSFS::getMemoryObjects(
+        PSNode *where, const Pointer &pointer,
+        std::vector<MemoryObject *> &objects) {
+    PSNode *target = pointer.target;
+
+    if (_stage == Stage::FI) {
+        // the same as PointerAnalysisFI (without preprocessing GEPs)
+        if (target->getType() == PSNodeType::FUNCTION)
+            return;
+
+        auto &mo = _fiObjects[target];
+        if (!mo)
+            mo.reset(new MemoryObject(target));
+        objects.push_back(mo.get());
+        return;
+    }
+
+    MemoryMapT *mm = getOrCreateMM(where);
+    auto I = mm->find(target);
+    if (defines(where, target)) {
+        // the node writes the memory, it has its own version of it
+        // (merged from the reaching definitions in afterProcessed)
+        if (I == mm->end())
+            I = mm->emplace_hint(I, target, new MemoryObject(target));
+    } else {
+        // the node only reads the memory, gather the reaching definitions
+        for (PSNode *def : getReachingDefinitions(where, target)) {
+            MemoryMapT *dm = def->getData<MemoryMapT>();
+            if (!dm)
+                continue;
+            auto DI = dm->find(target);
+            if (DI != dm->end())
+                mergeObject(mm, target, DI->second, nullptr);
+        }
+        I = mm->find(target);
+        if (I == mm->end()) {
+            // as in PointerAnalysisFS, the nodes that can change
+            // the memory (memcpy) always get some object
+            if (!canChangeMM(where))
+                return;
+            I = mm->emplace_hint(I, target, new MemoryObject(target));
+        }
+    }
+
+    // the object may be shared with other memory maps,
+    // writes go through getWritableObject()
+    objects.push_back(const_cast<MemoryObject *>(I->second.get()));
+}
+
+std::vector<PSNode *>
+PointerAnalysisSFS::getNodesToProcess(const std::vector<PSNode *> &changed,
+                                      unsigned expected_num) {
+    if (_stage == Stage::FI)
+        return PointerAnalysis::getNodesToProcess(changed, expected_num);
+
+    // process only the nodes that use the results of the changed nodes
+    std::vector<PSNode *> nodes;
+    const auto &allNodes = PG->getNodes();
+    if (_queued.size() < allNodes.size())
+        _queued.resize(allNodes.size(), 0);
+    ++_queuedStamp;
+
+    auto queue = [&](PSNode *n) {
+        if (_queued[n->getID()] == _queuedStamp)
+            return;
+        _queued[n->getID()] = _queuedStamp;
+        nodes.push_back(n);
+    };
+
+    for (PSNode *n : changed) {
+        // memcpy may read the memory that it writes
+        if (n->getType() == PSNodeType::MEMCPY)
+            queue(n);
+        for (PSNode *user : n->getUsers())
+            queue(user);
+        auto it = _defUses.find(n);
+        if (it != _defUses.end()) {
+            for (PSNode *use : it->second)
+                queue(use);
+        }
+    }
+
+    return nodes;
+}
+
+} // namespace pta
+} // namespace dg
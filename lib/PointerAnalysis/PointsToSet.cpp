@@ -1,25 +1,28 @@
-#include <functional>
-#include <map>
-#include <vector>
+#include <cassert>
 
 #include "dg/PointerAnalysis/PSNode.h"
-#include "dg/PointerAnalysis/Pointer.h"
 #include "dg/PointerAnalysis/PointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/BDDPointsToSet.h"
+#include "dg/PointerAnalysis/PointsToSets/InternedSetsPool.h"
 #include "dg/PointerAnalysis/PointsToSets/LookupTable.h"
 
 namespace dg {
-namespace pta {
 
-std::vector<PSNode *> SeparateOffsetsPointsToSet::idVector;
-std::vector<PSNode *> SmallOffsetsPointsToSet::idVector;
-std::vector<PSNode *> AlignedSmallOffsetsPointsToSet::idVector;
-std::vector<Pointer> AlignedPointerIdPointsToSet::idVector;
-std::map<PSNode *, size_t> SeparateOffsetsPointsToSet::ids;
-dg::PointerIDLookupTable PointerIdPointsToSet::lookupTable;
-std::map<PSNode *, size_t> SmallOffsetsPointsToSet::ids;
-std::map<PSNode *, size_t> AlignedSmallOffsetsPointsToSet::ids;
-std::map<Pointer, size_t> AlignedPointerIdPointsToSet::ids;
+PointerIDLookupTable *getPointerIDs(const pta::PSNode *node) {
+    assert(node->getPointerIDs() && "The node is not in any graph");
+    return node->getPointerIDs();
+}
 
-} // namespace pta
+ADT::BDDManager &getSpecialBDDs() {
+    // the sets of the static special nodes are released
+    // after the static objects are destroyed
+    static auto *manager = new ADT::BDDManager(/* concurrent = */ true);
+    return *manager;
+}
+
+InternedSetsPool &getSpecialInternedSets() {
+    static InternedSetsPool pool(/* concurrent = */ true);
+    return pool;
+}
 
 } // namespace dg
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "dg/PointerAnalysis/PointerAnalysis.h"
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace pta {
+
+///
+// Number the nodes such that strongly connected components of the
+// interprocedural graph are in topological order and nodes inside
+// of a component are ordered by the time of DFS discovery (so the
+// entry of a loop goes before the rest of the loop).
+// The SCCs are computed by iterative Tarjan's algorithm,
+// the graphs can be really big.
+void PointerAnalysis::computePriorities() {
+    const auto nodesNum = PG->getNodes().size();
+    _priorities.assign(nodesNum, std::numeric_limits<unsigned>::max());
+
+    struct Info {
+        unsigned dfsid{0};
+        unsigned lowpt{0};
+        bool onstack{false};
+    };
+
+    std::vector<Info> info(nodesNum);
+    std::vector<PSNode *> stack;
+    // (node, successors of the node, index of the next successor)
+    struct Frame {
+        PSNode *node;
+        std::vector<PSNode *> succs;
+        size_t idx{0};
+
+        Frame(PSNode *n) : node(n) {
+            PointerGraph::foreachSuccessor(
+                    n, true, [this](PSNode *s) { succs.push_back(s); });
+        }
+    };
+    std::vector<Frame> dfs;
+    // SCCs in the reverse topological order
+    std::vector<std::vector<PSNode *>> sccs;
+    unsigned index = 0;
+
+    auto visit = [&](PSNode *n) {
+        auto &I = info[n->getID()];
+        I.dfsid = I.lowpt = ++index;
+        I.onstack = true;
+        stack.push_back(n);
+        dfs.emplace_back(n);
+    };
+
+    visit(PG->getEntry()->getRoot());
+    while (!dfs.empty()) {
+        auto &frame = dfs.back();
+        PSNode *cur = frame.node;
+
+        if (frame.idx < frame.succs.size()) {
+            PSNode *succ = frame.succs[frame.idx++];
+            const auto &SI = info[succ->getID()];
+            if (SI.dfsid == 0) {
+                visit(succ); // invalidates 'frame'
+            } else if (SI.onstack) {
+                auto &I = info[cur->getID()];
+                I.lowpt = std::min(I.lowpt, SI.dfsid);
+            }
+            continue;
+        }
+
+        dfs.pop_back();
+        const auto &I = info[cur->getID()];
+        if (!dfs.empty()) {
+            auto &PI = info[dfs.back().node->getID()];
+            PI.lowpt = std::min(PI.lowpt, I.lowpt);
+        }
+
+        if (I.lowpt != I.dfsid)
+            continue;
+
+        sccs.emplace_back();
+        auto &scc = sccs.back();
+        PSNode *w;
+        do {
+            w = stack.back();
+            stack.pop_back();
+            info[w->getID()].onstack = false;
+            scc.push_back(w);
+        } while (w != cur);
+    }
+
+    unsigned num = 0;
+    for (auto it = sccs.rbegin(), et = sccs.rend(); it != et; ++it) {
+        auto &scc = *it;
+        std::sort(scc.begin(), scc.end(), [&info](PSNode *a, PSNode *b) {
+            return info[a->getID()].dfsid < info[b->getID()].dfsid;
+        });
+        for (PSNode *n : scc)
+            _priorities[n->getID()] = num++;
+    }
+
+    DBG(pta, "Computed priorities of " << num << " nodes in " << sccs.size()
+                                       << " SCCs");
+}
+
+void PointerAnalysis::sortByPriorities(std::vector<PSNode *> &nodes) {
+    // the graph changed (e.g., we added a function called via a pointer)
+    if (_priorities.size() != PG->getNodes().size())
+        computePriorities();
+
+    auto priority = [this](const PSNode *n) {
+        return n->getID() < _priorities.size()
+                       ? _priorities[n->getID()]
+                       : std::numeric_limits<unsigned>::max();
+    };
+    std::sort(nodes.begin(), nodes.end(),
+              [&priority](const PSNode *a, const PSNode *b) {
+                  auto pa = priority(a);
+                  auto pb = priority(b);
+                  return pa < pb || (pa == pb && a->getID() < b->getID());
+              });
+}
+
+} // namespace pta
+} // namespace dg
@@ -0,0 +1,398 @@
+#include "CDCache.h"
+
+#include <algorithm>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+
+#include "dg/util/debug.h"
+
+namespace dg {
+namespace llvmdg {
+
+static const uint32_t CACHE_MAGIC = 0x44434744; // "DGCD"
+static const uint32_t CACHE_VERSION = 1;
+static const size_t HEADER_SIZE = 16;
+static const size_t INDEX_RECORD_SIZE = 16;
+
+static uint32_t readWord(const char *entry, size_t i) {
+    return llvm::support::endian::read32le(entry + 4 * i);
+}
+
+// the size of the entry in bytes
+static size_t entrySize(const char *entry) {
+    auto values = readWord(entry, 1);
+    return 4 * (3 + values + readWord(entry, 2 + values));
+}
+
+static void writeWord(llvm::raw_ostream &os, uint32_t w) {
+    char buf[4];
+    llvm::support::endian::write32le(buf, w);
+    os.write(buf, sizeof(buf));
+}
+
+static void writeDoubleWord(llvm::raw_ostream &os, uint64_t w) {
+    char buf[8];
+    llvm::support::endian::write64le(buf, w);
+    os.write(buf, sizeof(buf));
+}
+
+static CDCache::ValVec
+queryImpl(LLVMControlDependenceAnalysisImpl &impl, const llvm::Value *v) {
+    if (const auto *B = llvm::dyn_cast<llvm::BasicBlock>(v))
+        return impl.getDependencies(B);
+    return impl.getDependencies(llvm::cast<llvm::Instruction>(v));
+}
+
+CDCache::CDCache(std::string path, LLVMControlDependenceAnalysisOptions opts)
+        : _path(std::move(path)), _options(std::move(opts)) {
+    load();
+}
+
+CDCache::~CDCache() { save(); }
+
+void CDCache::load() {
+    // do not require the null terminator, so that the file is mapped
+#if LLVM_VERSION_MAJOR < 13
+    auto buf = llvm::MemoryBuffer::getFile(_path, /* FileSize = */ -1, false);
+#else
+    auto buf = llvm::MemoryBuffer::getFile(_path, /* IsText = */ false, false);
+#endif
+    if (!buf) {
+        // no cache yet
+        return;
+    }
+
+    const char *data = (*buf)->getBufferStart();
+    size_t size = (*buf)->getBufferSize();
+    auto invalid = [this]() {
+        llvm::errs() << "WARNING: ignoring invalid control dependence cache: "
+                     << _path << "\n";
+        _index.clear();
+    };
+
+    if (size < HEADER_SIZE || readWord(data, 0) != CACHE_MAGIC ||
+        readWord(data, 1) != CACHE_VERSION) {
+        invalid();
+        return;
+    }
+
+    size_t entries = readWord(data, 2);
+    if (size < HEADER_SIZE + entries * INDEX_RECORD_SIZE) {
+        invalid();
+        return;
+    }
+
+    _index.reserve(entries);
+    for (size_t i = 0; i < entries; ++i) {
+        const char *rec = data + HEADER_SIZE + i * INDEX_RECORD_SIZE;
+        _index.emplace_back(llvm::support::endian::read64le(rec),
+                            llvm::support::endian::read64le(rec + 8));
+        if (i > 0 && _index[i - 1].first >= _index[i].first) {
+            invalid();
+            return;
+        }
+    }
+
+    _buffer = std::move(*buf);
+    DBG(cda, "Loaded " << entries << " entries from the CD cache " << _path);
+}
+
+// Hash everything that the control dependencies of the function
+// depend on: the CFG (with the number of instructions in blocks,
+// for the nodes of instructions) and the algorithm.
+uint64_t CDCache::computeKey(const llvm::Function *F) const {
+    std::vector<uint8_t> bytes;
+    auto add = [&bytes](uint64_t w) {
+        uint8_t buf[8];
+        llvm::support::endian::write64le(buf, w);
+        bytes.insert(bytes.end(), buf, buf + sizeof(buf));
+    };
+
+    add(CACHE_VERSION);
+    add(static_cast<uint64_t>(_options.algorithm));
+    add(_options.nodePerInstruction());
+    add(F->size());
+
+    std::unordered_map<const llvm::BasicBlock *, uint64_t> blocks;
+    blocks.reserve(F->size());
+    for (const auto &B : *F) {
+        blocks.emplace(&B, blocks.size());
+    }
+
+    for (const auto &B : *F) {
+        add(B.size());
+        add(std::distance(llvm::succ_begin(&B), llvm::succ_end(&B)));
+        for (const auto *succ : llvm::successors(&B)) {
+            add(blocks[succ]);
+        }
+    }
+
+    return llvm::xxHash64(bytes);
+}
+
+uint64_t CDCache::findEntry(uint64_t key, uint32_t blocks,
+                            uint32_t values) const {
+    auto it = std::lower_bound(_index.begin(), _index.end(),
+                               std::make_pair(key, uint64_t{0}));
+    if (it == _index.end() || it->first != key) {
+        return 0;
+    }
+
+    // check that the entry is sane (and that it is for a function
+    // with the same number of values, if the hash collided)
+    const char *data = _buffer->getBufferStart();
+    size_t size = _buffer->getBufferSize();
+    uint64_t off = it->second;
+    if (off < HEADER_SIZE || off % 4 != 0 || off + 8 > size ||
+        readWord(data + off, 0) != blocks || readWord(data + off, 1) != values)
+        return 0;
+
+    if (off + 4 * (3 + uint64_t{values}) > size)
+        return 0;
+
+    const char *entry = data + off;
+    uint32_t prev = 0;
+    for (uint32_t i = 0; i <= values; ++i) {
+        uint32_t cur = readWord(entry, 2 + i);
+        if (cur < prev)
+            return 0;
+        prev = cur;
+    }
+
+    if (off + entrySize(entry) > size)
+        return 0;
+
+    for (uint32_t i = 0; i < prev; ++i) {
+        if (readWord(entry, 3 + values + i) >= values)
+            return 0;
+    }
+
+    return off;
+}
+
+CDCache::FunctionDeps &CDCache::findFunction(const llvm::Function *F) {
+    auto it = _functions.find(F);
+    if (it != _functions.end()) {
+        return it->second;
+    }
+
+    auto &fun = _functions[F];
+    for (const auto &B : *F) {
+        fun.values.push_back(&B);
+    }
+    for (const auto &B : *F) {
+        for (const auto &I : B) {
+            fun.values.push_back(&I);
+        }
+    }
+    fun.indices.reserve(fun.values.size());
+    for (const auto *v : fun.values) {
+        fun.indices.emplace(v, fun.indices.size());
+    }
+
+    fun.blocks = F->size();
+    fun.key = computeKey(F);
+    if (_buffer) {
+        if (auto off = findEntry(fun.key, fun.blocks, fun.values.size())) {
+            DBG(cda, "Using cached CD of " << F->getName().str());
+            fun.entry = _buffer->getBufferStart() + off;
+            fun.done = true;
+        }
+    }
+
+    return fun;
+}
+
+void CDCache::fillFunction(FunctionDeps &fun,
+                           LLVMControlDependenceAnalysisImpl &impl) {
+    assert(!fun.done && "The entry is already filled");
+    fun.done = true;
+
+    uint32_t blocks = fun.blocks;
+    uint32_t values = fun.values.size();
+
+    // a function with the same CFG was computed in this run
+    auto nit = _newEntries.find(fun.key);
+    if (nit != _newEntries.end()) {
+        const char *entry = nit->second->entry;
+        if (readWord(entry, 0) == blocks && readWord(entry, 1) == values) {
+            fun.entry = entry;
+        }
+        return;
+    }
+
+    std::vector<uint32_t> offsets{0};
+    std::vector<uint32_t> deps;
+    offsets.reserve(values + 1);
+    for (const auto *v : fun.values) {
+        auto vdeps = queryImpl(impl, v);
+        size_t start = deps.size();
+        for (const auto *dep : vdeps) {
+            auto dit = fun.indices.find(dep);
+            if (dit == fun.indices.end()) {
+                // a dependence outside of the function,
+                // we cannot cache it
+                return;
+            }
+            deps.push_back(dit->second);
+        }
+        std::sort(deps.begin() + start, deps.end());
+        deps.erase(std::unique(deps.begin() + start, deps.end()), deps.end());
+        offsets.push_back(deps.size());
+    }
+
+    // store the entry in the format of the file
+    auto &computed = fun.computed;
+    computed.reserve(2 + offsets.size() + deps.size());
+    computed.push_back(blocks);
+    computed.push_back(values);
+    computed.insert(computed.end(), offsets.begin(), offsets.end());
+    computed.insert(computed.end(), deps.begin(), deps.end());
+    for (auto &w : computed) {
+        char buf[4];
+        llvm::support::endian::write32le(buf, w);
+        std::copy(buf, buf + sizeof(buf), reinterpret_cast<char *>(&w));
+    }
+
+    fun.entry = reinterpret_cast<const char *>(computed.data());
+    _newEntries.emplace(fun.key, &fun);
+}
+
+CDCache::FunctionDeps &
+CDCache::getFunction(const llvm::Function *F,
+                     LLVMControlDependenceAnalysisImpl &impl) {
+    auto &fun = findFunction(F);
+    if (!fun.done) {
+        fillFunction(fun, impl);
+    }
+    return fun;
+}
+
+CDCache::ValVec
+CDCache::getDependencies(const llvm::Function *F, const llvm::Value *v,
+                         LLVMControlDependenceAnalysisImpl &impl) {
+    auto &fun = getFunction(F, impl);
+    if (!fun.entry) {
+        return queryImpl(impl, v);
+    }
+
+    auto it = fun.indices.find(v);
+    assert(it != fun.indices.end() && "Value is not in the function");
+
+    auto values = readWord(fun.entry, 1);
+    auto b = readWord(fun.entry, 2 + it->second);
+    auto e = readWord(fun.entry, 3 + it->second);
+    ValVec ret;
+    ret.reserve(e - b);
+    for (auto i = b; i < e; ++i) {
+        auto idx = readWord(fun.entry, 3 + values + i);
+        ret.push_back(const_cast<llvm::Value *>(fun.values[idx]));
+    }
+
+    return ret;
+}
+
+void CDCache::compute(const llvm::Function *F,
+                      LLVMControlDependenceAnalysisImpl &impl) {
+    if (F) {
+        if (!F->isDeclaration())
+            getFunction(F, impl);
+        return;
+    }
+
+    // compute the functions that are not in the file first,
+    // the analysis may compute them in parallel
+    std::vector<const llvm::Function *> missing;
+    for (const auto &f : *impl.getModule()) {
+        if (!f.isDeclaration() && !findFunction(&f).done)
+            missing.push_back(&f);
+    }
+
+    if (missing.empty()) {
+        return;
+    }
+
+    impl.computeFunctions(missing);
+    for (const auto *f : missing) {
+        auto &fun = findFunction(f);
+        if (!fun.done)
+            fillFunction(fun, impl);
+    }
+}
+
+void CDCache::save() const {
+    if (_newEntries.empty()) {
+        return;
+    }
+
+    // the old entries that are still valid and the new entries
+    std::vector<std::pair<uint64_t, const char *>> entries;
+    entries.reserve(_index.size() + _newEntries.size());
+    for (const auto &it : _newEntries) {
+        entries.emplace_back(it.first, it.second->entry);
+    }
+    if (_buffer) {
+        const char *data = _buffer->getBufferStart();
+        size_t size = _buffer->getBufferSize();
+        for (const auto &it : _index) {
+            if (_newEntries.count(it.first) > 0 || it.second + 8 > size)
+                continue;
+            const char *entry = data + it.second;
+            if (findEntry(it.first, readWord(entry, 0), readWord(entry, 1)))
+                entries.emplace_back(it.first, entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    // write a temporary file and rename it, so that the other
+    // processes see either the old or the new cache
+    int fd;
+    llvm::SmallString<128> tmpPath;
+    if (llvm::sys::fs::createUniqueFile(_path + ".tmp-%%%%%%", fd, tmpPath)) {
+        llvm::errs() << "WARNING: failed creating control dependence cache: "
+                     << _path << "\n";
+        return;
+    }
+
+    {
+        llvm::raw_fd_ostream os(fd, /* shouldClose = */ true);
+        writeWord(os, CACHE_MAGIC);
+        writeWord(os, CACHE_VERSION);
+        writeWord(os, entries.size());
+        writeWord(os, 0);
+
+        uint64_t off = HEADER_SIZE + entries.size() * INDEX_RECORD_SIZE;
+        for (const auto &it : entries) {
+            writeDoubleWord(os, it.first);
+            writeDoubleWord(os, off);
+            off += entrySize(it.second);
+        }
+        for (const auto &it : entries) {
+            os.write(it.second, entrySize(it.second));
+        }
+
+        os.close();
+        if (os.has_error()) {
+            os.clear_error();
+            llvm::errs() << "WARNING: failed writing control dependence cache: "
+                         << _path << "\n";
+            llvm::sys::fs::remove(tmpPath);
+            return;
+        }
+    }
+
+    if (llvm::sys::fs::rename(tmpPath, _path)) {
+        llvm::errs() << "WARNING: failed writing control dependence cache: "
+                     << _path << "\n";
+        llvm::sys::fs::remove(tmpPath);
+    }
+}
+
+} // namespace llvmdg
+} // namespace dg
@@ -0,0 +1,108 @@
+#ifndef DG_LLVM_CDCACHE_H_
+#define DG_LLVM_CDCACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include "dg/llvm/ControlDependence/LLVMControlDependenceAnalysisImpl.h"
+
+namespace llvm {
+class MemoryBuffer;
+} // namespace llvm
+
+namespace dg {
+namespace llvmdg {
+
+///
+// Cache of the intraprocedural control dependencies of functions that
+// is kept in a file between runs. The dependencies of a function are
+// stored under a hash of its CFG (and of the options that change the
+// result), so they are reused as long as the CFG of the function does not
+// change, even if the rest of the function or of the module changes.
+//
+// The file is memory-mapped and the dependencies are read directly from
+// it. The dependencies of functions that were not in the file are
+// computed by the given analysis and written to the file (along with
+// the old entries) when the cache is destroyed.
+//
+// The format of the file (all numbers are little-endian):
+//   header:  u32 magic, u32 version, u32 number of entries, u32 unused
+//   index:   (u64 key, u64 offset of the entry) for every entry,
+//            sorted by the keys
+//   entries: u32 number of blocks, u32 number of values (blocks and then
+//            instructions in the order of the function),
+//            u32 offsets[values + 1] to the dependencies,
+//            u32 dependencies[offsets[values]] (indices of values)
+class CDCache {
+  public:
+    using ValVec = LLVMControlDependenceAnalysisImpl::ValVec;
+
+  private:
+    struct FunctionDeps {
+        // the blocks and the instructions of the function, the indices
+        // of these values are stored in the file
+        std::vector<const llvm::Value *> values;
+        std::unordered_map<const llvm::Value *, uint32_t> indices;
+        uint32_t blocks{0};
+        uint64_t key{0};
+        // the entry (in the mapped file or in 'computed')
+        const char *entry{nullptr};
+        // the entry was found or computed (or it cannot be cached)
+        bool done{false};
+        // the entry computed in this run
+        std::vector<uint32_t> computed;
+    };
+
+    const std::string _path;
+    const LLVMControlDependenceAnalysisOptions _options;
+    std::unique_ptr<llvm::MemoryBuffer> _buffer;
+    // the entries that are in the file (key -> offset of the entry)
+    std::vector<std::pair<uint64_t, uint64_t>> _index;
+    // the entries computed in this run
+    std::unordered_map<uint64_t, const FunctionDeps *> _newEntries;
+    std::unordered_map<const llvm::Function *, FunctionDeps> _functions;
+
+    void load();
+    void save() const;
+
+    uint64_t computeKey(const llvm::Function *F) const;
+    // the offset of a valid entry with the key or 0
+    uint64_t findEntry(uint64_t key, uint32_t blocks, uint32_t values) const;
+    // get the function with the entry from the file (if any)
+    FunctionDeps &findFunction(const llvm::Function *F);
+    // create the entry from the results of the analysis
+    void fillFunction(FunctionDeps &fun,
+                      LLVMControlDependenceAnalysisImpl &impl);
+    FunctionDeps &getFunction(const llvm::Function *F,
+                              LLVMControlDependenceAnalysisImpl &impl);
+
+  public:
+    CDCache(std::string path, LLVMControlDependenceAnalysisOptions opts);
+    ~CDCache();
+
+    CDCache(const CDCache &) = delete;
+    CDCache &operator=(const CDCache &) = delete;
+
+    // make sure that the dependencies of the function (or of all
+    // functions if F is nullptr) are in the cache. The functions
+    // that are not in the cache are computed by the analysis at once,
+    // so that it can compute them in parallel.
+    void compute(const llvm::Function *F,
+                 LLVMControlDependenceAnalysisImpl &impl);
+
+    // get the dependencies of a block or an instruction of the function,
+    // either from the file or from the given analysis
+    ValVec getDependencies(const llvm::Function *F, const llvm::Value *v,
+                           LLVMControlDependenceAnalysisImpl &impl);
+};
+
+} // namespace llvmdg
+} // namespace dg
+
+#endif
@@ -22,7 +22,7 @@ namespace llvmdg {
 class StrongControlClosure : public LLVMControlDependenceAnalysisImpl {
     CDGraphBuilder graphBuilder{};
 
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = dg::CDRowsT;
 
     struct Info {
         CDGraph graph;
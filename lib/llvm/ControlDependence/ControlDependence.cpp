@@ -1,4 +1,5 @@
 #include "dg/llvm/ControlDependence/ControlDependence.h"
+#include "llvm/ControlDependence/CDCache.h"
 #include "llvm/ControlDependence/ControlClosure.h"
 #include "llvm/ControlDependence/DOD.h"
 #include "llvm/ControlDependence/InterproceduralCD.h"
@@ -8,6 +9,13 @@
 
 namespace dg {
 
+LLVMControlDependenceAnalysis::LLVMControlDependenceAnalysis(
+        const llvm::Module *module, LLVMControlDependenceAnalysisOptions opts,
+        LLVMPointerAnalysis *pta)
+        : _module(module), _options(std::move(opts)) {
+    initializeImpl(pta);
+}
+
 void LLVMControlDependenceAnalysis::initializeImpl(LLVMPointerAnalysis *pta,
                                                    llvmdg::CallGraph *cg) {
     bool icfg = getOptions().ICFG();
@@ -48,6 +56,31 @@ void LLVMControlDependenceAnalysis::initializeImpl(LLVMPointerAnalysis *pta,
 
     _interprocImpl.reset(
             new llvmdg::LLVMInterprocCD(_module, _options, pta, cg));
+
+    // the cache is keyed by the CFGs of single functions, so we cannot
+    // use it for ICFG, closures, or the legacy NTSCD (which is ICFG)
+    if (!getOptions().cacheFile.empty() && !icfg &&
+        !getOptions().strongCC() && !getOptions().ntscdLegacyCD()) {
+        _cache.reset(new llvmdg::CDCache(getOptions().cacheFile, _options));
+    }
+}
+
+LLVMControlDependenceAnalysis::~LLVMControlDependenceAnalysis() = default;
+
+LLVMControlDependenceAnalysis::ValVec
+LLVMControlDependenceAnalysis::_getCachedDependencies(
+        const llvm::Instruction *I) {
+    return _cache->getDependencies(I->getParent()->getParent(), I, *_impl);
+}
+
+LLVMControlDependenceAnalysis::ValVec
+LLVMControlDependenceAnalysis::_getCachedDependencies(
+        const llvm::BasicBlock *b) {
+    return _cache->getDependencies(b->getParent(), b, *_impl);
+}
+
+void LLVMControlDependenceAnalysis::_computeCached(const llvm::Function *F) {
+    _cache->compute(F, *_impl);
 }
 
 } // namespace dg
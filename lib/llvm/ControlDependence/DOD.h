@@ -6,13 +6,14 @@
 #include "GraphBuilder.h"
 #include "IGraphBuilder.h"
 #include "dg/llvm/ControlDependence/ControlDependence.h"
+#include "dg/util/parallel.h"
 
 #include "ControlDependence/DOD.h"
 #include "ControlDependence/DODNTSCD.h"
 
-#include <map>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace llvm {
 class Function;
@@ -29,7 +30,7 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
     // for each p -> {a, b}, we have (p, a) and (p, b).
     // This has no effect on slicing. If we will need that in the future,
     // we can change this.
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = dg::CDRowsT;
 
     struct Info {
         CDGraph graph;
@@ -76,13 +77,10 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(f);
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(node);
-        if (dit == info->controlDependence.end())
-            return {};
-
+        assert(node->getID() < info->controlDependence.size());
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : info->controlDependence[node->getID()]) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -113,13 +111,10 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(b->getParent());
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(block);
-        if (dit == info->controlDependence.end())
-            return {};
-
+        assert(block->getID() < info->controlDependence.size());
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : info->controlDependence[block->getID()]) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -138,12 +133,26 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         if (F && !F->isDeclaration() && (_getGraph(F) == nullptr)) {
             computeOnDemand(const_cast<llvm::Function *>(F));
         } else {
-            for (const auto &f : *getModule()) {
-                if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
-                    computeOnDemand(const_cast<llvm::Function *>(&f));
-                }
+            std::vector<const llvm::Function *> functions;
+            for (const auto &f : *getModule())
+                functions.push_back(&f);
+            computeFunctions(functions);
+        }
+    }
+
+    void computeFunctions(
+            const std::vector<const llvm::Function *> &functions) override {
+        // build the graphs first, then compute the dependencies
+        // in parallel (see NTSCD::computeFunctions)
+        std::vector<Info *> infos;
+        for (const auto *f : functions) {
+            if (!f->isDeclaration() && (_getGraph(f) == nullptr)) {
+                infos.push_back(&buildGraph(f));
             }
         }
+
+        parallelFor(getOptions().workers, infos.size(),
+                    [&infos, this](size_t i) { computeCD(*infos[i]); }, 1);
     }
 
     CDGraph *getGraph(const llvm::Function *f) override { return _getGraph(f); }
@@ -175,8 +184,7 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         return it == _graphs.end() ? nullptr : &it->second.graph;
     }
 
-    void computeOnDemand(llvm::Function *F) {
-        DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+    Info &buildGraph(const llvm::Function *F) {
         assert(_getGraph(F) == nullptr && "Already have the graph");
 
         auto tmpgraph =
@@ -184,9 +192,16 @@ class DOD : public LLVMControlDependenceAnalysisImpl {
         // FIXME: we can actually just forget the graph if we do not want to
         // dump it to the user
         auto it = _graphs.emplace(F, std::move(tmpgraph));
+        return it.first->second;
+    }
 
-        auto &info = it.first->second;
+    void computeOnDemand(llvm::Function *F) {
+        DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+        computeCD(buildGraph(F));
+    }
 
+    // touches only the given info, so it can run for more functions at once
+    void computeCD(Info &info) const {
         if (getOptions().dodRanganathCD()) {
             dg::DODRanganath dod;
             auto result = dod.compute(info.graph);
@@ -215,7 +230,7 @@ class InterproceduralDOD : public LLVMControlDependenceAnalysisImpl {
     ICDGraphBuilder igraphBuilder{};
     CDGraph graph;
 
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = dg::CDRowsT;
     // forward edges (from branchings to dependent blocks)
     CDResultT controlDependence{};
     // reverse edges (from dependent blocks to branchings)
@@ -250,13 +265,10 @@ class InterproceduralDOD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "CD is not computed");
-        auto dit = controlDependence.find(node);
-        if (dit == controlDependence.end())
-            return {};
-
+        assert(node->getID() < controlDependence.size());
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence[node->getID()]) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -282,13 +294,10 @@ class InterproceduralDOD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "Did not compute CD");
-        auto dit = controlDependence.find(block);
-        if (dit == controlDependence.end())
-            return {};
-
+        assert(block->getID() < controlDependence.size());
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence[block->getID()]) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -6,12 +6,13 @@
 #include "GraphBuilder.h"
 #include "IGraphBuilder.h"
 #include "dg/llvm/ControlDependence/ControlDependence.h"
+#include "dg/util/parallel.h"
 
 #include "ControlDependence/NTSCD.h"
 
-#include <map>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace llvm {
 class Function;
@@ -23,15 +24,24 @@ namespace llvmdg {
 class NTSCD : public LLVMControlDependenceAnalysisImpl {
     CDGraphBuilder graphBuilder{};
 
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = dg::CDRowsT;
 
     struct Info {
         CDGraph graph;
 
         // forward edges (from branchings to dependent blocks)
         CDResultT controlDependence{};
-        // reverse edges (from dependent blocks to branchings)
+        // reverse edges (from dependent blocks to branchings). Until
+        // the dependencies of all nodes are computed, the rows are
+        // incomplete: they contain only the nodes from computedNodes.
         CDResultT revControlDependence{};
+        // the dependencies of all nodes are computed
+        // (and the reverse edges are complete)
+        bool computed{false};
+        // the nodes whose dependencies were computed on demand
+        ADT::SparseBitvector computedNodes{};
+        // keeps the state of the search between on-demand queries
+        dg::NTSCD nodesNTSCD{};
 
         Info(CDGraph &&graph) : graph(std::move(graph)) {}
     };
@@ -53,8 +63,6 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
             return {};
         }
 
-        // XXX: this could be computed on-demand per one node (block)
-        // (in contrary to getDependent())
         const auto *f = I->getParent()->getParent();
         if (_getGraph(f) == nullptr) {
             /// FIXME: get rid of the const cast
@@ -70,13 +78,9 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(f);
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(node);
-        if (dit == info->controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : nodeDependencies(*info, node)) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -94,8 +98,6 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
             return {};
         }
 
-        // XXX: this could be computed on-demand per one node (block)
-        // (in contrary to getDependent())
         if (_getGraph(b->getParent()) == nullptr) {
             /// FIXME: get rid of the const cast
             computeOnDemand(const_cast<llvm::Function *>(b->getParent()));
@@ -109,13 +111,9 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         auto *info = _getFunInfo(b->getParent());
         assert(info && "Did not compute CD");
 
-        auto dit = info->controlDependence.find(block);
-        if (dit == info->controlDependence.end())
-            return {};
-
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = graphBuilder.getValue(dep);
+        for (auto id : nodeDependencies(*info, block)) {
+            const auto *val = graphBuilder.getValue(info->graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -131,15 +129,33 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
     // We run on demand but this method can trigger the computation
     void compute(const llvm::Function *F = nullptr) override {
         DBG(cda, "Triggering computation of all dependencies");
-        if (F && !F->isDeclaration() && (_getGraph(F) == nullptr)) {
-            computeOnDemand(const_cast<llvm::Function *>(F));
+        if (F && !F->isDeclaration() && !_isComputed(F)) {
+            auto *info = _getFunInfo(F);
+            computeCD(info ? *info : buildGraph(F));
         } else {
-            for (const auto &f : *getModule()) {
-                if (!f.isDeclaration() && (_getGraph(&f) == nullptr)) {
-                    computeOnDemand(const_cast<llvm::Function *>(&f));
-                }
+            std::vector<const llvm::Function *> functions;
+            for (const auto &f : *getModule())
+                functions.push_back(&f);
+            computeFunctions(functions);
+        }
+    }
+
+    void computeFunctions(
+            const std::vector<const llvm::Function *> &functions) override {
+        // the graphs are built (and inserted into _graphs) by this
+        // thread, the dependencies in the graphs are then computed
+        // in parallel, every graph by one thread
+        std::vector<Info *> infos;
+        for (const auto *f : functions) {
+            if (f->isDeclaration() || _isComputed(f)) {
+                continue;
             }
+            auto *info = _getFunInfo(f);
+            infos.push_back(info ? info : &buildGraph(f));
         }
+
+        parallelFor(getOptions().workers, infos.size(),
+                    [&infos, this](size_t i) { computeCD(*infos[i]); }, 1);
     }
 
     CDGraph *getGraph(const llvm::Function *f) override { return _getGraph(f); }
@@ -171,8 +187,17 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         return it == _graphs.end() ? nullptr : &it->second.graph;
     }
 
-    void computeOnDemand(llvm::Function *F) {
-        DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+    bool _isComputed(const llvm::Function *f) const {
+        const auto *info = _getFunInfo(f);
+        return info && info->computed;
+    }
+
+    // compute the dependencies of single nodes instead of whole functions
+    bool nodesOnDemand() const {
+        return getOptions().nodesOnDemand && getOptions().ntscdCD();
+    }
+
+    Info &buildGraph(const llvm::Function *F) {
         assert(_getGraph(F) == nullptr && "Already have the graph");
 
         auto tmpgraph =
@@ -180,9 +205,39 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
         // FIXME: we can actually just forget the graph if we do not want to
         // dump it to the user
         auto it = _graphs.emplace(F, std::move(tmpgraph));
+        return it.first->second;
+    }
 
-        auto &info = it.first->second;
+    void computeOnDemand(llvm::Function *F) {
+        DBG(cda, "Triggering on-demand computation for " << F->getName().str());
+        auto &info = buildGraph(F);
+        // the nodes are then computed one by one in nodeDependencies()
+        if (!nodesOnDemand())
+            computeCD(info);
+    }
+
+    // the IDs of the nodes on which the node depends
+    const ADT::SparseBitvector &nodeDependencies(Info &info, CDNode *node) {
+        if (!info.computed && !info.computedNodes.set(node->getID())) {
+            assert(nodesOnDemand());
+            if (info.controlDependence.empty()) {
+                info.controlDependence.resize(info.graph.size() + 1);
+                info.revControlDependence.resize(info.graph.size() + 1);
+            }
+
+            auto deps = info.nodesNTSCD.compute(info.graph, node);
+            for (auto id : deps) {
+                info.revControlDependence[id].set(node->getID());
+            }
+            info.controlDependence[node->getID()].swap(deps);
+        }
 
+        assert(node->getID() < info.controlDependence.size());
+        return info.controlDependence[node->getID()];
+    }
+
+    // touches only the given info, so it can run for more functions at once
+    void computeCD(Info &info) const {
         const auto &opts = getOptions();
         if (opts.ntscd2CD()) {
             DBG(cda, "Using the NTSCD 2 algorithm");
@@ -210,6 +265,8 @@ class NTSCD : public LLVMControlDependenceAnalysisImpl {
             info.controlDependence = std::move(result.first);
             info.revControlDependence = std::move(result.second);
         }
+
+        info.computed = true;
     }
 };
 
@@ -217,7 +274,7 @@ class InterproceduralNTSCD : public LLVMControlDependenceAnalysisImpl {
     ICDGraphBuilder igraphBuilder{};
     CDGraph graph;
 
-    using CDResultT = std::map<CDNode *, std::set<CDNode *>>;
+    using CDResultT = dg::CDRowsT;
     // forward edges (from branchings to dependent blocks)
     CDResultT controlDependence{};
     // reverse edges (from dependent blocks to branchings)
@@ -252,13 +309,10 @@ class InterproceduralNTSCD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "CD is not computed");
-        auto dit = controlDependence.find(node);
-        if (dit == controlDependence.end())
-            return {};
-
+        assert(node->getID() < controlDependence.size());
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence[node->getID()]) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
@@ -284,13 +338,10 @@ class InterproceduralNTSCD : public LLVMControlDependenceAnalysisImpl {
         }
 
         assert(_computed && "Did not compute CD");
-        auto dit = controlDependence.find(block);
-        if (dit == controlDependence.end())
-            return {};
-
+        assert(block->getID() < controlDependence.size());
         std::set<llvm::Value *> ret;
-        for (auto *dep : dit->second) {
-            const auto *val = igraphBuilder.getValue(dep);
+        for (auto id : controlDependence[block->getID()]) {
+            const auto *val = igraphBuilder.getValue(graph.getNode(id));
             assert(val && "Invalid value");
             ret.insert(const_cast<llvm::Value *>(val));
         }
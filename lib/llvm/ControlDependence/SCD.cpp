@@ -7,6 +7,7 @@
 
 #include "dg/ADT/Queue.h"
 #include "dg/util/debug.h"
+#include "dg/util/parallel.h"
 
 using namespace std;
 
@@ -72,7 +73,8 @@ class PostDominanceFrontiers {
     }
 };
 
-void SCD::computePostDominators(llvm::Function &F) {
+void SCD::computePostDominators(llvm::Function &F, BlocksMapT &dependencies,
+                                BlocksMapT &dependentBlocks) {
     DBG_SECTION_BEGIN(cda, "Computing post dominators for function "
                                    << F.getName().str());
     using namespace llvm;
@@ -135,5 +137,45 @@ void SCD::computePostDominators(llvm::Function &F) {
                                  << F.getName().str());
 }
 
+void SCD::computeAll() {
+    std::vector<const llvm::Function *> functions;
+    for (const auto &f : *getModule()) {
+        functions.push_back(&f);
+    }
+    computeFunctions(functions);
+}
+
+void SCD::computeFunctions(const std::vector<const llvm::Function *> &funs) {
+    std::vector<llvm::Function *> functions;
+    for (const auto *f : funs) {
+        if (!f->isDeclaration() && _computed.insert(f).second) {
+            functions.push_back(const_cast<llvm::Function *>(f));
+        }
+    }
+
+    // every thread computes the dependencies of whole functions
+    // into separate maps, the maps are merged afterwards
+    std::vector<BlocksMapT> funDependencies(functions.size());
+    std::vector<BlocksMapT> funDependentBlocks(functions.size());
+    parallelFor(
+            getOptions().workers, functions.size(),
+            [&](size_t i) {
+                computePostDominators(*functions[i], funDependencies[i],
+                                      funDependentBlocks[i]);
+            },
+            1);
+
+    // the blocks of different functions are different,
+    // so the maps do not overlap
+    for (size_t i = 0; i < functions.size(); ++i) {
+        for (auto &it : funDependencies[i]) {
+            dependencies.emplace(it.first, std::move(it.second));
+        }
+        for (auto &it : funDependentBlocks[i]) {
+            dependentBlocks.emplace(it.first, std::move(it.second));
+        }
+    }
+}
+
 } // namespace llvmdg
 } // namespace dg
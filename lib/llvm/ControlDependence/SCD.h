@@ -25,20 +25,29 @@ namespace llvmdg {
 // This class uses purely LLVM, no internal representation
 // like the other classes (we use the post-dominance computation from LLVM).
 class SCD : public LLVMControlDependenceAnalysisImpl {
-    void computePostDominators(llvm::Function &F);
-
-    std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>>
-            dependentBlocks;
-    std::unordered_map<const llvm::BasicBlock *, std::set<llvm::BasicBlock *>>
-            dependencies;
+    using BlocksMapT = std::unordered_map<const llvm::BasicBlock *,
+                                          std::set<llvm::BasicBlock *>>;
+
+    // computes the dependencies of blocks of F into the given maps
+    // (it does not touch the members, so it can run for more functions
+    // at once)
+    static void computePostDominators(llvm::Function &F,
+                                      BlocksMapT &dependencies,
+                                      BlocksMapT &dependentBlocks);
+
+    BlocksMapT dependentBlocks;
+    BlocksMapT dependencies;
     std::set<const llvm::Function *> _computed;
 
     void computeOnDemand(const llvm::Function *F) {
         if (_computed.insert(F).second) {
-            computePostDominators(*const_cast<llvm::Function *>(F));
+            computePostDominators(*const_cast<llvm::Function *>(F),
+                                  dependencies, dependentBlocks);
         }
     }
 
+    void computeAll();
+
   public:
     using ValVec = LLVMControlDependenceAnalysis::ValVec;
 
@@ -74,14 +83,12 @@ class SCD : public LLVMControlDependenceAnalysisImpl {
         if (F && !F->isDeclaration()) {
             computeOnDemand(F);
         } else {
-            for (const auto &f : *getModule()) {
-                if (f.isDeclaration()) {
-                    continue;
-                }
-                computeOnDemand(&f);
-            }
+            computeAll();
         }
     }
+
+    void computeFunctions(
+            const std::vector<const llvm::Function *> &functions) override;
 };
 
 } // namespace llvmdg
@@ -907,6 +907,11 @@ void LLVMDependenceGraph::computeNTSCD(
     dg::LLVMControlDependenceAnalysis ntscd(this->module, opts);
     assert(opts.ntscdCD() || opts.ntscd2CD());
 
+    // with more threads, compute the dependencies of all functions at once
+    // instead of on demand
+    if (opts.workers > 1)
+        ntscd.compute();
+
     for (const auto &it : getConstructedFunctions()) {
         auto &blocks = it.second->getBlocks();
         for (auto &BB : *llvm::cast<llvm::Function>(it.first)) {
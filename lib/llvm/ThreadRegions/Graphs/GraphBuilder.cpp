@@ -558,7 +558,8 @@ GraphBuilder::insertFunctionPointerCall(const CallInst *callInstruction) {
         auto nodeSeq = insertFunction(functions.front(), callInstruction);
         callFuncPtrNode->addSuccessor(nodeSeq.first);
         returnNode = nodeSeq.second;
-        callNode = nodeSeq.first;
+        // the callee may be modelled by other than a call node, e.g. a fork
+        callNode = castNode<NodeType::CALL>(nodeSeq.first);
     } else {
         auto nodeSeq = buildGeneralCallInstruction(callInstruction);
         callFuncPtrNode->addSuccessor(nodeSeq.first);
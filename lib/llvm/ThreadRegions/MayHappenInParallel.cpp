@@ -1,47 +1,49 @@
 #include "dg/llvm/ThreadRegions/MayHappenInParallel.h"
 
-#include <vector>
-
 #include "llvm/ThreadRegions/Nodes/Node.h"
 
-const std::set<const ThreadRegion *> MayHappenInParallel::emptyRegion_ = {};
+const MayHappenInParallel::RegionsSet MayHappenInParallel::emptyRegion_ = {};
 
 MayHappenInParallel::MayHappenInParallel(const ThreadRegion *rootRegion)
         : rootRegion_(rootRegion) {}
 
 void MayHappenInParallel::run() {
-    MHPRelationGraph res = runAnalysis();
-
-    for (auto pair : res) {
-        // the set must exist; it is created in another method
-        mhpInfo_[pair.first].insert(pair.second);
-        mhpInfo_[pair.second].insert(pair.first);
+    numberRegions();
+    runAnalysis();
+
+    // every pair is stored twice, except for the pairs of
+    // a region with itself
+    size_t stored = 0;
+    size_t reflexive = 0;
+    for (unsigned i = 0; i < mhpInfo_.size(); ++i) {
+        stored += mhpInfo_[i].size();
+        reflexive += mhpInfo_[i].get(i);
     }
 
-    relationCount_ = res.size();
+    relationCount_ = (stored + reflexive) / 2;
 }
 
-const std::set<const ThreadRegion *> &
-MayHappenInParallel::parallelRegions(const ThreadRegion *region) {
-    if (mhpInfo_.find(region) == mhpInfo_.end()) {
-        // this is ugly, but it works...
-        return emptyRegion_;
+MayHappenInParallel::RegionsView
+MayHappenInParallel::parallelRegions(const ThreadRegion *region) const {
+    auto it = regionIndex_.find(region);
+    if (it == regionIndex_.end()) {
+        return {regions_, emptyRegion_};
     }
 
-    return mhpInfo_[region];
+    return {regions_, mhpInfo_[it->second]};
 }
 
 void MayHappenInParallel::printEdges(std::ostream &ostream) const {
-    for (const auto &pair : mhpInfo_) {
-        const ThreadRegion *region = pair.first;
-        const std::set<const ThreadRegion *> &successors = pair.second;
+    for (unsigned i = 0; i < mhpInfo_.size(); ++i) {
+        const ThreadRegion *region = regions_[i];
 
-        for (const auto *successor : successors) {
+        for (auto j : mhpInfo_[i]) {
             // we do not want to add the edges twice
-            if (successor < region) {
+            if (j < i) {
                 continue;
             }
 
+            const ThreadRegion *successor = regions_[j];
             ostream << region->firstNode()->dotName() << " -> "
                     << successor->firstNode()->dotName()
                     << " [ltail = " << region->dotName()
@@ -55,57 +57,80 @@ void MayHappenInParallel::printEdges(std::ostream &ostream) const {
 
 size_t MayHappenInParallel::countRelations() const { return relationCount_; }
 
-// these are only the relations which are the immediate consequence of FORKs
-MayHappenInParallel::MHPRelationGraph
-MayHappenInParallel::findInitialMHP() const {
+void MayHappenInParallel::numberRegions() {
+    regions_.clear();
+    regionIndex_.clear();
+
     std::vector<const ThreadRegion *> worklist = {rootRegion_};
-    std::set<const ThreadRegion *> visited = {rootRegion_};
-    MHPRelationGraph res = {};
+    regionIndex_.emplace(rootRegion_, 0);
+    regions_.push_back(rootRegion_);
 
     while (!worklist.empty()) {
         const auto *current = worklist.back();
         worklist.pop_back();
 
-        for (const auto *succ : current->directSuccessors()) {
-            if (visited.find(succ) == visited.end()) {
+        forEachSuccessor(current, [&](const ThreadRegion *succ) {
+            if (regionIndex_.emplace(succ, regions_.size()).second) {
+                regions_.push_back(succ);
                 worklist.push_back(succ);
-                visited.insert(succ);
             }
-        }
+        });
+    }
 
-        // if `current` ends with an interesting call, it also has
-        // forked successors
-        for (const auto *forkSucc : current->forkedSuccessors()) {
-            for (const auto *succ : current->directSuccessors()) {
-                res.insert(createMHPPair(succ, forkSucc));
-            }
-        }
+    mhpInfo_.clear();
+    mhpInfo_.resize(regions_.size());
+}
 
-        const auto *callSucc = current->interestingCallSuccessor();
+std::vector<MayHappenInParallel::RegionsSet>
+MayHappenInParallel::computeSuccessorsClosure() const {
+    std::vector<RegionsSet> closure(regions_.size());
+    for (unsigned i = 0; i < regions_.size(); ++i) {
+        closure[i].set(i);
+    }
 
-        if (callSucc != nullptr && visited.find(callSucc) == visited.end()) {
-            if (!current->forkedSuccessors().empty()) {
-                worklist.push_back(current->interestingCallSuccessor());
-                visited.insert(current->interestingCallSuccessor());
-            }
+    // the successors are mostly found after their predecessors,
+    // so go from the last region
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (unsigned i = regions_.size(); i > 0; --i) {
+            auto &current = closure[i - 1];
+            forEachSuccessor(regions_[i - 1], [&](const ThreadRegion *succ) {
+                auto idx = regionIndex_.find(succ)->second;
+                if (idx != i - 1) {
+                    changed |= current.set(closure[idx]);
+                }
+            });
         }
     }
 
-    return res;
+    return closure;
 }
 
-MayHappenInParallel::MHPRelationGraph MayHappenInParallel::runAnalysis() const {
-    auto mhp = findInitialMHP();
-    std::vector<MHPPair> worklist;
-
-    worklist.insert(worklist.end(), mhp.begin(), mhp.end());
+void MayHappenInParallel::addForkPairs(unsigned region,
+                                       std::vector<MHPPair> &pairs) const {
+    const auto *current = regions_[region];
+    for (const auto *forkSucc : current->forkedSuccessors()) {
+        for (const auto *succ : current->directSuccessors()) {
+            pairs.emplace_back(regionIndex_.find(succ)->second,
+                               regionIndex_.find(forkSucc)->second);
+        }
+    }
+}
 
-    auto updateMHPGraph = [&](const ThreadRegion *first,
-                              const ThreadRegion *second) {
-        auto pair = createMHPPair(first, second);
-        if (mhp.find(pair) == mhp.end()) {
-            mhp.insert(pair);
-            worklist.push_back(pair);
+// these are only the relations which are the immediate consequence of FORKs
+std::vector<MayHappenInParallel::MHPPair>
+MayHappenInParallel::findInitialMHP() const {
+    std::vector<unsigned> worklist = {0};
+    std::vector<bool> visited(regions_.size());
+    visited[0] = true;
+    std::vector<MHPPair> res;
+
+    auto visit = [&](const ThreadRegion *region) {
+        auto idx = regionIndex_.find(region)->second;
+        if (!visited[idx]) {
+            worklist.push_back(idx);
+            visited[idx] = true;
         }
     };
 
@@ -113,34 +138,59 @@ MayHappenInParallel::MHPRelationGraph MayHappenInParallel::runAnalysis() const {
         auto current = worklist.back();
         worklist.pop_back();
 
-        const auto *first = current.first;
-        const auto *second = current.second;
+        const auto *region = regions_[current];
+        for (const auto *succ : region->directSuccessors()) {
+            visit(succ);
+        }
 
-        for (int i = 0; i < 2; i++) {
-            for (const auto *succ : first->directSuccessors()) {
-                updateMHPGraph(succ, second);
+        // if `current` ends with an interesting call, it also has
+        // forked successors
+        addForkPairs(current, res);
 
-                for (const auto *forkSucc : first->forkedSuccessors()) {
-                    updateMHPGraph(succ, forkSucc);
-                }
-            }
+        const auto *callSucc = region->interestingCallSuccessor();
+        if (callSucc != nullptr && !region->forkedSuccessors().empty()) {
+            visit(callSucc);
+        }
+    }
 
-            for (const auto *callSucc : first->calledSuccessors()) {
-                updateMHPGraph(callSucc, second);
-            }
+    return res;
+}
 
-            const auto *interestingSucc = first->interestingCallSuccessor();
-            if (interestingSucc != nullptr) {
-                updateMHPGraph(interestingSucc, second);
-            }
+// If two regions may happen in parallel, then also all the regions
+// to which they propagate the MHP information may happen in parallel.
+// So a pair of regions makes all pairs from the closures of their
+// successors parallel and the closures are added as whole sets.
+// Moreover, the successors of a region that is parallel with any region
+// are parallel with the threads forked at the end of the region.
+void MayHappenInParallel::runAnalysis() {
+    auto closure = computeSuccessorsClosure();
+    auto worklist = findInitialMHP();
+    std::vector<bool> forkPairsAdded(regions_.size());
+
+    auto addParallel = [&](unsigned region, const RegionsSet &regions) {
+        mhpInfo_[region].set(regions);
+        if (!forkPairsAdded[region]) {
+            forkPairsAdded[region] = true;
+            addForkPairs(region, worklist);
+        }
+    };
 
-            for (const auto *succ : first->forkedSuccessors()) {
-                updateMHPGraph(succ, second);
-            }
+    while (!worklist.empty()) {
+        auto current = worklist.back();
+        worklist.pop_back();
 
-            std::swap(first, second);
+        // the closures of the pair were already added
+        if (mhpInfo_[current.first].get(current.second)) {
+            continue;
         }
-    }
 
-    return mhp;
+        const auto &first = closure[current.first];
+        const auto &second = closure[current.second];
+        for (auto region : first) {
+            addParallel(region, second);
+        }
+        for (auto region : second) {
+            addParallel(region, first);
+        }
+    }
 }
@@ -1,12 +1,26 @@
 #include "dg/llvm/ValueRelations/RelationsAnalyzer.h"
+#include "dg/util/parallel.h"
 
 #include <algorithm>
+#include <mutex>
+#include <set>
+#include <unordered_map>
 
 namespace dg {
 namespace vr {
 
 using V = ValueRelations::V;
 
+// Creating a constant modifies the LLVMContext, which is shared
+// by the functions that may be analyzed at once
+static std::mutex constantsMutex;
+
+static const llvm::Constant *getSignedConstant(llvm::Type *type,
+                                               int64_t value) {
+    std::lock_guard<std::mutex> lock(constantsMutex);
+    return llvm::ConstantInt::getSigned(type, value);
+}
+
 // ********************** points to invalidation ********************** //
 bool RelationsAnalyzer::isIgnorableIntrinsic(llvm::Intrinsic::ID id) {
     switch (id) {
@@ -277,7 +291,7 @@ void solveNonConstants(ValueRelations &graph,
     if (opcode != llvm::Instruction::Sub)
         return;
 
-    const llvm::Constant *zero = llvm::ConstantInt::getSigned(op->getType(), 0);
+    const llvm::Constant *zero = getSignedConstant(op->getType(), 0);
     V fst = op->getOperand(0);
     V snd = op->getOperand(1);
 
@@ -419,8 +433,7 @@ bool RelationsAnalyzer::canShift(const ValueRelations &graph, V param,
         for (const auto *val : graph.getEqual(paramInst)) {
             if (const auto *arg = llvm::dyn_cast<llvm::Argument>(val)) {
                 if (arg->getType()->isIntegerTy()) {
-                    const auto *zero =
-                            llvm::ConstantInt::get(arg->getType(), 0);
+                    const auto *zero = getSignedConstant(arg->getType(), 0);
                     if (graph.are(arg, Relations::NE, zero))
                         structure.addPrecondition(
                                 thisFun, arg, Relations::getNonStrict(shift),
@@ -475,7 +488,7 @@ void RelationsAnalyzer::solveDifferent(ValueRelations &graph,
             int64_t intC = boundC.first->getSExtValue();
             intC += shift == Relations::SLT ? 1 : -1;
             const auto *newBound =
-                    llvm::ConstantInt::get(boundC.first->getType(), intC, true);
+                    getSignedConstant(boundC.first->getType(), intC);
             graph.set(op, Relations::getNonStrict(shift), newBound);
         }
     }
@@ -506,8 +519,7 @@ void RelationsAnalyzer::opGen(ValueRelations &graph,
 void RelationsAnalyzer::remGen(ValueRelations &graph,
                                const llvm::BinaryOperator *rem) {
     assert(rem);
-    const llvm::Constant *zero =
-            llvm::ConstantInt::getSigned(rem->getType(), 0);
+    const llvm::Constant *zero = getSignedConstant(rem->getType(), 0);
 
     if (!graph.isLesserEqual(zero, rem->getOperand(0)))
         return;
@@ -1270,66 +1282,143 @@ void RelationsAnalyzer::processOperation(VRLocation *source, VRLocation *target,
     }
 }
 
-bool RelationsAnalyzer::passFunction(const llvm::Function &function,
-                                     __attribute__((unused)) bool print) {
-    bool changed = false;
+bool RelationsAnalyzer::processLocation(VRLocation &location) {
+    if (location.predsSize() > 1) {
+        mergeRelations(location);
+        mergeRelationsByPointedTo(location);
+    } else if (location.predsSize() == 1) {
+        VREdge *edge = location.getPredEdge(0);
+        processOperation(edge->source, edge->target, edge->op.get());
+    } // else no predecessors => nothing to be passed
+
+    ++processedLocations;
+    return location.relations.unsetChanged();
+}
 
+unsigned RelationsAnalyzer::analyzeFunction(const llvm::Function &function,
+                                            unsigned maxPass) {
+    // the locations in the order in which a pass over the function
+    // visits them
+    std::vector<VRLocation *> order;
+    std::unordered_map<const VRLocation *, unsigned> index;
     for (auto it = codeGraph.lazy_dfs_begin(function);
          it != codeGraph.lazy_dfs_end(); ++it) {
-        VRLocation &location = *it;
-#ifndef NDEBUG
-        const bool cond = location.id == 91;
-        if (print && cond) {
-            std::cerr << "LOCATION " << location.id << "\n";
-            for (unsigned i = 0; i < location.predsSize(); ++i) {
-                std::cerr << "pred" << i << " "
-                          << location.getPredEdge(i)->op->toStr() << "\n";
-                std::cerr << location.getPredLocation(i)->relations << "\n";
-            }
-            std::cerr << "before\n" << location.relations << "\n";
-            std::cerr << "inside\n";
-        }
-#endif
-
-        if (location.predsSize() > 1) {
-            mergeRelations(location);
-            mergeRelationsByPointedTo(location);
-        } else if (location.predsSize() == 1) {
-            VREdge *edge = location.getPredEdge(0);
-            processOperation(edge->source, edge->target, edge->op.get());
-        } // else no predecessors => nothing to be passed
+        index.emplace(&*it, order.size());
+        order.push_back(&*it);
+    }
 
-        bool locationChanged = location.relations.unsetChanged();
-#ifndef NDEBUG
-        if (print && cond) {
-            std::cerr << "after\n";
-            if (locationChanged)
-                std::cerr << location.relations;
-            // return false;
+    // Loop joins read also the locations inside of their loops (e.g., the
+    // locations after stores, see getLoopChangeLocations), so they must be
+    // processed again when these locations change.
+    std::unordered_map<const VRLocation *, std::vector<unsigned>> loopReaders;
+    for (unsigned i = 0; i < order.size(); ++i) {
+        if (!order[i]->isJustLoopJoin())
+            continue;
+        for (const auto *inst : structure.getInloopValues(*order[i])) {
+            VRLocation &source = codeGraph.getVRLocation(inst);
+            loopReaders[&source].push_back(i);
+            loopReaders[source.getSuccLocation(0)].push_back(i);
         }
-#endif
-        changed |= locationChanged;
     }
-    return changed;
-}
 
-unsigned RelationsAnalyzer::analyze(unsigned maxPass) {
-    unsigned maxExecutedPass = 0;
+    // A pass processes only the locations that read a changed location.
+    // A change is propagated to the readers that come later in the order
+    // still in the same pass and to the readers that come earlier
+    // in the next pass, like a pass over all locations would do.
+    std::set<unsigned> current;
+    std::set<unsigned> next;
 
-    for (const auto &function : module) {
-        if (function.isDeclaration())
-            continue;
+    auto process = [&](unsigned i) {
+        VRLocation &location = *order[i];
+        if (!processLocation(location))
+            return false;
 
-        bool changed = true;
-        unsigned passNum = 0;
-        while (changed && passNum < maxPass) {
-            changed = passFunction(function, false); // passNum + 1 == maxPass);
-            ++passNum;
+        auto enqueue = [&](unsigned j) {
+            if (j > i)
+                current.insert(j);
+            else
+                next.insert(j);
+        };
+
+        for (unsigned j = 0; j < location.succsSize(); ++j) {
+            auto it = index.find(location.getSuccLocation(j));
+            if (it != index.end())
+                enqueue(it->second);
+        }
+
+        auto rit = loopReaders.find(&location);
+        if (rit != loopReaders.end()) {
+            for (unsigned j : rit->second)
+                enqueue(j);
+        }
+        return true;
+    };
+
+    auto passAll = [&]() {
+        bool changed = false;
+        for (unsigned i = 0; i < order.size(); ++i)
+            changed |= process(i);
+        // all the successors that come later were processed already
+        current.clear();
+        return changed;
+    };
+
+    auto passChanged = [&]() {
+        bool changed = false;
+        while (!current.empty()) {
+            unsigned i = *current.begin();
+            current.erase(current.begin());
+            changed |= process(i);
+        }
+        return changed;
+    };
+
+    unsigned passNum = 0;
+    bool fullPass = true;
+    while (passNum < maxPass) {
+        ++passNum;
+        bool changed = fullPass ? passAll() : passChanged();
+
+        // Joins may change relations of other locations (e.g., the entry
+        // of the function), so the fixpoint must be confirmed by
+        // a pass over all locations. If this pass changed nothing,
+        // the pass over all locations gives the same relations as if
+        // this pass went over all locations, so it is counted as this
+        // pass (and the passes are counted like full passes).
+        if (!fullPass && !changed) {
+            fullPass = true;
+            changed = passAll();
         }
 
-        maxExecutedPass = std::max(maxExecutedPass, passNum);
+        if (fullPass && !changed)
+            break;
+
+        fullPass = next.empty();
+        current.swap(next);
+    }
+
+    return passNum;
+}
+
+unsigned RelationsAnalyzer::analyze(unsigned maxPass, unsigned workers) {
+    std::vector<const llvm::Function *> functions;
+    for (const auto &function : module) {
+        if (!function.isDeclaration())
+            functions.push_back(&function);
     }
 
+    // a function touches only the relations of its own locations
+    // and its own preconditions and border values
+    std::vector<unsigned> executedPasses(functions.size());
+    parallelFor(workers, functions.size(),
+                [&](size_t i) {
+                    executedPasses[i] = analyzeFunction(*functions[i], maxPass);
+                },
+                1);
+
+    unsigned maxExecutedPass = 0;
+    for (unsigned passes : executedPasses)
+        maxExecutedPass = std::max(maxExecutedPass, passes);
     return maxExecutedPass;
 }
 
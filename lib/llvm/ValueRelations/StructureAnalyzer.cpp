@@ -801,15 +801,18 @@ void StructureAnalyzer::addPrecondition(const llvm::Function *func,
                                         const llvm::Argument *lt,
                                         Relations::Type rel,
                                         const llvm::Value *rt) {
+    std::lock_guard<std::mutex> lock(functionInfoMutex);
     preconditionsMap[func].emplace_back(lt, rel, rt);
 }
 
 bool StructureAnalyzer::hasPreconditions(const llvm::Function *func) const {
+    std::lock_guard<std::mutex> lock(functionInfoMutex);
     return preconditionsMap.find(func) != preconditionsMap.end();
 }
 
 const std::vector<Precondition> &
 StructureAnalyzer::getPreconditionsFor(const llvm::Function *func) const {
+    std::lock_guard<std::mutex> lock(functionInfoMutex);
     assert(preconditionsMap.find(func) != preconditionsMap.end());
     return preconditionsMap.find(func)->second;
 }
@@ -817,6 +820,7 @@ StructureAnalyzer::getPreconditionsFor(const llvm::Function *func) const {
 size_t StructureAnalyzer::addBorderValue(const llvm::Function *func,
                                          const llvm::Argument *from,
                                          const llvm::Value *stored) {
+    std::lock_guard<std::mutex> lock(functionInfoMutex);
     auto &borderVals = borderValues[func];
     auto id = borderVals.size();
     borderVals.emplace_back(id, from, stored);
@@ -824,12 +828,14 @@ size_t StructureAnalyzer::addBorderValue(const llvm::Function *func,
 }
 
 bool StructureAnalyzer::hasBorderValues(const llvm::Function *func) const {
+    std::lock_guard<std::mutex> lock(functionInfoMutex);
     return borderValues.find(func) != borderValues.end();
 }
 
 const std::vector<BorderValue> &
 StructureAnalyzer::getBorderValuesFor(const llvm::Function *func) const {
-    assert(hasBorderValues(func));
+    std::lock_guard<std::mutex> lock(functionInfoMutex);
+    assert(borderValues.find(func) != borderValues.end());
     return borderValues.find(func)->second;
 }
 
@@ -5,9 +5,35 @@
 namespace dg {
 namespace vr {
 
+ValueRelations::Data::Data(ValueRelations &owner, const Data &other)
+        : graph(owner, other.graph) {
+    for (const auto &pair : other.valToBucket)
+        valToBucket.emplace_hint(valToBucket.end(), pair.first,
+                                 *graph.getBucket(pair.second.get().id));
+    for (const auto &pair : other.bucketToVals)
+        bucketToVals.emplace_hint(bucketToVals.end(),
+                                  *graph.getBucket(pair.first.get().id),
+                                  pair.second);
+}
+
+ValueRelations::Data &ValueRelations::mut() {
+    if (data.use_count() > 1) {
+        if (!sharedData)
+            sharedData = data;
+        auto copy = std::make_shared<Data>(*this, *data);
+        copy->base = data;
+        copy->baseVersion = data->version;
+        copy->extendsBase = true;
+        data = std::move(copy);
+    }
+    // the data may have been created by other ValueRelations
+    data->graph.setReported(*this);
+    return *data;
+}
+
 // *********************** general between *************************** //
 Relations ValueRelations::_between(Handle lt, Handle rt) const {
-    Relations result = graph.getRelated(lt, allRelations)[rt];
+    Relations result = graph().getRelated(lt, allRelations)[rt];
     if (result.any())
         return result;
     result = _between(lt, getInstance<llvm::ConstantInt>(rt));
@@ -78,8 +104,8 @@ Relations ValueRelations::_between(V lt, size_t rt) const {
 // *************************** iterators ****************************** //
 ValueRelations::rel_iterator
 ValueRelations::begin_related(V val, const Relations &rels) const {
-    assert(valToBucket.find(val) != valToBucket.end());
-    Handle h = valToBucket.find(val)->second;
+    assert(valToBucket().find(val) != valToBucket().end());
+    Handle h = valToBucket().find(val)->second;
     return {*this, h, rels};
 }
 
@@ -89,34 +115,34 @@ ValueRelations::rel_iterator ValueRelations::end_related(V /*val*/) const {
 
 ValueRelations::RelGraph::iterator
 ValueRelations::begin_related(Handle h, const Relations &rels) const {
-    return graph.begin_related(h, rels);
+    return graph().begin_related(h, rels);
 }
 
 ValueRelations::RelGraph::iterator ValueRelations::end_related(Handle h) const {
-    return graph.end_related(h);
+    return graph().end_related(h);
 }
 
 ValueRelations::plain_iterator ValueRelations::begin() const {
-    return {bucketToVals.begin(), bucketToVals.end()};
+    return {bucketToVals().begin(), bucketToVals().end()};
 }
 
 ValueRelations::plain_iterator ValueRelations::end() const {
-    return {bucketToVals.end()};
+    return {bucketToVals().end()};
 }
 
 ValueRelations::RelGraph::iterator
 ValueRelations::begin_buckets(const Relations &rels) const {
-    return graph.begin(rels);
+    return graph().begin(rels);
 }
 
 ValueRelations::RelGraph::iterator ValueRelations::end_buckets() const {
-    return graph.end();
+    return graph().end();
 }
 
 // ****************************** get ********************************* //
 ValueRelations::HandlePtr ValueRelations::maybeGet(V val) const {
-    auto found = valToBucket.find(val);
-    return (found == valToBucket.end() ? nullptr : &found->second.get());
+    auto found = valToBucket().find(val);
+    return (found == valToBucket().end() ? nullptr : &found->second.get());
 }
 
 std::pair<ValueRelations::BRef, bool> ValueRelations::get(size_t id) {
@@ -127,18 +153,18 @@ std::pair<ValueRelations::BRef, bool> ValueRelations::get(size_t id) {
 std::pair<ValueRelations::BRef, bool> ValueRelations::get(V val) {
     if (HandlePtr mh = maybeGet(val))
         return {*mh, false};
-    Handle newH = graph.getNewBucket();
+    Handle newH = graph().getNewBucket();
     return add(val, newH);
 }
 
 ValueRelations::V ValueRelations::getAny(Handle h) const {
-    auto found = bucketToVals.find(h);
-    assert(found != bucketToVals.end() && !found->second.empty());
+    auto found = bucketToVals().find(h);
+    assert(found != bucketToVals().end() && !found->second.empty());
     return *found->second.begin();
 }
 
 ValueRelations::C ValueRelations::getAnyConst(Handle h) const {
-    for (V val : bucketToVals.find(h)->second) {
+    for (V val : bucketToVals().find(h)->second) {
         if (C c = llvm::dyn_cast<BareC>(val))
             return c;
     }
@@ -146,7 +172,7 @@ ValueRelations::C ValueRelations::getAnyConst(Handle h) const {
 }
 
 const VectorSet<ValueRelations::V> &ValueRelations::getEqual(Handle h) const {
-    return bucketToVals.find(h)->second;
+    return bucketToVals().find(h)->second;
 }
 
 VectorSet<ValueRelations::V> ValueRelations::getEqual(V val) const {
@@ -161,7 +187,7 @@ ValueRelations::getDirectlyRelated(V val, const Relations &rels) const {
     HandlePtr mH = maybeGet(val);
     if (!mH)
         return {};
-    RelationsMap related = graph.getRelated(*mH, rels, true);
+    RelationsMap related = graph().getRelated(*mH, rels, true);
 
     std::vector<ValueRelations::V> result;
     std::transform(related.begin(), related.end(), std::back_inserter(result),
@@ -173,7 +199,7 @@ ValueRelations::getDirectlyRelated(V val, const Relations &rels) const {
 
 std::pair<ValueRelations::C, Relations>
 ValueRelations::getBound(Handle h, Relations rels) const {
-    RelationsMap related = graph.getRelated(h, rels);
+    RelationsMap related = graph().getRelated(h, rels);
 
     C resultC = nullptr;
     Relations resultR;
@@ -226,16 +252,20 @@ ValueRelations::HandlePtr ValueRelations::getHandle(V val) const {
 }
 
 // ************************** placeholder ***************************** //
-void ValueRelations::erasePlaceholderBucket(Handle h) {
-    auto found = bucketToVals.find(h);
-    assert(found != bucketToVals.end());
+void ValueRelations::erasePlaceholderBucket(Handle oldH) {
+    mut();
+    Handle h = get(oldH).first;
+    auto found = bucketToVals().find(h);
+    assert(found != bucketToVals().end());
     for (V val : found->second) {
-        assert(valToBucket.find(val) != valToBucket.end() &&
-               valToBucket.at(val) == h);
-        valToBucket.erase(val);
+        assert(valToBucket().find(val) != valToBucket().end() &&
+               valToBucket().at(val) == h);
+        valToBucket().erase(val);
     }
-    bucketToVals.erase(h);
-    graph.erase(h);
+    bucketToVals().erase(h);
+    graph().erase(h);
+    ++data->version;
+    data->extendsBase = false;
 }
 
 // ***************************** other ******************************** //
@@ -268,7 +298,7 @@ Relations ValueRelations::compare(C lt, C rt) {
 }
 
 bool ValueRelations::holdsAnyRelations() const {
-    return !valToBucket.empty() && !graph.empty();
+    return !valToBucket().empty() && !graph().empty();
 }
 
 ValueRelations::HandlePtr
@@ -287,7 +317,7 @@ ValueRelations::getCorresponding(const ValueRelations &other, Handle otherH,
             return nullptr;
 
         Handle h = newPlaceholderBucket(*thisFromH);
-        bool ch = graph.addRelation(*thisFromH, Relations::PT, h);
+        bool ch = graph().addRelation(*thisFromH, Relations::PT, h);
         updateChanged(ch);
         return &h;
     }
@@ -306,7 +336,7 @@ ValueRelations::getCorresponding(const ValueRelations &other, Handle otherH,
             assert(mH);
         }
     }
-    return mH ? mH : &add(otherEqual.any(), graph.getNewBucket()).first.get();
+    return mH ? mH : &add(otherEqual.any(), graph().getNewBucket()).first.get();
 }
 
 ValueRelations::HandlePtr
@@ -324,7 +354,7 @@ ValueRelations::getAndMerge(const ValueRelations &other, Handle otherH) {
 
     size_t borderId = other.getBorderId(otherH);
     if (borderId != std::string::npos)
-        graph.makeBorderBucket(*thisH, borderId);
+        graph().makeBorderBucket(*thisH, borderId);
 
     for (V val : otherEqual)
         add(val, *thisH);
@@ -333,8 +363,33 @@ ValueRelations::getAndMerge(const ValueRelations &other, Handle otherH) {
 }
 
 bool ValueRelations::merge(const ValueRelations &other, Relations relations) {
+    // the relations are shared, there is nothing to merge
+    if (data == other.data)
+        return true;
+    // merging all relations into empty relations gives the same relations,
+    // share them instead of copying
+    if (relations == allRelations && data->graph.empty()) {
+        assert(data->valToBucket.empty());
+        data = other.data;
+        sharedData.reset();
+        changed |= !data->graph.empty();
+        return true;
+    }
+    // other relations were copied from these relations and only new
+    // relations were added to them since then, so the merge would give
+    // the other relations
+    if (relations == allRelations && other.data->extendsBase &&
+        other.data->base.lock() == data &&
+        other.data->baseVersion == data->version) {
+        data = other.data;
+        sharedData.reset();
+        changed = true;
+        return true;
+    }
+
+    mut();
     bool noConflict = true;
-    for (const auto &edge : other.graph) {
+    for (const auto &edge : other.graph()) {
         if (!relations.has(edge.rel()) ||
             (edge.rel() == Relations::EQ && !other.hasEqual(edge.to())))
             continue;
@@ -343,56 +398,59 @@ bool ValueRelations::merge(const ValueRelations &other, Relations relations) {
         HandlePtr thisFromH = getCorresponding(other, edge.from());
 
         if (!thisToH || !thisFromH ||
-            graph.haveConflictingRelation(*thisFromH, edge.rel(), *thisToH)) {
+            graph().haveConflictingRelation(*thisFromH, edge.rel(), *thisToH)) {
             noConflict = false;
             continue;
         }
 
-        bool ch = graph.addRelation(*thisFromH, edge.rel(), *thisToH);
+        bool ch = graph().addRelation(*thisFromH, edge.rel(), *thisToH);
         updateChanged(ch);
     }
     return noConflict;
 }
 
 void ValueRelations::add(V val, Handle h, VectorSet<V> &vals) {
-    ValToBucket::iterator it = valToBucket.lower_bound(val);
+    ValToBucket::iterator it = valToBucket().lower_bound(val);
     // val already bound to a handle
-    if (it != valToBucket.end() && !(valToBucket.key_comp()(val, it->first))) {
+    if (it != valToBucket().end() &&
+        !(valToBucket().key_comp()(val, it->first))) {
         // it is already bound to passed handle
         if (it->second == h)
             return;
         V oldVal = it->first;
         Handle oldH = it->second;
-        assert(bucketToVals.find(oldH) != bucketToVals.end());
-        assert(bucketToVals.at(oldH).find(oldVal) !=
-               bucketToVals.at(oldH).end());
-        bucketToVals.find(oldH)->second.erase(oldVal);
+        assert(bucketToVals().find(oldH) != bucketToVals().end());
+        assert(bucketToVals().at(oldH).find(oldVal) !=
+               bucketToVals().at(oldH).end());
+        bucketToVals().find(oldH)->second.erase(oldVal);
         it->second = h;
+        // the value is not in its old bucket anymore
+        data->extendsBase = false;
     } else
-        valToBucket.emplace_hint(it, val, h);
+        valToBucket().emplace_hint(it, val, h);
 
-    assert(valToBucket.find(val)->second == h);
+    assert(valToBucket().find(val)->second == h);
     vals.emplace(val);
     updateChanged(true);
 }
 
 std::pair<ValueRelations::BRef, bool> ValueRelations::add(V val, Handle h) {
-    add(val, h, bucketToVals[h]);
+    add(val, h, bucketToVals()[h]);
 
     C c = llvm::dyn_cast<BareC>(val);
     if (!c)
         return {h, false};
 
-    for (auto &pair : bucketToVals) {
+    for (auto &pair : bucketToVals()) {
         if (pair.second.empty())
             continue;
 
         Handle otherH = pair.first;
         if (C otherC = getAnyConst(otherH)) {
             if (compare(c, Relations::EQ, otherC)) {
-                graph.addRelation(h, Relations::EQ, otherH);
-                assert(valToBucket.find(val) != valToBucket.end());
-                return {valToBucket.find(val)->second, true};
+                graph().addRelation(h, Relations::EQ, otherH);
+                assert(valToBucket().find(val) != valToBucket().end());
+                return {valToBucket().find(val)->second, true};
             }
         }
     }
@@ -401,23 +459,23 @@ std::pair<ValueRelations::BRef, bool> ValueRelations::add(V val, Handle h) {
 }
 
 void ValueRelations::areMerged(Handle to, Handle from) {
-    VectorSet<V> &toVals = bucketToVals.find(to)->second;
-    assert(bucketToVals.find(from) != bucketToVals.end());
-    const VectorSet<V> fromVals = bucketToVals.find(from)->second;
+    VectorSet<V> &toVals = bucketToVals().find(to)->second;
+    assert(bucketToVals().find(from) != bucketToVals().end());
+    const VectorSet<V> fromVals = bucketToVals().find(from)->second;
 
     for (V val : fromVals)
         add(val, to, toVals);
 
-    assert(bucketToVals.at(from).empty());
-    bucketToVals.erase(from);
+    assert(bucketToVals().at(from).empty());
+    bucketToVals().erase(from);
 }
 
 ValueRelations::HandlePtr ValueRelations::getBorderH(size_t id) const {
-    return graph.getBorderB(id);
+    return graph().getBorderB(id);
 }
 
 size_t ValueRelations::getBorderId(Handle h) const {
-    return graph.getBorderId(h);
+    return graph().getBorderId(h);
 }
 
 std::string strip(std::string str, size_t skipSpaces) {
@@ -435,8 +493,8 @@ std::string strip(std::string str, size_t skipSpaces) {
 
 #ifndef NDEBUG
 void ValueRelations::dump(ValueRelations::Handle h, std::ostream &out) const {
-    auto found = bucketToVals.find(h);
-    assert(found != bucketToVals.end());
+    auto found = bucketToVals().find(h);
+    assert(found != bucketToVals().end());
     const VectorSet<ValueRelations::V> &vals = found->second;
 
     out << "{{ ";
@@ -466,7 +524,7 @@ void ValueRelations::dotDump(std::ostream &out) const {
 }
 
 std::ostream &operator<<(std::ostream &out, const ValueRelations &vr) {
-    for (const auto &edge : vr.graph) {
+    for (const auto &edge : vr.graph()) {
         if (edge.rel() == Relations::EQ) {
             if (!edge.to().hasAnyRelation()) {
                 out << "              ";
@@ -481,7 +539,7 @@ std::ostream &operator<<(std::ostream &out, const ValueRelations &vr) {
         vr.dump(edge.to(), out);
         out << "\n";
     }
-    vr.graph.dumpBorderBuckets(out);
+    vr.graph().dumpBorderBuckets(out);
     return out;
 }
 #endif
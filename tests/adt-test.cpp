@@ -182,3 +182,189 @@ TEST_CASE("TSL Hopscotch collision test", "HashMap") {
     hashCollisionTest<dg::HopscotchHashMap<MyInt, int>>();
 }
 #endif
+
+#include "dg/ADT/BDD.h"
+
+TEST_CASE("BDD sets", "BDD") {
+    using dg::ADT::BDDManager;
+    BDDManager M;
+
+    auto A = M.singleton(5);
+    auto B = M.singleton(1000);
+    auto C = M.singleton(~static_cast<uint64_t>(0));
+    REQUIRE(A == M.singleton(5));
+    REQUIRE(M.contains(A, 5));
+    REQUIRE(!M.contains(A, 4));
+    REQUIRE(M.count(A) == 1);
+
+    auto AB = M.unite(A, B);
+    REQUIRE(AB == M.unite(B, A));
+    REQUIRE(M.count(AB) == 2);
+    REQUIRE(M.contains(AB, 5));
+    REQUIRE(M.contains(AB, 1000));
+    REQUIRE(!M.contains(AB, 1001));
+
+    auto ABC = M.unite(AB, C);
+    REQUIRE(M.count(ABC) == 3);
+    REQUIRE(M.getValues(ABC) ==
+            std::vector<uint64_t>{5, 1000, ~static_cast<uint64_t>(0)});
+    REQUIRE(M.intersect(ABC, AB) == AB);
+    REQUIRE(M.subtract(ABC, C) == AB);
+    REQUIRE(M.subtract(AB, AB) == BDDManager::EMPTY);
+    REQUIRE(M.containsPrefix(ABC, ~static_cast<uint64_t>(0), 1));
+    REQUIRE(!M.containsPrefix(AB, ~static_cast<uint64_t>(0), 1));
+
+    // equal sets are the same BDD
+    BDDManager::BDD S1 = BDDManager::EMPTY;
+    BDDManager::BDD S2 = BDDManager::EMPTY;
+    for (uint64_t i = 0; i < 100; ++i) {
+        S1 = M.unite(S1, M.singleton(i));
+        S2 = M.unite(M.singleton(99 - i), S2);
+    }
+    REQUIRE(S1 == S2);
+    REQUIRE(M.count(S1) == 100);
+    auto values = M.getValues(S1);
+    for (uint64_t i = 0; i < 100; ++i)
+        REQUIRE(values[i] == i);
+}
+
+TEST_CASE("BDD nodes are freed", "BDD") {
+    using dg::ADT::BDDManager;
+    BDDManager M;
+
+    // the set of all numbers with the prefix
+    auto P = M.withPrefix(0xff00000000000000, 8);
+    REQUIRE(M.containsPrefix(P, 0xff00000000000000, 8));
+    REQUIRE(M.contains(P, 0xff00000000000123));
+    REQUIRE(!M.contains(P, 0xfe00000000000123));
+    M.release(P);
+
+    BDDManager::BDD S = BDDManager::EMPTY;
+    for (uint64_t i = 0; i < 100; ++i) {
+        auto single = M.singleton(i * 1000);
+        auto tmp = M.unite(S, single);
+        M.release(single);
+        M.release(S);
+        S = tmp;
+    }
+    M.collectGarbage();
+    auto nodes = M.size();
+
+    // sets that are released do not keep their nodes
+    for (uint64_t i = 0; i < 100; ++i) {
+        auto single = M.singleton(i * 1000 + 1);
+        M.release(M.unite(S, single));
+        M.release(single);
+    }
+    REQUIRE(M.size() > nodes);
+    M.collectGarbage();
+    REQUIRE(M.size() == nodes);
+
+    // the retained set was not freed and the freed nodes are reused
+    REQUIRE(M.count(S) == 100);
+    auto values = M.getValues(S);
+    for (uint64_t i = 0; i < 100; ++i)
+        REQUIRE(values[i] == i * 1000);
+    auto single = M.singleton(7);
+    auto S2 = M.unite(S, single);
+    REQUIRE(M.count(S2) == 101);
+    REQUIRE(M.contains(S2, 7));
+    REQUIRE(M.contains(S2, 99000));
+    M.release(single);
+    M.release(S2);
+    M.release(S);
+    M.collectGarbage();
+    REQUIRE(M.size() == 2);
+}
+
+#include "dg/ADT/SortedVectorMap.h"
+
+TEST_CASE("Sorted vector map", "SortedVectorMap") {
+    dg::ADT::SortedVectorMap<int, int> M;
+    REQUIRE(M.empty());
+
+    M[5] = 50;
+    M[1] = 10;
+    M[3] = 30;
+    REQUIRE(M.size() == 3);
+    REQUIRE(M[3] == 30);
+    REQUIRE(M.size() == 3);
+    REQUIRE(M.count(1) == 1);
+    REQUIRE(M.count(2) == 0);
+    REQUIRE(M.find(4) == M.end());
+    REQUIRE(M.find(5)->second == 50);
+
+    // the entries are sorted by the keys
+    int last = 0;
+    for (const auto &it : M) {
+        REQUIRE(last < it.first);
+        last = it.first;
+    }
+
+    REQUIRE(M.lower_bound(2)->first == 3);
+    REQUIRE(M.lower_bound(3)->first == 3);
+    REQUIRE(M.upper_bound(3)->first == 5);
+    REQUIRE(M.lower_bound(6) == M.end());
+
+    REQUIRE(!M.emplace(1, 11).second);
+    REQUIRE(M[1] == 10);
+    REQUIRE(M.emplace(2, 20).second);
+    REQUIRE(M.size() == 4);
+
+    REQUIRE(M.erase(3) == 1);
+    REQUIRE(M.erase(3) == 0);
+    REQUIRE(M.size() == 3);
+    REQUIRE(M.lower_bound(3)->first == 5);
+}
+
+#include "dg/ADT/SortedVectorSet.h"
+
+TEST_CASE("Sorted vector set", "SortedVectorSet") {
+    dg::ADT::SortedVectorSet<int> S{5, 1, 3};
+    REQUIRE(S.size() == 3);
+    REQUIRE(!S.insert(3).second);
+    REQUIRE(S.insert(2).second);
+    REQUIRE(S.size() == 4);
+    REQUIRE(S.count(2) == 1);
+    REQUIRE(S.count(4) == 0);
+    REQUIRE(S.find(4) == S.end());
+    REQUIRE(*S.find(5) == 5);
+
+    // the elements are sorted
+    int last = 0;
+    for (int x : S) {
+        REQUIRE(last < x);
+        last = x;
+    }
+
+    REQUIRE(S.erase(1) == 1);
+    REQUIRE(S.erase(1) == 0);
+    REQUIRE(S == dg::ADT::SortedVectorSet<int>{2, 3, 5});
+}
+
+#include "dg/ADT/Arena.h"
+
+TEST_CASE("Arena", "Arena") {
+    dg::ADT::Arena arena(64);
+
+    std::vector<uint64_t *> ptrs;
+    for (uint64_t i = 0; i < 100; ++i) {
+        auto *p = arena.create<uint64_t>(i);
+        REQUIRE(reinterpret_cast<uintptr_t>(p) % alignof(uint64_t) == 0);
+        ptrs.push_back(p);
+    }
+    for (uint64_t i = 0; i < 100; ++i) {
+        REQUIRE(*ptrs[i] == i);
+    }
+    // 8 numbers fit into one chunk
+    REQUIRE(arena.chunks() == 13);
+
+    // objects bigger than a chunk get their own chunk
+    auto *big = static_cast<char *>(arena.allocate(1000, 1));
+    big[999] = 1;
+    REQUIRE(arena.chunks() == 14);
+
+    dg::ADT::Arena moved(std::move(arena));
+    REQUIRE(moved.chunks() == 14);
+    REQUIRE(*ptrs[99] == 99);
+}
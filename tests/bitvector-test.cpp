@@ -205,3 +205,33 @@ TEST_CASE("Merge random bitvectors (union)", "SparseBitvector") {
     //    B2.merge(B1);
     //    REQUIRE(B1 == B2);
 }
+
+TEST_CASE("Intersect random bitvectors", "SparseBitvector") {
+    SparseBitvector B1;
+    SparseBitvector B2;
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> distribution(0, 1000);
+
+#undef NUM
+#define NUM 100
+    for (int i = 0; i < NUM; ++i) {
+        B1.set(distribution(generator));
+        B2.set(distribution(generator));
+    }
+
+    auto B1_old = B1;
+    B1.intersect(B2);
+    for (auto x : B1) {
+        REQUIRE(B1_old.get(x));
+        REQUIRE(B2.get(x));
+    }
+    for (auto x : B1_old) {
+        REQUIRE(B1.get(x) == B2.get(x));
+    }
+
+    REQUIRE(!B1.intersect(B2));
+    bool nonempty = !B1.empty();
+    REQUIRE(B1.intersect(SparseBitvector()) == nonempty);
+    REQUIRE(B1.empty());
+}
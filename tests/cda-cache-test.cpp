@@ -0,0 +1,297 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include "llvm/ControlDependence/CDCache.h"
+
+using namespace dg;
+using dg::llvmdg::CDCache;
+
+// Dependencies that depend only on the CFG (as the cached ones must):
+// a block depends on its predecessors and an instruction on its block.
+// Counts what the cache asks for.
+class CFGDependencies : public LLVMControlDependenceAnalysisImpl {
+  public:
+    std::set<const llvm::Function *> computed;
+    unsigned queries{0};
+
+    CFGDependencies(const llvm::Module *M)
+            : LLVMControlDependenceAnalysisImpl(M, {}) {}
+
+    void compute(const llvm::Function *F) override {
+        if (F)
+            computed.insert(F);
+    }
+
+    void computeFunctions(
+            const std::vector<const llvm::Function *> &functions) override {
+        computed.insert(functions.begin(), functions.end());
+    }
+
+    ValVec getDependencies(const llvm::Instruction *I) override {
+        ++queries;
+        return {const_cast<llvm::BasicBlock *>(I->getParent())};
+    }
+
+    ValVec getDependencies(const llvm::BasicBlock *B) override {
+        ++queries;
+        ValVec ret;
+        for (const auto *pred : llvm::predecessors(B))
+            ret.push_back(const_cast<llvm::BasicBlock *>(pred));
+        return ret;
+    }
+
+    ValVec getDependent(const llvm::Instruction * /*unused*/) override {
+        return {};
+    }
+    ValVec getDependent(const llvm::BasicBlock * /*unused*/) override {
+        return {};
+    }
+};
+
+static const char *module1 = R"(
+define void @f(i1 %c) {
+entry:
+  br i1 %c, label %a, label %b
+a:
+  br label %b
+b:
+  ret void
+}
+
+define void @g(i1 %c) {
+entry:
+  br label %loop
+loop:
+  br i1 %c, label %loop, label %end
+end:
+  ret void
+}
+
+define i32 @h(i32 %x) {
+entry:
+  switch i32 %x, label %d [ i32 0, label %d
+                            i32 1, label %e ]
+d:
+  ret i32 0
+e:
+  ret i32 1
+}
+
+declare void @ext()
+)";
+
+// module1 with a changed CFG of @g
+static const char *module2 = R"(
+define void @f(i1 %c) {
+entry:
+  br i1 %c, label %a, label %b
+a:
+  br label %b
+b:
+  ret void
+}
+
+define void @g(i1 %c) {
+entry:
+  br label %loop
+loop:
+  br i1 %c, label %body, label %end
+body:
+  call void @ext()
+  br label %loop
+end:
+  ret void
+}
+
+define i32 @h(i32 %x) {
+entry:
+  switch i32 %x, label %d [ i32 0, label %d
+                            i32 1, label %e ]
+d:
+  ret i32 0
+e:
+  ret i32 1
+}
+
+declare void @ext()
+)";
+
+static std::unique_ptr<llvm::Module> parse(const char *ir,
+                                           llvm::LLVMContext &ctx) {
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(ir, "test"), err, ctx);
+    REQUIRE(M);
+    return M;
+}
+
+static std::string cachePath() {
+    llvm::SmallString<128> path;
+    REQUIRE(!llvm::sys::fs::createTemporaryFile("cda-cache-test", "cache",
+                                                path));
+    llvm::sys::fs::remove(path);
+    return path.str().str();
+}
+
+static std::set<const llvm::Function *>
+definedFunctions(const llvm::Module &M) {
+    std::set<const llvm::Function *> ret;
+    for (const auto &F : M) {
+        if (!F.isDeclaration())
+            ret.insert(&F);
+    }
+    return ret;
+}
+
+static std::set<llvm::Value *> asSet(const std::vector<llvm::Value *> &vec) {
+    return {vec.begin(), vec.end()};
+}
+
+// check that the cache returns the same dependencies as the analysis
+static void checkDependencies(CDCache &cache, CFGDependencies &impl,
+                              const llvm::Module &M) {
+    CFGDependencies reference(&M);
+    for (const auto &F : M) {
+        for (const auto &B : F) {
+            REQUIRE(asSet(cache.getDependencies(&F, &B, impl)) ==
+                    asSet(reference.getDependencies(&B)));
+            for (const auto &I : B) {
+                REQUIRE(asSet(cache.getDependencies(&F, &I, impl)) ==
+                        asSet(reference.getDependencies(&I)));
+            }
+        }
+    }
+}
+
+// the number of entries in the cache file
+static uint32_t cachedEntries(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    std::vector<unsigned char> header(16);
+    f.read(reinterpret_cast<char *>(header.data()), header.size());
+    REQUIRE(f.gcount() == 16);
+    return header[8] | (header[9] << 8) | (header[10] << 16) |
+           (header[11] << 24);
+}
+
+static void fillCache(const std::string &path, const llvm::Module &M) {
+    CFGDependencies impl(&M);
+    CDCache cache(path, impl.getOptions());
+    cache.compute(nullptr, impl);
+    REQUIRE(impl.computed == definedFunctions(M));
+    checkDependencies(cache, impl, M);
+}
+
+TEST_CASE("Cold and warm cache", "CDCache") {
+    llvm::LLVMContext ctx;
+    auto M = parse(module1, ctx);
+    auto path = cachePath();
+
+    fillCache(path, *M);
+    REQUIRE(cachedEntries(path) == 3);
+
+    // the warm cache does not query the analysis at all
+    CFGDependencies impl(M.get());
+    {
+        CDCache cache(path, impl.getOptions());
+        cache.compute(nullptr, impl);
+        REQUIRE(impl.computed.empty());
+        checkDependencies(cache, impl, *M);
+        REQUIRE(impl.queries == 0);
+    }
+
+    llvm::sys::fs::remove(path);
+}
+
+TEST_CASE("Edited function misses the cache", "CDCache") {
+    llvm::LLVMContext ctx;
+    auto M1 = parse(module1, ctx);
+    auto M2 = parse(module2, ctx);
+    auto path = cachePath();
+
+    fillCache(path, *M1);
+
+    {
+        CFGDependencies impl(M2.get());
+        CDCache cache(path, impl.getOptions());
+        cache.compute(nullptr, impl);
+        REQUIRE(impl.computed ==
+                std::set<const llvm::Function *>{M2->getFunction("g")});
+        checkDependencies(cache, impl, *M2);
+    }
+
+    // the old entry of @g is kept along with the new one
+    REQUIRE(cachedEntries(path) == 4);
+    {
+        CFGDependencies impl(M1.get());
+        CDCache cache(path, impl.getOptions());
+        cache.compute(nullptr, impl);
+        REQUIRE(impl.computed.empty());
+        checkDependencies(cache, impl, *M1);
+        REQUIRE(impl.queries == 0);
+    }
+
+    llvm::sys::fs::remove(path);
+}
+
+TEST_CASE("Invalid cache file is ignored", "CDCache") {
+    llvm::LLVMContext ctx;
+    auto M = parse(module1, ctx);
+    auto path = cachePath();
+
+    SECTION("Garbage") {
+        std::ofstream f(path, std::ios::binary);
+        f << "this is not a cache of control dependencies";
+    }
+
+    SECTION("Truncated") {
+        fillCache(path, *M);
+        uint64_t size;
+        REQUIRE(!llvm::sys::fs::file_size(path, size));
+        REQUIRE(truncate(path.c_str(), size - 8) == 0);
+    }
+
+    SECTION("Corrupted dependencies") {
+        fillCache(path, *M);
+        // overwrite the tail (the dependencies of the last entry)
+        // with indices that are out of range
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(-8, std::ios::end);
+        f.write("\xff\xff\xff\xff\xff\xff\xff\xff", 8);
+    }
+
+    {
+        CFGDependencies impl(M.get());
+        CDCache cache(path, impl.getOptions());
+        cache.compute(nullptr, impl);
+        REQUIRE(!impl.computed.empty());
+        checkDependencies(cache, impl, *M);
+    }
+
+    // the cache is rewritten with valid entries
+    REQUIRE(cachedEntries(path) == 3);
+    {
+        CFGDependencies impl(M.get());
+        CDCache cache(path, impl.getOptions());
+        cache.compute(nullptr, impl);
+        REQUIRE(impl.computed.empty());
+        checkDependencies(cache, impl, *M);
+    }
+
+    llvm::sys::fs::remove(path);
+}
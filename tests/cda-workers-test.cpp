@@ -0,0 +1,168 @@
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include "dg/llvm/ControlDependence/ControlDependence.h"
+
+using namespace dg;
+
+// functions with branches, loops and infinite loops,
+// @order has only decisive order dependencies
+// (DOD supports only two-way branching)
+static const char *module = R"(
+define void @diamond(i1 %c) {
+entry:
+  br i1 %c, label %a, label %b
+a:
+  br label %end
+b:
+  br label %end
+end:
+  ret void
+}
+
+define void @loop(i1 %c) {
+entry:
+  br label %loop
+loop:
+  br i1 %c, label %body, label %end
+body:
+  br i1 %c, label %loop, label %end
+end:
+  ret void
+}
+
+define void @infinite(i1 %c) {
+entry:
+  br i1 %c, label %a, label %end
+a:
+  br label %b
+b:
+  br i1 %c, label %a, label %x
+x:
+  br label %b
+end:
+  ret void
+}
+
+define void @nested(i1 %c, i1 %d) {
+entry:
+  br label %outer
+outer:
+  br i1 %c, label %inner, label %end
+inner:
+  br i1 %d, label %inner.body, label %outer.latch
+inner.body:
+  br i1 %c, label %inner, label %exit
+outer.latch:
+  br label %outer
+exit:
+  br label %exit
+end:
+  ret void
+}
+
+define void @twoloops(i1 %c, i1 %d) {
+entry:
+  br i1 %c, label %l1, label %l2
+l1:
+  br i1 %d, label %l2, label %l1
+l2:
+  br i1 %d, label %l1, label %l2
+}
+
+define void @order(i1 %c) {
+entry:
+  br i1 %c, label %a, label %b
+a:
+  br label %b
+b:
+  br label %a
+}
+
+define void @chain(i1 %c) {
+entry:
+  br i1 %c, label %a, label %b
+a:
+  br i1 %c, label %b, label %x
+b:
+  br i1 %c, label %x, label %end
+x:
+  br label %end
+end:
+  ret void
+}
+
+declare void @ext()
+)";
+
+static std::unique_ptr<llvm::Module> parse(llvm::LLVMContext &ctx) {
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(module, "test"), err, ctx);
+    REQUIRE(M);
+    return M;
+}
+
+static std::set<llvm::Value *> asSet(const std::vector<llvm::Value *> &vec) {
+    return {vec.begin(), vec.end()};
+}
+
+// compute the dependencies of all functions with one and with more
+// workers and check that they are the same for every block and instruction
+static void checkWorkers(ControlDependenceAnalysisOptions::CDAlgorithm alg,
+                         bool nodePerInstruction = false) {
+    llvm::LLVMContext ctx;
+    auto M = parse(ctx);
+
+    LLVMControlDependenceAnalysisOptions opts;
+    opts.algorithm = alg;
+    opts.interprocedural = false;
+    opts.setNodePerInstruction(nodePerInstruction);
+
+    LLVMControlDependenceAnalysis sequential(M.get(), opts);
+    sequential.compute();
+
+    opts.setWorkers(4);
+    LLVMControlDependenceAnalysis parallel(M.get(), opts);
+    parallel.compute();
+
+    unsigned dependent = 0;
+    for (const auto &F : *M) {
+        for (const auto &B : F) {
+            auto deps = asSet(sequential.getDependencies(&B));
+            REQUIRE(asSet(parallel.getDependencies(&B)) == deps);
+            dependent += !deps.empty();
+            for (const auto &I : B) {
+                deps = asSet(sequential.getDependencies(&I));
+                REQUIRE(asSet(parallel.getDependencies(&I)) == deps);
+                dependent += !deps.empty();
+            }
+        }
+    }
+    // the functions have some dependencies to compare
+    REQUIRE(dependent > 0);
+}
+
+using CDAlgorithm = ControlDependenceAnalysisOptions::CDAlgorithm;
+
+TEST_CASE("SCD with more workers", "[CDA]") {
+    checkWorkers(CDAlgorithm::STANDARD);
+}
+
+TEST_CASE("NTSCD with more workers", "[CDA]") {
+    checkWorkers(CDAlgorithm::NTSCD);
+    checkWorkers(CDAlgorithm::NTSCD, /* nodePerInstruction = */ true);
+}
+
+TEST_CASE("DOD with more workers", "[CDA]") {
+    checkWorkers(CDAlgorithm::DOD);
+    checkWorkers(CDAlgorithm::DODNTSCD);
+}
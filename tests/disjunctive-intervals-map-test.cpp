@@ -573,3 +573,36 @@ TEST_CASE("Uncovered - regression 1", "DisjunctiveIntervalMap") {
     ret = M.uncovered(0, 3);
     REQUIRE(ret.empty());
 }
+
+TEST_CASE("For each overlapping", "DisjunctiveIntervalMap") {
+    DisjunctiveIntervalMap<int> M;
+    using IntT = decltype(M)::IntervalT;
+
+    std::vector<IntT> visited;
+    auto visit = [&visited](const IntT &I, const std::set<int> &) {
+        visited.push_back(I);
+    };
+
+    M.forEachOverlapping(IntT{0, 10}, visit);
+    REQUIRE(visited.empty());
+
+    M.add(0, 1, 1);
+    M.add(4, 6, 2);
+    M.add(8, 9, 3);
+
+    M.forEachOverlapping(IntT{1, 5}, visit);
+    REQUIRE(visited.size() == 2);
+    REQUIRE(visited[0] == IntT{0, 1});
+    REQUIRE(visited[1] == IntT{4, 6});
+
+    visited.clear();
+    M.forEachOverlapping(IntT{2, 3}, visit);
+    REQUIRE(visited.empty());
+
+    M.forEachOverlapping(IntT{6, 100}, visit);
+    REQUIRE(visited.size() == 2);
+    REQUIRE(visited[0] == IntT{4, 6});
+    REQUIRE(visited[1] == IntT{8, 9});
+
+    REQUIRE(M.gather(1, 8) == std::set<int>{1, 2, 3});
+}
@@ -0,0 +1,310 @@
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include "dg/llvm/ValueRelations/GraphBuilder.h"
+#include "dg/llvm/ValueRelations/GraphElements.h"
+#include "dg/llvm/ValueRelations/RelationsAnalyzer.h"
+#include "dg/llvm/ValueRelations/StructureAnalyzer.h"
+#include "dg/llvm/ValueRelations/ValueRelations.h"
+
+using namespace dg::vr;
+
+// a function whose arguments are used as the values in relations
+static llvm::Function *makeFunction(llvm::Module &M, unsigned args) {
+    auto *i32 = llvm::Type::getInt32Ty(M.getContext());
+    auto *type = llvm::FunctionType::get(
+            i32, std::vector<llvm::Type *>(args, i32), false);
+    return llvm::Function::Create(type, llvm::Function::ExternalLinkage, "f",
+                                  M);
+}
+
+TEST_CASE("merge of changed copy", "ValueRelations") {
+    llvm::LLVMContext ctx;
+    llvm::Module M("test", ctx);
+    llvm::Function *F = makeFunction(M, 5);
+    const llvm::Value *p = F->arg_begin() + 0;
+    const llvm::Value *x = F->arg_begin() + 1;
+    const llvm::Value *y = F->arg_begin() + 2;
+    const llvm::Value *a = F->arg_begin() + 3;
+    const llvm::Value *b = F->arg_begin() + 4;
+
+    ValueRelations base;
+    base.setLesser(x, y);
+    base.setLoad(p, base.newPlaceholderBucket(p));
+
+    // the copy shares the relations of base until it is changed
+    ValueRelations copy;
+    copy.merge(base);
+    copy.setLesser(a, b);
+
+    SECTION("only added relations") {
+        REQUIRE(base.merge(copy));
+        CHECK(base.isLesser(x, y));
+        CHECK(base.isLesser(a, b));
+        CHECK(base.hasLoad(p));
+    }
+
+    SECTION("erased placeholder") {
+        REQUIRE(copy.hasLoad(p));
+        copy.erasePlaceholderBucket(copy.getPointedTo(p));
+        REQUIRE(!copy.hasLoad(p));
+
+        // the merge must not drop the placeholder of base
+        REQUIRE(base.merge(copy));
+        CHECK(base.hasLoad(p));
+        CHECK(base.isLesser(x, y));
+        CHECK(base.isLesser(a, b));
+    }
+
+    SECTION("rebound value") {
+        // x is moved to the bucket of a
+        copy.setEqual(x, a);
+        REQUIRE(copy.isEqual(x, a));
+
+        REQUIRE(base.merge(copy));
+        CHECK(base.isEqual(x, a));
+        CHECK(base.isLesser(x, y));
+        CHECK(base.isLesser(a, b));
+    }
+}
+
+// for (i = 0; i < n; ++i) for (j = 0; j < i; ++j) a[j] = i;
+// as compiled without optimizations
+static const char *nestedLoops = R"(
+define void @nested(i32 %n, i32* %a) {
+entry:
+  %n.addr = alloca i32, align 4
+  %a.addr = alloca i32*, align 8
+  %i = alloca i32, align 4
+  %j = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32* %a, i32** %a.addr, align 8
+  store i32 0, i32* %i, align 4
+  br label %outer.cond
+
+outer.cond:
+  %0 = load i32, i32* %i, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %outer.body, label %outer.end
+
+outer.body:
+  store i32 0, i32* %j, align 4
+  br label %inner.cond
+
+inner.cond:
+  %2 = load i32, i32* %j, align 4
+  %3 = load i32, i32* %i, align 4
+  %cmp1 = icmp slt i32 %2, %3
+  br i1 %cmp1, label %inner.body, label %inner.end
+
+inner.body:
+  %4 = load i32, i32* %i, align 4
+  %5 = load i32*, i32** %a.addr, align 8
+  %6 = load i32, i32* %j, align 4
+  %idx = sext i32 %6 to i64
+  %arrayidx = getelementptr inbounds i32, i32* %5, i64 %idx
+  store i32 %4, i32* %arrayidx, align 4
+  %7 = load i32, i32* %j, align 4
+  %inc = add nsw i32 %7, 1
+  store i32 %inc, i32* %j, align 4
+  br label %inner.cond
+
+inner.end:
+  %8 = load i32, i32* %i, align 4
+  %inc2 = add nsw i32 %8, 1
+  store i32 %inc2, i32* %i, align 4
+  br label %outer.cond
+
+outer.end:
+  ret void
+}
+)";
+
+// x = 0; for (i = 0; i < n; ++i) { if (a[i] > x) x = i; a[i] = x; }
+// as compiled without optimizations, the store to x is in a branch,
+// so it is not on every path to the latch of the loop
+static const char *storeOffLatch = R"(
+define void @offlatch(i32 %n, i32* %a) {
+entry:
+  %n.addr = alloca i32, align 4
+  %a.addr = alloca i32*, align 8
+  %x = alloca i32, align 4
+  %i = alloca i32, align 4
+  store i32 %n, i32* %n.addr, align 4
+  store i32* %a, i32** %a.addr, align 8
+  store i32 0, i32* %x, align 4
+  store i32 0, i32* %i, align 4
+  br label %for.cond
+
+for.cond:
+  %0 = load i32, i32* %i, align 4
+  %1 = load i32, i32* %n.addr, align 4
+  %cmp = icmp slt i32 %0, %1
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %2 = load i32*, i32** %a.addr, align 8
+  %3 = load i32, i32* %i, align 4
+  %idx = sext i32 %3 to i64
+  %arrayidx = getelementptr inbounds i32, i32* %2, i64 %idx
+  %4 = load i32, i32* %arrayidx, align 4
+  %5 = load i32, i32* %x, align 4
+  %cmp1 = icmp sgt i32 %4, %5
+  br i1 %cmp1, label %if.then, label %if.end
+
+if.then:
+  %6 = load i32, i32* %i, align 4
+  store i32 %6, i32* %x, align 4
+  br label %if.end
+
+if.end:
+  %7 = load i32, i32* %x, align 4
+  %8 = load i32*, i32** %a.addr, align 8
+  %9 = load i32, i32* %i, align 4
+  %idx2 = sext i32 %9 to i64
+  %arrayidx2 = getelementptr inbounds i32, i32* %8, i64 %idx2
+  store i32 %7, i32* %arrayidx2, align 4
+  %10 = load i32, i32* %i, align 4
+  %inc = add nsw i32 %10, 1
+  store i32 %inc, i32* %i, align 4
+  br label %for.cond
+
+for.end:
+  ret void
+}
+)";
+
+static std::unique_ptr<llvm::Module> parse(const char *ir,
+                                           llvm::LLVMContext &ctx) {
+    llvm::SMDiagnostic err;
+    auto M = llvm::parseIR(llvm::MemoryBufferRef(ir, "test"), err, ctx);
+    REQUIRE(M);
+    return M;
+}
+
+// the preparations of the analysis of a module
+struct Analysis {
+    VRCodeGraph codeGraph;
+    StructureAnalyzer structure;
+    RelationsAnalyzer analyzer;
+
+    Analysis(const llvm::Module &M)
+            : structure(M, codeGraph), analyzer(M, codeGraph, structure) {
+        GraphBuilder(M, codeGraph).build();
+        structure.analyzeBeforeRelationsAnalysis();
+    }
+};
+
+// the relations between the values of a function in its every location
+using Snapshot = std::map<unsigned, std::vector<Relations>>;
+
+static Snapshot snapshot(const llvm::Module &M, const VRCodeGraph &codeGraph) {
+    Snapshot ret;
+    for (const auto &F : M) {
+        if (F.isDeclaration())
+            continue;
+
+        std::vector<const llvm::Value *> values;
+        for (const auto &arg : F.args())
+            values.push_back(&arg);
+        for (const auto &I : llvm::instructions(F))
+            values.push_back(&I);
+
+        for (auto it = codeGraph.lazy_dfs_begin(F);
+             it != codeGraph.lazy_dfs_end(); ++it) {
+            auto &row = ret[it->id];
+            for (const auto *lt : values) {
+                for (const auto *rt : values)
+                    row.push_back(it->relations.between(lt, rt));
+            }
+        }
+    }
+    return ret;
+}
+
+TEST_CASE("passes over nested loops", "RelationsAnalyzer") {
+    llvm::LLVMContext ctx;
+    auto ir = std::string(nestedLoops) + storeOffLatch;
+    auto M = parse(ir.c_str(), ctx);
+
+    // the reference makes passes over all locations until a pass
+    // does not change the relations between values. The analysis compares
+    // also other parts of the relations (e.g., the loads), so it may need
+    // a few more passes to see the fixpoint, make them too.
+    std::vector<Snapshot> reference;
+    Analysis full(*M);
+    do {
+        full.analyzer.analyze(1);
+        reference.push_back(snapshot(*M, full.codeGraph));
+    } while (reference.size() < 2 ||
+             reference.back() != reference[reference.size() - 2]);
+    const unsigned fullPasses = reference.size() - 1;
+    for (unsigned i = 0; i < 3; ++i) {
+        full.analyzer.analyze(1);
+        reference.push_back(snapshot(*M, full.codeGraph));
+    }
+
+    unsigned finalPasses = 0;
+    for (unsigned maxPass = 1; maxPass <= reference.size(); ++maxPass) {
+        INFO("maxPass " << maxPass);
+        Analysis analysis(*M);
+        unsigned passes = analysis.analyzer.analyze(maxPass);
+        REQUIRE(passes >= std::min(maxPass, fullPasses));
+        if (finalPasses == 0) {
+            REQUIRE(passes <= maxPass);
+            if (passes < maxPass)
+                finalPasses = passes;
+        } else {
+            REQUIRE(passes == finalPasses);
+        }
+        bool sameRelations =
+                snapshot(*M, analysis.codeGraph) == reference[passes - 1];
+        CHECK(sameRelations);
+    }
+    // the analysis reached the fixpoint
+    REQUIRE(finalPasses != 0);
+}
+
+TEST_CASE("analysis with more workers", "RelationsAnalyzer") {
+    // more functions with nested loops that call the first one
+    std::string ir = nestedLoops;
+    for (unsigned i = 0; i < 4; ++i) {
+        auto name = "@nested" + std::to_string(i);
+        auto fun = std::string(nestedLoops);
+        fun.replace(fun.find("@nested"), 7, name);
+        fun.replace(fun.find("  ret void"), 10,
+                    "  call void @nested(i32 %n, i32* %a)\n  ret void");
+        ir += fun;
+    }
+
+    llvm::LLVMContext ctx;
+    auto M = parse(ir.c_str(), ctx);
+
+    Analysis sequential(*M);
+    unsigned passes = sequential.analyzer.analyze(20, 1);
+    auto expected = snapshot(*M, sequential.codeGraph);
+
+    for (unsigned workers : {2, 5}) {
+        INFO("workers " << workers);
+        Analysis parallel(*M);
+        REQUIRE(parallel.analyzer.analyze(20, workers) == passes);
+        REQUIRE(parallel.analyzer.getProcessedLocationsNum() ==
+                sequential.analyzer.getProcessedLocationsNum());
+        bool sameRelations = snapshot(*M, parallel.codeGraph) == expected;
+        CHECK(sameRelations);
+    }
+}
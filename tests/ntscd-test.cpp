@@ -0,0 +1,73 @@
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <set>
+
+#include "dg/util/debug.h"
+
+#include "ControlDependence/NTSCD.h"
+
+using namespace dg;
+
+static std::set<unsigned> asSet(const ADT::SparseBitvector &bv) {
+    std::set<unsigned> ret;
+    for (auto id : bv)
+        ret.insert(id);
+    return ret;
+}
+
+// a graph with the given number of nodes and random edges
+// (with cycles, self-loops and nodes without successors)
+static void generateGraph(CDGraph &graph, unsigned size,
+                          std::default_random_engine &generator) {
+    std::uniform_int_distribution<unsigned> nodes(1, size);
+    std::uniform_int_distribution<unsigned> edges(0, 3);
+
+    for (unsigned i = 0; i < size; ++i)
+        graph.createNode();
+
+    for (auto *nd : graph) {
+        std::set<unsigned> succs;
+        for (unsigned i = edges(generator); i > 0; --i)
+            succs.insert(nodes(generator));
+        for (auto id : succs)
+            graph.addNodeSuccessor(*nd, *graph.getNode(id));
+    }
+}
+
+static void checkSingleNodes(unsigned size, unsigned graphs,
+                             std::default_random_engine &generator) {
+    for (unsigned n = 0; n < graphs; ++n) {
+        CDGraph graph;
+        generateGraph(graph, size, generator);
+
+        auto result = dg::NTSCD().compute(graph);
+
+        // the queries share the state of the search,
+        // so ask for the nodes more than once and in both orders
+        dg::NTSCD ntscd;
+        for (auto *nd : graph) {
+            INFO("graph of " << size << " nodes, node " << nd->getID());
+            REQUIRE(asSet(ntscd.compute(graph, nd)) ==
+                    asSet(result.first[nd->getID()]));
+        }
+        for (unsigned id = size; id > 0; --id) {
+            INFO("graph of " << size << " nodes, node " << id);
+            REQUIRE(asSet(ntscd.compute(graph, graph.getNode(id))) ==
+                    asSet(result.first[id]));
+        }
+    }
+}
+
+TEST_CASE("Dependencies of single nodes", "NTSCD") {
+    std::default_random_engine generator;
+
+    for (unsigned size = 1; size <= 30; ++size) {
+        checkSingleNodes(size, 20, generator);
+    }
+
+    // compute(graph) colors the nodes for 64 targets at once
+    for (unsigned size : {63, 64, 65, 127, 128, 129, 300}) {
+        checkSingleNodes(size, 5, generator);
+    }
+}
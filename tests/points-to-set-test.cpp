@@ -245,11 +245,52 @@ void testSmallOverflowBehavior() { // only works for SmallOffsetsPTSet
     REQUIRE(S.overflowSetSize() == 0);
 }
 
+template <typename PTSetT>
+void separateGraphsTest() {
+    // pointers to special nodes do not need any graph
+    PTSetT S;
+    REQUIRE(S.add(Pointer(NULLPTR, 0)) == true);
+    REQUIRE(S.add(Pointer(UNKNOWN_MEMORY, dg::Offset::UNKNOWN)) == true);
+    REQUIRE(S.hasNull());
+    REQUIRE(S.hasUnknown());
+    REQUIRE(S.size() == 2);
+
+    auto *PS1 = new PointerGraph();
+    PSNode *A = PS1->create<PSNodeType::ALLOC>();
+    PTSetT S1;
+    S1.add(S);
+    REQUIRE(S1.add(Pointer(A, 8)) == true);
+
+    PointerGraph PS2;
+    PSNode *B = PS2.create<PSNodeType::ALLOC>();
+    PTSetT S2;
+    REQUIRE(S2.add(Pointer(B, 8)) == true);
+    S2.add(S);
+
+    // the graphs have their own tables of IDs
+    REQUIRE(PS1->getPointerIDs().size() > 0);
+    REQUIRE(&PS1->getPointerIDs() != &PS2.getPointerIDs());
+    auto size2 = PS2.getPointerIDs().size();
+    delete PS1;
+    REQUIRE(PS2.getPointerIDs().size() == size2);
+
+    REQUIRE(S2.size() == 3);
+    REQUIRE(S2.pointsTo(Pointer(B, 8)));
+    REQUIRE(S2.hasNull());
+    REQUIRE(S2.hasUnknown());
+    for (const auto &ptr : S2) {
+        REQUIRE((ptr.target == B || ptr.target == NULLPTR ||
+                 ptr.target == UNKNOWN_MEMORY));
+    }
+}
+
 TEST_CASE("Querying empty set", "PointsToSet") {
     queryingEmptySet<OffsetsSetPointsToSet>();
     queryingEmptySet<SimplePointsToSet>();
     queryingEmptySet<SeparateOffsetsPointsToSet>();
     queryingEmptySet<PointerIdPointsToSet>();
+    queryingEmptySet<InternedPointsToSet>();
+    queryingEmptySet<BDDPointsToSet>();
     queryingEmptySet<SmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedSmallOffsetsPointsToSet>();
     queryingEmptySet<AlignedPointerIdPointsToSet>();
@@ -260,6 +301,8 @@ TEST_CASE("Add an element", "PointsToSet") {
     addAnElement<SimplePointsToSet>();
     addAnElement<SeparateOffsetsPointsToSet>();
     addAnElement<PointerIdPointsToSet>();
+    addAnElement<InternedPointsToSet>();
+    addAnElement<BDDPointsToSet>();
     addAnElement<SmallOffsetsPointsToSet>();
     addAnElement<AlignedSmallOffsetsPointsToSet>();
     addAnElement<AlignedPointerIdPointsToSet>();
@@ -270,6 +313,8 @@ TEST_CASE("Add few elements", "PointsToSet") {
     addFewElements<SimplePointsToSet>();
     addFewElements<SeparateOffsetsPointsToSet>();
     addFewElements<PointerIdPointsToSet>();
+    addFewElements<InternedPointsToSet>();
+    addFewElements<BDDPointsToSet>();
     addFewElements<SmallOffsetsPointsToSet>();
     addFewElements<AlignedSmallOffsetsPointsToSet>();
     addFewElements<AlignedPointerIdPointsToSet>();
@@ -280,6 +325,8 @@ TEST_CASE("Add few elements 2", "PointsToSet") {
     addFewElements2<SimplePointsToSet>();
     addFewElements2<SeparateOffsetsPointsToSet>();
     addFewElements2<PointerIdPointsToSet>();
+    addFewElements2<InternedPointsToSet>();
+    addFewElements2<BDDPointsToSet>();
     addFewElements2<SmallOffsetsPointsToSet>();
     addFewElements2<AlignedSmallOffsetsPointsToSet>();
     addFewElements2<AlignedPointerIdPointsToSet>();
@@ -290,6 +337,8 @@ TEST_CASE("Merge points-to sets", "PointsToSet") {
     mergePointsToSets<SimplePointsToSet>();
     mergePointsToSets<SeparateOffsetsPointsToSet>();
     mergePointsToSets<PointerIdPointsToSet>();
+    mergePointsToSets<InternedPointsToSet>();
+    mergePointsToSets<BDDPointsToSet>();
     mergePointsToSets<SmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedSmallOffsetsPointsToSet>();
     mergePointsToSets<AlignedPointerIdPointsToSet>();
@@ -301,6 +350,8 @@ TEST_CASE("Remove element",
     removeElement<OffsetsSetPointsToSet>();
     removeElement<SimplePointsToSet>();
     removeElement<PointerIdPointsToSet>();
+    removeElement<InternedPointsToSet>();
+    removeElement<BDDPointsToSet>();
     removeElement<SmallOffsetsPointsToSet>();
     removeElement<AlignedSmallOffsetsPointsToSet>();
     removeElement<AlignedPointerIdPointsToSet>();
@@ -312,6 +363,8 @@ TEST_CASE("Remove few elements",
     removeFewElements<OffsetsSetPointsToSet>();
     removeFewElements<SimplePointsToSet>();
     removeFewElements<PointerIdPointsToSet>();
+    removeFewElements<InternedPointsToSet>();
+    removeFewElements<BDDPointsToSet>();
     removeFewElements<SmallOffsetsPointsToSet>();
     removeFewElements<AlignedSmallOffsetsPointsToSet>();
     removeFewElements<AlignedPointerIdPointsToSet>();
@@ -323,6 +376,8 @@ TEST_CASE("Remove all elements pointing to a target",
     removeAnyTest<OffsetsSetPointsToSet>();
     removeAnyTest<SimplePointsToSet>();
     removeAnyTest<PointerIdPointsToSet>();
+    removeAnyTest<InternedPointsToSet>();
+    removeAnyTest<BDDPointsToSet>();
     removeAnyTest<SmallOffsetsPointsToSet>();
     removeAnyTest<AlignedSmallOffsetsPointsToSet>();
     removeAnyTest<AlignedPointerIdPointsToSet>();
@@ -333,6 +388,8 @@ TEST_CASE("Test various points-to functions", "PointsToSet") {
     pointsToTest<SimplePointsToSet>();
     pointsToTest<SeparateOffsetsPointsToSet>();
     pointsToTest<PointerIdPointsToSet>();
+    pointsToTest<InternedPointsToSet>();
+    pointsToTest<BDDPointsToSet>();
     pointsToTest<SmallOffsetsPointsToSet>();
     pointsToTest<AlignedSmallOffsetsPointsToSet>();
     pointsToTest<AlignedPointerIdPointsToSet>();
@@ -346,3 +403,217 @@ TEST_CASE("Test aligned overflow set behavior", "PointsToSet") {
     testAlignedOverflowBehavior<AlignedSmallOffsetsPointsToSet>();
     testAlignedOverflowBehavior<AlignedPointerIdPointsToSet>();
 }
+
+TEST_CASE("Points-to sets of separate graphs", "PointsToSet") {
+    separateGraphsTest<PointerIdPointsToSet>();
+    separateGraphsTest<InternedPointsToSet>();
+    separateGraphsTest<BDDPointsToSet>();
+    separateGraphsTest<SmallOffsetsPointsToSet>();
+    separateGraphsTest<AlignedSmallOffsetsPointsToSet>();
+    separateGraphsTest<AlignedPointerIdPointsToSet>();
+}
+
+TEST_CASE("Interned points-to sets", "PointsToSet") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+
+    InternedPointsToSet S1, S2, S3;
+    REQUIRE(S1 == S2);
+    REQUIRE(S1.add(Pointer(A, 0)) == true);
+    REQUIRE(S1 != S2);
+    REQUIRE(S2.add(Pointer(A, 0)) == true);
+    REQUIRE(S1 == S2);
+    REQUIRE(S1.add(Pointer(B, 4)) == true);
+    REQUIRE(S2.add(Pointer(B, 4)) == true);
+    REQUIRE(S1 == S2);
+
+    // the union is memoized and does not create a new set
+    auto &pool = PS.getPointerIDs().getInternedSets();
+    auto sets = pool.size();
+    REQUIRE(S3.add(S1) == true);
+    REQUIRE(S3 == S1);
+    REQUIRE(S3.add(S2) == false);
+    REQUIRE(pool.size() == sets);
+
+    // changing a set does not change the sets that share it
+    REQUIRE(S3.remove(Pointer(A, 0)) == true);
+    REQUIRE(S3.size() == 1);
+    REQUIRE(S1.size() == 2);
+    REQUIRE(S1.pointsTo(Pointer(A, 0)));
+    REQUIRE(S3.add(Pointer(A, 0)) == true);
+    REQUIRE(S3 == S1);
+
+    // sets of only special pointers are not bound to any graph
+    InternedPointsToSet N1{Pointer(NULLPTR, 0)};
+    InternedPointsToSet N2{Pointer(NULLPTR, 0)};
+    REQUIRE(N1 == N2);
+    REQUIRE(N1.hasNull());
+    REQUIRE(S3.add(N1) == true);
+    REQUIRE(S3.hasNull());
+    REQUIRE(S3.size() == 3);
+}
+
+TEST_CASE("Interned sets are freed", "PointsToSet") {
+    PointerGraph PS;
+    auto &pool = PS.getPointerIDs().getInternedSets();
+    std::vector<PSNode *> nodes;
+    for (unsigned i = 0; i < 100; ++i)
+        nodes.push_back(PS.create<PSNodeType::ALLOC>());
+
+    // adding the pointers one by one creates a set after each addition,
+    // but the sets that are not used anymore are swept
+    InternedPointsToSet S;
+    for (unsigned off = 0; off < 50; ++off) {
+        for (auto *nd : nodes)
+            S.add(Pointer(nd, off));
+    }
+    REQUIRE(S.size() == 5000);
+    REQUIRE(pool.size() < 3000);
+
+    // adding a container of pointers interns only the result
+    std::vector<Pointer> ptrs;
+    for (auto *nd : nodes)
+        ptrs.push_back(Pointer(nd, 100));
+    auto sets = pool.size();
+    InternedPointsToSet S2;
+    REQUIRE(S2.add(ptrs) == true);
+    REQUIRE(S2.size() == 100);
+    REQUIRE(pool.size() == sets + 1);
+    REQUIRE(S2.add(ptrs) == false);
+
+    // the unknown offset subsumes the other offsets also in a container
+    ptrs.push_back(Pointer(nodes[0], dg::Offset::UNKNOWN));
+    REQUIRE(S2.add(ptrs) == true);
+    REQUIRE(S2.size() == 100);
+    REQUIRE(S2.pointsTo(Pointer(nodes[0], dg::Offset::UNKNOWN)));
+    REQUIRE(!S2.pointsTo(Pointer(nodes[0], 100)));
+
+    // copies keep the set alive
+    InternedPointsToSet S3 = S2;
+    S2.clear();
+    REQUIRE(S3.size() == 100);
+    REQUIRE(S3.pointsTo(Pointer(nodes[1], 100)));
+}
+
+TEST_CASE("Interned sets of special nodes in a graph", "PointsToSet") {
+    PointerGraph PS;
+    auto &pool = PS.getPointerIDs().getInternedSets();
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+
+    InternedPointsToSet G{Pointer(A, 0)};
+    for (unsigned i = 0; i < 2; ++i) {
+        // the special set is interned also into the pool of the graph,
+        // so the memoized union does not refer to the special set
+        auto sets = pool.size();
+        InternedPointsToSet N{Pointer(NULLPTR, i)};
+        REQUIRE(G.add(N) == true);
+        REQUIRE(G.add(N) == false);
+        REQUIRE(pool.size() == sets + 2);
+        REQUIRE(G.pointsTo(Pointer(NULLPTR, i)));
+
+        // the other way round
+        InternedPointsToSet N2{Pointer(NULLPTR, i)};
+        REQUIRE(N2.add(G) == true);
+        REQUIRE(N2 == G);
+    }
+
+    // free the unused special sets and create new ones
+    // (possibly at the same addresses)
+    for (unsigned i = 0; i < 4096; ++i)
+        InternedPointsToSet{Pointer(UNKNOWN_MEMORY, i + 10)};
+    InternedPointsToSet N{Pointer(INVALIDATED, 0)};
+    InternedPointsToSet G2{Pointer(A, 0)};
+    REQUIRE(G2.add(N) == true);
+    REQUIRE(G2.size() == 2);
+    REQUIRE(G2.pointsTo(Pointer(INVALIDATED, 0)));
+    REQUIRE(!G2.pointsTo(Pointer(NULLPTR, 0)));
+}
+
+TEST_CASE("Interned set outlives its graph", "PointsToSet") {
+    InternedPointsToSet S;
+    {
+        PointerGraph PS;
+        PSNode *A = PS.create<PSNodeType::ALLOC>();
+        REQUIRE(S.add(Pointer(A, 0)) == true);
+        InternedPointsToSet S2(S);
+        REQUIRE(S2 == S);
+    }
+    // the set is freed by its last reference
+    S.clear();
+    REQUIRE(S.empty());
+}
+
+TEST_CASE("BDD sets are freed", "PointsToSet") {
+    PointerGraph PS;
+    auto &M = PS.getPointerIDs().getBDDs();
+    std::vector<PSNode *> nodes;
+    for (unsigned i = 0; i < 100; ++i)
+        nodes.push_back(PS.create<PSNodeType::ALLOC>());
+    // the nodes of the graph may have BDD sets, too
+    M.collectGarbage();
+    auto empty = M.size();
+
+    // adding the pointers one by one creates a BDD after each addition,
+    // but the nodes of BDDs that are not used anymore are freed
+    BDDPointsToSet S;
+    for (unsigned off = 0; off < 50; ++off) {
+        for (auto *nd : nodes)
+            S.add(Pointer(nd, off));
+    }
+    REQUIRE(S.size() == 5000);
+    M.collectGarbage();
+    auto live = M.size();
+
+    // the pointers to a target are removed without enumerating the set
+    BDDPointsToSet S2(S);
+    for (auto *nd : nodes) {
+        REQUIRE(S2.pointsToTarget(nd));
+        REQUIRE(S2.removeAny(nd) == true);
+        REQUIRE(!S2.pointsToTarget(nd));
+        REQUIRE(S2.removeAny(nd) == false);
+    }
+    REQUIRE(S2.empty());
+    REQUIRE(S.size() == 5000);
+    M.collectGarbage();
+    REQUIRE(M.size() == live);
+
+    // copies keep the set alive
+    BDDPointsToSet S3 = S;
+    S.clear();
+    M.collectGarbage();
+    REQUIRE(M.size() == live);
+    REQUIRE(S3.size() == 5000);
+    REQUIRE(S3.pointsTo(Pointer(nodes[1], 49)));
+    S3.clear();
+    M.collectGarbage();
+    REQUIRE(M.size() == empty);
+
+    // the null pointer with an offset is found by the prefix, too
+    BDDPointsToSet N{Pointer(NULLPTR, 0), Pointer(nodes[0], 0)};
+    REQUIRE(!N.hasNullWithOffset());
+    N.add(Pointer(NULLPTR, 8));
+    REQUIRE(N.hasNullWithOffset());
+    N.remove(Pointer(NULLPTR, 8));
+    REQUIRE(!N.hasNullWithOffset());
+    N.add(Pointer(NULLPTR, dg::Offset::UNKNOWN));
+    REQUIRE(N.hasNullWithOffset());
+}
+
+TEST_CASE("BDD set outlives its graph", "PointsToSet") {
+    BDDPointsToSet S;
+    {
+        PointerGraph PS;
+        PSNode *A = PS.create<PSNodeType::ALLOC>();
+        REQUIRE(S.add(Pointer(A, 0)) == true);
+        BDDPointsToSet S2(S);
+        REQUIRE(S2.size() == 1);
+    }
+    // the manager of the graph is freed by the last release
+    REQUIRE(S.size() == 1);
+    BDDPointsToSet S3(S);
+    S.clear();
+    REQUIRE(S.empty());
+    S3 = BDDPointsToSet();
+    REQUIRE(S3.empty());
+}
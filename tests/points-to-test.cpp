@@ -2,13 +2,14 @@
 
 #include "dg/PointerAnalysis/PointerAnalysisFI.h"
 #include "dg/PointerAnalysis/PointerAnalysisFS.h"
+#include "dg/PointerAnalysis/PointerAnalysisSFS.h"
 #include "dg/PointerAnalysis/PointerGraph.h"
 
 using namespace dg::pta;
 using dg::Offset;
 
 template <typename PTStoT>
-void store_load() {
+void store_load(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -21,14 +22,14 @@ void store_load() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L->doesPointsTo(A));
 }
 
 template <typename PTStoT>
-void store_load2() {
+void store_load2(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -63,7 +64,7 @@ void store_load2() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A));
@@ -73,7 +74,7 @@ void store_load2() {
 }
 
 template <typename PTStoT>
-void store_load3() {
+void store_load3(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -92,7 +93,7 @@ void store_load3() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A));
@@ -100,7 +101,7 @@ void store_load3() {
 }
 
 template <typename PTStoT>
-void store_load4() {
+void store_load4(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(8);
@@ -122,7 +123,7 @@ void store_load4() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A, 4));
@@ -130,7 +131,7 @@ void store_load4() {
 }
 
 template <typename PTStoT>
-void store_load5() {
+void store_load5(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(8);
@@ -157,7 +158,7 @@ void store_load5() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A, 4));
@@ -165,7 +166,7 @@ void store_load5() {
 }
 
 template <typename PTStoT>
-void gep1() {
+void gep1(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     // we must set size, so that GEP won't
@@ -185,7 +186,7 @@ void gep1() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(GEP1->doesPointsTo(A, 4));
@@ -194,7 +195,7 @@ void gep1() {
 }
 
 template <typename PTStoT>
-void gep2() {
+void gep2(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(16);
@@ -214,7 +215,7 @@ void gep2() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(GEP1->doesPointsTo(A, 4));
@@ -222,7 +223,7 @@ void gep2() {
 }
 
 template <typename PTStoT>
-void gep3() {
+void gep3(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -250,7 +251,7 @@ void gep3() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A));
@@ -258,7 +259,7 @@ void gep3() {
 }
 
 template <typename PTStoT>
-void gep4() {
+void gep4(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -290,7 +291,7 @@ void gep4() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A));
@@ -298,7 +299,7 @@ void gep4() {
 }
 
 template <typename PTStoT>
-void gep5() {
+void gep5(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -336,7 +337,7 @@ void gep5() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A));
@@ -346,7 +347,7 @@ void gep5() {
 }
 
 template <typename PTStoT>
-void nulltest() {
+void nulltest(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *B = PS.create<PSNodeType::ALLOC>();
     PSNode *S = PS.create<PSNodeType::STORE>(NULLPTR, B);
@@ -357,14 +358,14 @@ void nulltest() {
 
     auto *subg = PS.createSubgraph(B);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L->doesPointsTo(NULLPTR));
 }
 
 template <typename PTStoT>
-void constant_store() {
+void constant_store(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -381,14 +382,14 @@ void constant_store() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L->doesPointsTo(A));
 }
 
 template <typename PTStoT>
-void load_from_zeroed() {
+void load_from_zeroed(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNodeAlloc *B = PSNodeAlloc::get(PS.create<PSNodeType::ALLOC>());
     B->setZeroInitialized();
@@ -398,14 +399,14 @@ void load_from_zeroed() {
 
     auto *subg = PS.createSubgraph(B);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L->doesPointsTo(NULLPTR));
 }
 
 template <typename PTStoT>
-void load_from_unknown_offset() {
+void load_from_unknown_offset(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -423,7 +424,7 @@ void load_from_unknown_offset() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     // B points to A + 0 at unknown offset,
@@ -432,7 +433,7 @@ void load_from_unknown_offset() {
 }
 
 template <typename PTStoT>
-void load_from_unknown_offset2() {
+void load_from_unknown_offset2(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -451,7 +452,7 @@ void load_from_unknown_offset2() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     // B points to A + 0 at offset 4,
@@ -460,7 +461,7 @@ void load_from_unknown_offset2() {
 }
 
 template <typename PTStoT>
-void load_from_unknown_offset3() {
+void load_from_unknown_offset3(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     PSNode *B = PS.create<PSNodeType::ALLOC>();
@@ -478,14 +479,14 @@ void load_from_unknown_offset3() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L->doesPointsTo(A));
 }
 
 template <typename PTStoT>
-void memcpy_test() {
+void memcpy_test(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(20);
@@ -532,7 +533,7 @@ void memcpy_test() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A, 3));
@@ -540,7 +541,7 @@ void memcpy_test() {
 }
 
 template <typename PTStoT>
-void memcpy_test2() {
+void memcpy_test2(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(20);
@@ -587,7 +588,7 @@ void memcpy_test2() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A, 3));
@@ -595,7 +596,7 @@ void memcpy_test2() {
 }
 
 template <typename PTStoT>
-void memcpy_test3() {
+void memcpy_test3(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(20);
@@ -642,7 +643,7 @@ void memcpy_test3() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L2->doesPointsTo(A, 12));
@@ -650,7 +651,7 @@ void memcpy_test3() {
 }
 
 template <typename PTStoT>
-void memcpy_test4() {
+void memcpy_test4(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNodeAlloc *A = PSNodeAlloc::get(PS.create<PSNodeType::ALLOC>());
     A->setSize(20);
@@ -689,7 +690,7 @@ void memcpy_test4() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(NULLPTR));
@@ -697,7 +698,7 @@ void memcpy_test4() {
 }
 
 template <typename PTStoT>
-void memcpy_test5() {
+void memcpy_test5(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(20);
@@ -732,7 +733,7 @@ void memcpy_test5() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A, 3));
@@ -740,7 +741,7 @@ void memcpy_test5() {
 }
 
 template <typename PTStoT>
-void memcpy_test6() {
+void memcpy_test6(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNode *A = PS.create<PSNodeType::ALLOC>();
     A->setSize(20);
@@ -772,14 +773,14 @@ void memcpy_test6() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A, 3));
 }
 
 template <typename PTStoT>
-void memcpy_test7() {
+void memcpy_test7(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNodeAlloc *A = PSNodeAlloc::get(PS.create<PSNodeType::ALLOC>());
     PSNodeAlloc *SRC = PSNodeAlloc::get(PS.create<PSNodeType::ALLOC>());
@@ -813,7 +814,7 @@ void memcpy_test7() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(NULLPTR));
@@ -822,7 +823,7 @@ void memcpy_test7() {
 }
 
 template <typename PTStoT>
-void memcpy_test8() {
+void memcpy_test8(const dg::PointerAnalysisOptions &opts = {}) {
     PointerGraph PS;
     PSNodeAlloc *A = PSNodeAlloc::get(PS.create<PSNodeType::ALLOC>());
     A->setSize(20);
@@ -860,7 +861,7 @@ void memcpy_test8() {
 
     auto *subg = PS.createSubgraph(A);
     PS.setEntry(subg);
-    PTStoT PA(&PS);
+    PTStoT PA(&PS, opts);
     PA.run();
 
     REQUIRE(L1->doesPointsTo(A, 3));
@@ -868,58 +869,356 @@ void memcpy_test8() {
     REQUIRE(L3->doesPointsTo(NULLPTR));
 }
 
+template <typename PTStoT>
+void memcpy_test9(const dg::PointerAnalysisOptions &opts = {}) {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::ALLOC>();
+    PSNodeAlloc *SRC = PSNodeAlloc::get(PS.create<PSNodeType::ALLOC>());
+    SRC->setSize(32);
+    PSNodeAlloc *DEST = PSNodeAlloc::get(PS.create<PSNodeType::ALLOC>());
+    DEST->setSize(16);
+
+    /* SRC = {A, B, C, ?} with pointers at offsets 0, 8 and 16 */
+    PSNode *G1 = PS.create<PSNodeType::GEP>(SRC, 8);
+    PSNode *G2 = PS.create<PSNodeType::GEP>(SRC, 16);
+    PSNode *G3 = PS.create<PSNodeType::GEP>(SRC, 24);
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, SRC);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(B, G1);
+    PSNode *S3 = PS.create<PSNodeType::STORE>(C, G2);
+
+    /* copy only the pointer at offset 8 to DEST + 0 */
+    PSNode *CPY1 = PS.create<PSNodeType::MEMCPY>(G1, DEST, 8);
+    /* copy the pointers at offsets 0 and 8 inside SRC to offset 16 */
+    PSNode *CPY2 = PS.create<PSNodeType::MEMCPY>(SRC, G2, 16);
+
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(DEST);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(G2);
+    PSNode *L3 = PS.create<PSNodeType::LOAD>(G3);
+
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(SRC);
+    SRC->addSuccessor(DEST);
+    DEST->addSuccessor(G1);
+    G1->addSuccessor(G2);
+    G2->addSuccessor(G3);
+    G3->addSuccessor(S1);
+    S1->addSuccessor(S2);
+    S2->addSuccessor(S3);
+    S3->addSuccessor(CPY1);
+    CPY1->addSuccessor(CPY2);
+    CPY2->addSuccessor(L1);
+    L1->addSuccessor(L2);
+    L2->addSuccessor(L3);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS, opts);
+    PA.run();
+
+    REQUIRE(L1->doesPointsTo(B));
+    REQUIRE(!L1->doesPointsTo(A));
+    REQUIRE(!L1->doesPointsTo(C));
+    REQUIRE(L2->doesPointsTo(A));
+    REQUIRE(!L2->doesPointsTo(B));
+    REQUIRE(L3->doesPointsTo(B));
+    REQUIRE(!L3->doesPointsTo(A));
+    REQUIRE(!L3->doesPointsTo(C));
+}
+
+template <typename PTStoT>
+void load_in_loop(const dg::PointerAnalysisOptions &opts = {}) {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::ALLOC>();
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, B);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(C, A);
+    PSNode *P = PS.create<PSNodeType::PHI>(B);
+    PSNode *L = PS.create<PSNodeType::LOAD>(P);
+    P->addOperand(L);
+
+    /*
+     * B -> A -> C, P = B; while (...) P = *P;
+     */
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(S1);
+    S1->addSuccessor(S2);
+    S2->addSuccessor(P);
+    P->addSuccessor(L);
+    L->addSuccessor(P);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PTStoT PA(&PS, opts);
+    PA.run();
+
+    REQUIRE(P->doesPointsTo(B));
+    REQUIRE(P->doesPointsTo(A));
+    REQUIRE(P->doesPointsTo(C));
+    REQUIRE(L->doesPointsTo(A));
+    REQUIRE(L->doesPointsTo(C));
+    REQUIRE(!L->doesPointsTo(B));
+}
+
+// run all the tests above with the given analysis and options
+template <typename PTStoT>
+void runAllTests(const dg::PointerAnalysisOptions &opts = {}) {
+    store_load<PTStoT>(opts);
+    store_load2<PTStoT>(opts);
+    store_load3<PTStoT>(opts);
+    store_load4<PTStoT>(opts);
+    store_load5<PTStoT>(opts);
+    gep1<PTStoT>(opts);
+    gep2<PTStoT>(opts);
+    gep3<PTStoT>(opts);
+    gep4<PTStoT>(opts);
+    gep5<PTStoT>(opts);
+    nulltest<PTStoT>(opts);
+    constant_store<PTStoT>(opts);
+    load_from_zeroed<PTStoT>(opts);
+    load_from_unknown_offset<PTStoT>(opts);
+    load_from_unknown_offset2<PTStoT>(opts);
+    load_from_unknown_offset3<PTStoT>(opts);
+    memcpy_test<PTStoT>(opts);
+    memcpy_test2<PTStoT>(opts);
+    memcpy_test3<PTStoT>(opts);
+    memcpy_test4<PTStoT>(opts);
+    memcpy_test5<PTStoT>(opts);
+    memcpy_test6<PTStoT>(opts);
+    memcpy_test7<PTStoT>(opts);
+    memcpy_test8<PTStoT>(opts);
+    memcpy_test9<PTStoT>(opts);
+    load_in_loop<PTStoT>(opts);
+}
+
 TEST_CASE("Flow insensitive", "FI") {
-    store_load<dg::pta::PointerAnalysisFI>();
-    store_load2<dg::pta::PointerAnalysisFI>();
-    store_load3<dg::pta::PointerAnalysisFI>();
-    store_load4<dg::pta::PointerAnalysisFI>();
-    store_load5<dg::pta::PointerAnalysisFI>();
-    gep1<dg::pta::PointerAnalysisFI>();
-    gep2<dg::pta::PointerAnalysisFI>();
-    gep3<dg::pta::PointerAnalysisFI>();
-    gep4<dg::pta::PointerAnalysisFI>();
-    gep5<dg::pta::PointerAnalysisFI>();
-    nulltest<dg::pta::PointerAnalysisFI>();
-    constant_store<dg::pta::PointerAnalysisFI>();
-    load_from_zeroed<dg::pta::PointerAnalysisFI>();
-    load_from_unknown_offset<dg::pta::PointerAnalysisFI>();
-    load_from_unknown_offset2<dg::pta::PointerAnalysisFI>();
-    load_from_unknown_offset3<dg::pta::PointerAnalysisFI>();
-    memcpy_test<dg::pta::PointerAnalysisFI>();
-    memcpy_test2<dg::pta::PointerAnalysisFI>();
-    memcpy_test3<dg::pta::PointerAnalysisFI>();
-    memcpy_test4<dg::pta::PointerAnalysisFI>();
-    memcpy_test5<dg::pta::PointerAnalysisFI>();
-    memcpy_test6<dg::pta::PointerAnalysisFI>();
-    memcpy_test7<dg::pta::PointerAnalysisFI>();
-    memcpy_test8<dg::pta::PointerAnalysisFI>();
+    runAllTests<dg::pta::PointerAnalysisFI>();
 }
 
 TEST_CASE("Flow sensitive", "FS") {
-    store_load<dg::pta::PointerAnalysisFS>();
-    store_load2<dg::pta::PointerAnalysisFS>();
-    store_load3<dg::pta::PointerAnalysisFS>();
-    store_load4<dg::pta::PointerAnalysisFS>();
-    store_load5<dg::pta::PointerAnalysisFS>();
-    gep1<dg::pta::PointerAnalysisFS>();
-    gep2<dg::pta::PointerAnalysisFS>();
-    gep3<dg::pta::PointerAnalysisFS>();
-    gep4<dg::pta::PointerAnalysisFS>();
-    gep5<dg::pta::PointerAnalysisFS>();
-    nulltest<dg::pta::PointerAnalysisFS>();
-    constant_store<dg::pta::PointerAnalysisFS>();
-    load_from_zeroed<dg::pta::PointerAnalysisFS>();
-    load_from_unknown_offset<dg::pta::PointerAnalysisFS>();
-    load_from_unknown_offset2<dg::pta::PointerAnalysisFS>();
-    load_from_unknown_offset3<dg::pta::PointerAnalysisFS>();
-    memcpy_test<dg::pta::PointerAnalysisFS>();
-    memcpy_test2<dg::pta::PointerAnalysisFS>();
-    memcpy_test3<dg::pta::PointerAnalysisFS>();
-    memcpy_test4<dg::pta::PointerAnalysisFS>();
-    memcpy_test5<dg::pta::PointerAnalysisFS>();
-    memcpy_test6<dg::pta::PointerAnalysisFS>();
-    memcpy_test7<dg::pta::PointerAnalysisFS>();
-    memcpy_test8<dg::pta::PointerAnalysisFS>();
+    runAllTests<dg::pta::PointerAnalysisFS>();
+}
+
+TEST_CASE("Flow insensitive with difference propagation", "FI") {
+    dg::PointerAnalysisOptions opts;
+    opts.setDifferencePropagation(true);
+
+    runAllTests<dg::pta::PointerAnalysisFI>(opts);
+}
+
+TEST_CASE("Flow insensitive with collapsing cycles", "FI") {
+    dg::PointerAnalysisOptions opts;
+    opts.setCollapseCycles(true);
+
+    runAllTests<dg::pta::PointerAnalysisFI>(opts);
+}
+
+TEST_CASE("Flow insensitive with topological scheduling", "FI") {
+    dg::PointerAnalysisOptions opts;
+    opts.setScheduling(dg::PointerAnalysisOptions::Scheduling::TOPOLOGICAL);
+
+    runAllTests<dg::pta::PointerAnalysisFI>(opts);
+}
+
+TEST_CASE("Flow insensitive with workers", "FI") {
+    dg::PointerAnalysisOptions opts;
+    opts.setWorkers(4);
+
+    runAllTests<dg::pta::PointerAnalysisFI>(opts);
+}
+
+TEST_CASE("Flow sensitive with difference propagation", "FS") {
+    dg::PointerAnalysisOptions opts;
+    opts.setDifferencePropagation(true);
+
+    runAllTests<dg::pta::PointerAnalysisFS>(opts);
+}
+
+TEST_CASE("Flow sensitive with topological scheduling", "FS") {
+    dg::PointerAnalysisOptions opts;
+    opts.setScheduling(dg::PointerAnalysisOptions::Scheduling::TOPOLOGICAL);
+
+    runAllTests<dg::pta::PointerAnalysisFS>(opts);
+}
+
+TEST_CASE("Sparse flow sensitive", "SFS") {
+    runAllTests<dg::pta::PointerAnalysisSFS>();
+}
+
+TEST_CASE("Sparse flow sensitive strong update", "SFS") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::ALLOC>();
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, B);
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(B);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(C, B);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(B);
+
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(S1);
+    S1->addSuccessor(L1);
+    L1->addSuccessor(S2);
+    S2->addSuccessor(L2);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PointerAnalysisSFS PA(&PS);
+    PA.run();
+
+    // memory SSA
+    REQUIRE(PA.defines(S1, B));
+    REQUIRE(PA.defines(S2, B));
+    REQUIRE(!PA.defines(L1, B));
+    REQUIRE(PA.getReachingDefinitions(L1, B) == std::vector<PSNode *>{S1});
+    REQUIRE(PA.getReachingDefinitions(S2, B) == std::vector<PSNode *>{S1});
+    REQUIRE(PA.getReachingDefinitions(L2, B) == std::vector<PSNode *>{S2});
+
+    REQUIRE(L1->doesPointsTo(A));
+    REQUIRE(L1->pointsTo.size() == 1);
+    REQUIRE(L2->doesPointsTo(C));
+    REQUIRE(L2->pointsTo.size() == 1);
+
+    // only the nodes that access memory have memory maps
+    REQUIRE(A->getData<PointerAnalysisSFS::MemoryMapT>() == nullptr);
+    REQUIRE(C->getData<PointerAnalysisSFS::MemoryMapT>() == nullptr);
+}
+
+static void collapsing_cycles(const dg::PointerAnalysisOptions &opts) {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *P1 = PS.create<PSNodeType::PHI>(A);
+    PSNode *C1 = PS.create<PSNodeType::CAST>(P1);
+    PSNode *P2 = PS.create<PSNodeType::PHI>(B, C1);
+    PSNode *C2 = PS.create<PSNodeType::CAST>(P2);
+    P1->addOperand(C2);
+
+    A->addSuccessor(B);
+    B->addSuccessor(P1);
+    P1->addSuccessor(C1);
+    C1->addSuccessor(P2);
+    P2->addSuccessor(C2);
+    C2->addSuccessor(P1);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+
+    PointerAnalysisFI PA(&PS, opts);
+    PA.run();
+
+    for (PSNode *n : {P1, C1, P2, C2}) {
+        REQUIRE(n->pointsTo.size() == 2);
+        REQUIRE(n->doesPointsTo(A));
+        REQUIRE(n->doesPointsTo(B));
+    }
+    REQUIRE(PA.getCollapsedNodes().size() == 3);
+}
+
+TEST_CASE("Collapsing cycles", "FI") {
+    dg::PointerAnalysisOptions opts;
+    opts.setCollapseCycles(true);
+    collapsing_cycles(opts);
+
+    // the results are the same with difference propagation
+    collapsing_cycles(opts.setDifferencePropagation(true));
+}
+
+TEST_CASE("Parallel processing of nodes", "FI") {
+    // big enough groups of independent nodes are processed by threads
+    const size_t N = 1000;
+    PointerGraph PS;
+    PSNode *P = PS.create<PSNodeType::ALLOC>();
+    std::vector<PSNode *> allocs, casts, geps, loads;
+    for (size_t i = 0; i < N; ++i) {
+        allocs.push_back(PS.create<PSNodeType::ALLOC>());
+        allocs.back()->setSize(8);
+    }
+    for (size_t i = 0; i < N; ++i)
+        casts.push_back(PS.create<PSNodeType::CAST>(allocs[i]));
+    for (size_t i = 0; i < N; ++i)
+        geps.push_back(PS.create<PSNodeType::GEP>(casts[i], 4));
+    PSNode *S = PS.create<PSNodeType::STORE>(geps[0], P);
+    for (size_t i = 0; i < N; ++i)
+        loads.push_back(PS.create<PSNodeType::LOAD>(P));
+
+    PSNode *last = P;
+    for (auto *nodes : {&allocs, &casts, &geps}) {
+        for (PSNode *n : *nodes) {
+            last->addSuccessor(n);
+            last = n;
+        }
+    }
+    last->addSuccessor(S);
+    last = S;
+    for (PSNode *n : loads) {
+        last->addSuccessor(n);
+        last = n;
+    }
+
+    auto *subg = PS.createSubgraph(P);
+    PS.setEntry(subg);
+
+    dg::PointerAnalysisOptions opts;
+    opts.setWorkers(4).setDifferencePropagation(true);
+    PointerAnalysisFI PA(&PS, opts);
+    PA.run();
+
+    for (size_t i = 0; i < N; ++i) {
+        REQUIRE(casts[i]->pointsTo.size() == 1);
+        REQUIRE(casts[i]->doesPointsTo(allocs[i]));
+        REQUIRE(geps[i]->pointsTo.size() == 1);
+        REQUIRE(geps[i]->doesPointsTo(allocs[i], 4));
+        REQUIRE(loads[i]->pointsTo.size() == 1);
+        REQUIRE(loads[i]->doesPointsTo(allocs[0], 4));
+    }
+}
+
+TEST_CASE("Flow sensitive memory maps share objects", "FS") {
+    PointerGraph PS;
+    PSNode *A = PS.create<PSNodeType::ALLOC>();
+    PSNode *B = PS.create<PSNodeType::ALLOC>();
+    PSNode *C = PS.create<PSNodeType::ALLOC>();
+    PSNode *S1 = PS.create<PSNodeType::STORE>(A, B);
+    PSNode *S2 = PS.create<PSNodeType::STORE>(A, C);
+    PSNode *S3 = PS.create<PSNodeType::STORE>(C, B);
+    PSNode *L1 = PS.create<PSNodeType::LOAD>(B);
+    PSNode *L2 = PS.create<PSNodeType::LOAD>(B);
+
+    A->addSuccessor(B);
+    B->addSuccessor(C);
+    C->addSuccessor(S1);
+    S1->addSuccessor(S2);
+    S2->addSuccessor(L1);
+    L1->addSuccessor(S3);
+    S3->addSuccessor(L2);
+
+    auto *subg = PS.createSubgraph(A);
+    PS.setEntry(subg);
+    PointerAnalysisFS PA(&PS);
+    PA.run();
+
+    using MemoryMapT = PointerAnalysisFS::MemoryMapT;
+    auto *mm1 = S1->getData<MemoryMapT>();
+    auto *mm2 = S2->getData<MemoryMapT>();
+    auto *mm3 = S3->getData<MemoryMapT>();
+    REQUIRE(mm1 != mm2);
+    REQUIRE(mm2 != mm3);
+
+    // S2 does not write to B, so it shares the object with S1
+    REQUIRE(mm1->find(B)->second.get() == mm2->find(B)->second.get());
+    // S3 overwrites B, so it must have its own copy
+    REQUIRE(mm2->find(B)->second.get() != mm3->find(B)->second.get());
+
+    REQUIRE(L1->doesPointsTo(A));
+    REQUIRE(L1->pointsTo.size() == 1);
+    REQUIRE(L2->doesPointsTo(C));
+    REQUIRE(L2->pointsTo.size() == 1);
 }
 
 TEST_CASE("PSNode test", "PSNode") {
@@ -1,38 +1,64 @@
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
 
+#include "dg/PointerAnalysis/PointerGraph.h"
 #include "dg/PointerAnalysis/PointsToSet.h"
 #include "dg/util/TimeMeasure.h"
 
 using namespace dg::pta;
 
+// points-to sets need nodes from a graph
+std::unique_ptr<PointerGraph> PG;
+std::vector<PSNode *> nodes;
+
+// Every representation gets a new graph, so that the tables
+// of the previous representations are freed
+static void createNodes() {
+    nodes.clear();
+    PG.reset(new PointerGraph());
+    for (int i = 0; i < 1000; ++i)
+        nodes.push_back(PG->create<PSNodeType::ALLOC>());
+}
+
 std::default_random_engine generator;
 std::uniform_int_distribution<uint64_t> distribution(0,
                                                      ~static_cast<uint64_t>(0));
 
-#define run(func, msg)                                                         \
+#define run_one(func, PTSetT, msg)                                              \
     do {                                                                       \
-        std::cout << "Running " << (msg) << "\n";                              \
+        createNodes();                                                         \
         dg::debug::TimeMeasure tm;                                             \
         tm.start();                                                            \
         for (int i = 0; i < times; ++i)                                        \
-            func<PointsToSetT>();                                              \
-        tm.stop();                                                             \
-        tm.report(" -- PointsToSet bitvector took");                           \
-        tm.start();                                                            \
-        for (int i = 0; i < times; ++i)                                        \
-            func<SimplePointsToSet>();                                         \
+            func<PTSetT>();                                                    \
         tm.stop();                                                             \
-        tm.report(" -- PointsToSet std::set took");                            \
+        tm.report(" -- PointsToSet " msg " took");                             \
+    } while (0);
+
+#define run(func, msg)                                                         \
+    do {                                                                       \
+        std::cout << "Running " << (msg) << "\n";                              \
+        run_one(func, PointerIdPointsToSet, "bitvector");                      \
+        run_one(func, SimplePointsToSet, "std::set");                          \
+    } while (0);
+
+// The shared representations keep the sets (or their parts) in the graph,
+// so they are run separately with their own number of iterations
+#define run_shared(func, msg)                                                  \
+    do {                                                                       \
+        std::cout << "Running " << (msg) << " (shared sets)\n";                \
+        run_one(func, InternedPointsToSet, "interned");                        \
+        run_one(func, BDDPointsToSet, "BDD");                                  \
     } while (0);
 
 template <typename PTSetT>
 void test1() {
     PTSetT S;
-    PSNode *x = reinterpret_cast<PSNode *>(0x1);
-    PSNode *y = reinterpret_cast<PSNode *>(0x2);
-    PSNode *z = reinterpret_cast<PSNode *>(0x3);
+    PSNode *x = nodes[1];
+    PSNode *y = nodes[2];
+    PSNode *z = nodes[3];
 
     S.add({x, 0});
     S.add({y, 0});
@@ -42,7 +68,7 @@ void test1() {
 template <typename PTSetT>
 void test2() {
     PTSetT S;
-    PSNode *x = reinterpret_cast<PSNode *>(0x1);
+    PSNode *x = nodes[1];
 
     S.add({x, 0});
 }
@@ -52,11 +78,8 @@ void test3() {
     std::set<size_t> numbers;
 
     PTSetT S;
-    PSNode *pointers[]{
-            reinterpret_cast<PSNode *>(0x1), reinterpret_cast<PSNode *>(0x2),
-            reinterpret_cast<PSNode *>(0x3), reinterpret_cast<PSNode *>(0x4),
-            reinterpret_cast<PSNode *>(0x5), reinterpret_cast<PSNode *>(0x6),
-            reinterpret_cast<PSNode *>(0x7)};
+    PSNode *pointers[]{nodes[1], nodes[2], nodes[3], nodes[4],
+                       nodes[5], nodes[6], nodes[7]};
 
     for (int i = 0; i < 1000; ++i) {
         auto x = distribution(generator);
@@ -70,7 +93,7 @@ void test4() {
 
     PTSetT S;
     for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(1), i);
+        S.add(nodes[1], i);
     }
 }
 
@@ -80,7 +103,23 @@ void test5() {
 
     PTSetT S;
     for (int i = 0; i < 1000; ++i) {
-        S.add(reinterpret_cast<PSNode *>(i), i);
+        S.add(nodes[i], i);
+    }
+}
+
+template <typename PTSetT>
+void test6() {
+    // many equal sets (e.g., copies of a pointer to the same buffer)
+    std::vector<PTSetT> sets(100);
+    PTSetT S;
+    for (int i = 0; i < 100; ++i) {
+        S.add(nodes[i], 0);
+    }
+    for (auto &T : sets) {
+        T.add(S);
+    }
+    for (size_t i = 1; i < sets.size(); ++i) {
+        sets[i].add(sets[i - 1]);
     }
 }
 
@@ -88,9 +127,11 @@ int main() {
     int times;
     times = 100000;
     run(test1, "Adding three elements");
+    run_shared(test1, "Adding three elements");
 
     times = 100000;
     run(test2, "Adding same element");
+    run_shared(test2, "Adding same element");
 
     times = 10000;
     run(test3, "Adding 1000 times 7 pointers with random offsets");
@@ -100,4 +141,14 @@ int main() {
 
     times = 10000;
     run(test5, "Adding 1000 different pointers");
+
+    // BDD nodes are not freed before the graph is destroyed
+    times = 100;
+    run_shared(test3, "Adding 1000 times 7 pointers with random offsets");
+    run_shared(test4, "Adding 1000 offsets to a pointer");
+    run_shared(test5, "Adding 1000 different pointers");
+
+    times = 1000;
+    run(test6, "Merging 100 equal sets of 100 pointers");
+    run_shared(test6, "Merging 100 equal sets of 100 pointers");
 }
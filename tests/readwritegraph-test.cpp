@@ -89,3 +89,324 @@ TEST_CASE("split around in middle", "[RWBBlock]") {
     CHECK(blks.first->getSingleSuccessor() == blks.second.get());
     CHECK(blks.second->getSingleSuccessor() == &succ);
 }
+
+TEST_CASE("move graph", "[ReadWriteGraph]") {
+    ReadWriteGraph G;
+    auto &S = G.createSubgraph();
+    G.setEntry(&S);
+    auto &N = G.create(RWNodeType::STORE);
+
+    ReadWriteGraph G2(std::move(G));
+    CHECK(G2.getEntry() == &S);
+    CHECK(G2.getNode(N.getID()) == &N);
+    // the moved-from graph is empty and usable
+    CHECK(G.getEntry() == nullptr);
+    CHECK(G.size() == 0);
+    CHECK(G.create(RWNodeType::LOAD).getID() == 1);
+
+    auto &self = G2;
+    G2 = std::move(self);
+    CHECK(G2.getEntry() == &S);
+    CHECK(G2.getNode(N.getID()) == &N);
+
+    G = std::move(G2);
+    CHECK(G.getEntry() == &S);
+    CHECK(G.getNode(N.getID()) == &N);
+    CHECK(G2.getEntry() == nullptr);
+    CHECK(G2.size() == 0);
+}
+
+#include <algorithm>
+#include <set>
+
+#include "dg/MemorySSA/MemorySSA.h"
+#include "dg/util/parallel.h"
+
+// Build a graph with loops, branches and calls. The entry procedure
+// has 'blocks' blocks, every block writes a part of one of the globals
+// and reads a part of another one.
+static void buildGraph(ReadWriteGraph &G, unsigned blocks) {
+    RWNode *globals[3];
+    for (auto &glob : globals)
+        glob = &G.create(RWNodeType::GLOBAL);
+
+    auto &foo = G.createSubgraph();
+    auto &fooEntry = foo.createBBlock();
+    auto &fooRet = foo.createBBlock();
+    fooEntry.addSuccessor(&fooRet);
+    auto &fooLoad = G.create(RWNodeType::LOAD);
+    fooLoad.addUse(globals[0], 0, 4);
+    auto &fooStore = G.create(RWNodeType::STORE);
+    fooStore.addDef(globals[1], 0, 4, /* strong update = */ true);
+    fooEntry.append(&fooLoad);
+    fooEntry.append(&fooStore);
+    fooRet.append(&G.create(RWNodeType::RETURN));
+
+    auto &main = G.createSubgraph();
+    G.setEntry(&main);
+    std::vector<RWBBlock *> bblocks;
+    for (unsigned i = 0; i < blocks; ++i) {
+        auto &B = main.createBBlock();
+        if (i % 16 == 8) {
+            auto *C = RWNodeCall::get(&G.create(RWNodeType::CALL));
+            C->addCallee(&foo);
+            B.append(C);
+        }
+        auto &S = G.create(RWNodeType::STORE);
+        S.addDef(globals[i % 3], (i % 4) * 4, 4, i % 2 == 0);
+        auto &L = G.create(RWNodeType::LOAD);
+        L.addUse(globals[(i + 1) % 3], 0, 8);
+        B.append(&S);
+        B.append(&L);
+        if (i % 11 == 10) {
+            auto &U = G.create(RWNodeType::LOAD);
+            U.addUse(UNKNOWN_MEMORY);
+            B.append(&U);
+        }
+        bblocks.push_back(&B);
+    }
+
+    for (unsigned i = 0; i + 1 < blocks; ++i) {
+        bblocks[i]->addSuccessor(bblocks[i + 1]);
+        if (i % 5 == 0 && i + 2 < blocks)
+            bblocks[i]->addSuccessor(bblocks[i + 2]);
+        if (i % 7 == 6)
+            bblocks[i]->addSuccessor(bblocks[i - 3]);
+    }
+}
+
+// Compute all definitions and return the IDs of the nodes that
+// define the memory read by the uses. (The IDs of the created PHI nodes
+// may differ between runs, the order of their creation depends
+// also on the addresses of the nodes.)
+static std::vector<std::vector<unsigned>> computeDefs(unsigned workers) {
+    ReadWriteGraph G;
+    buildGraph(G, 100);
+    const unsigned lastID = G.create(RWNodeType::NOOP).getID();
+
+    dg::DataDependenceAnalysisOptions opts;
+    opts.setWorkers(workers);
+    MemorySSATransformation SSA(std::move(G), opts);
+    SSA.run();
+    SSA.computeAllDefinitions();
+
+    std::vector<std::vector<unsigned>> defs;
+    for (unsigned id = 1; id < lastID; ++id) {
+        auto *n = SSA.getGraph()->getNode(id);
+        if (!n->isUse())
+            continue;
+
+        std::vector<unsigned> ids;
+        for (auto *d : SSA.getDefinitions(n))
+            ids.push_back(d->getID());
+        std::sort(ids.begin(), ids.end());
+        defs.push_back(std::move(ids));
+    }
+    return defs;
+}
+
+TEST_CASE("compute all definitions with threads", "[MemorySSA]") {
+    auto seq = computeDefs(1);
+    REQUIRE(!seq.empty());
+    REQUIRE(std::any_of(seq.begin(), seq.end(),
+                        [](const std::vector<unsigned> &d) {
+                            return d.size() > 1;
+                        }));
+    for (unsigned workers : {2, 4}) {
+        REQUIRE(computeDefs(workers) == seq);
+    }
+}
+
+// the non-PHI definitions reachable from 'n' through PHI nodes
+static void nonPhiDefs(RWNode *n, std::set<RWNode *> &visited,
+                       std::set<unsigned> &defs) {
+    for (auto *op : n->defuse) {
+        if (!op->isPhi())
+            defs.insert(op->getID());
+        else if (visited.insert(op).second)
+            nonPhiDefs(op, visited, defs);
+    }
+}
+
+TEST_CASE("cached non-phi definitions", "[MemorySSA]") {
+    ReadWriteGraph G;
+    buildGraph(G, 100);
+    const unsigned lastID = G.create(RWNodeType::NOOP).getID();
+
+    MemorySSATransformation SSA(std::move(G));
+    SSA.run();
+    SSA.computeAllDefinitions();
+
+    // query every use twice, the second query is answered from the cache
+    for (int i = 0; i < 2; ++i) {
+        for (unsigned id = 1; id < lastID; ++id) {
+            auto *n = SSA.getGraph()->getNode(id);
+            if (!n->isUse())
+                continue;
+
+            std::set<unsigned> got;
+            for (auto *d : SSA.getDefinitions(n))
+                got.insert(d->getID());
+
+            std::set<RWNode *> visited;
+            std::set<unsigned> expected;
+            nonPhiDefs(n, visited, expected);
+            REQUIRE(got == expected);
+        }
+    }
+}
+
+static std::vector<DefinitionsQuery> buildQueries(ReadWriteGraph &G,
+                                                  unsigned lastID) {
+    std::vector<RWNode *> globals;
+    std::vector<RWNode *> locations;
+    for (unsigned id = 1; id < lastID; ++id) {
+        auto *n = G.getNode(id);
+        if (n->getType() == RWNodeType::GLOBAL)
+            globals.push_back(n);
+        else if (n->getType() == RWNodeType::LOAD)
+            locations.push_back(n);
+    }
+
+    std::vector<DefinitionsQuery> queries;
+    for (unsigned i = 0; i < locations.size(); ++i) {
+        auto *mem = globals[i % globals.size()];
+        queries.push_back({locations[i], mem, (i % 3) * 4, 4 + (i % 2) * 4});
+        // more queries at the same location
+        if (i % 4 == 0)
+            queries.push_back({locations[i], mem, 0, dg::Offset::UNKNOWN});
+    }
+    return queries;
+}
+
+static std::set<unsigned> toIDs(const std::vector<RWNode *> &nodes) {
+    std::set<unsigned> ids;
+    for (auto *n : nodes)
+        ids.insert(n->getID());
+    return ids;
+}
+
+TEST_CASE("batched queries", "[MemorySSA]") {
+    // answers to single queries
+    std::vector<std::set<unsigned>> expected;
+    {
+        ReadWriteGraph G;
+        buildGraph(G, 100);
+        const unsigned lastID = G.create(RWNodeType::NOOP).getID();
+        auto queries = buildQueries(G, lastID);
+
+        MemorySSATransformation SSA(std::move(G));
+        SSA.run();
+        for (auto &q : queries)
+            expected.push_back(
+                    toIDs(SSA.getDefinitions(q.where, q.mem, q.off, q.len)));
+    }
+
+    ReadWriteGraph G;
+    buildGraph(G, 100);
+    const unsigned lastID = G.create(RWNodeType::NOOP).getID();
+    auto queries = buildQueries(G, lastID);
+    REQUIRE(queries.size() == expected.size());
+
+    MemorySSATransformation SSA(std::move(G));
+    SSA.run();
+    auto defs = SSA.getDefinitions(queries);
+    REQUIRE(defs.size() == queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        REQUIRE(toIDs(defs[i]) == expected[i]);
+    }
+
+    // no MU nodes were inserted
+    for (auto *subg : SSA.getGraph()->subgraphs()) {
+        for (auto *b : subg->bblocks()) {
+            for (auto *n : b->getNodes())
+                REQUIRE(n->getType() != RWNodeType::MU);
+        }
+    }
+
+    // now all the queries can be answered without changing the analysis
+    std::vector<std::vector<RWNode *>> known(queries.size());
+    std::vector<char> succeeded(queries.size(), 0);
+    dg::parallelFor(4, queries.size(), [&](size_t i) {
+        succeeded[i] = SSA.getKnownDefinitions(queries[i], known[i]);
+    });
+    for (size_t i = 0; i < queries.size(); ++i) {
+        REQUIRE(succeeded[i]);
+        REQUIRE(toIDs(known[i]) == expected[i]);
+    }
+}
+
+TEST_CASE("modref of mutually recursive procedures", "[MemorySSA]") {
+    ReadWriteGraph G;
+    auto *Y = &G.create(RWNodeType::GLOBAL);
+
+    // f() { g(); Y = ...; }  g() { f(); }
+    auto &f = G.createSubgraph();
+    auto &g = G.createSubgraph();
+    auto &fEntry = f.createBBlock();
+    auto &fStore = G.create(RWNodeType::STORE);
+    fStore.addDef(Y, 0, 4, /* strong update = */ true);
+    auto *callG = RWNodeCall::get(&G.create(RWNodeType::CALL));
+    callG->addCallee(&g);
+    fEntry.append(callG);
+    auto &fRet = f.createBBlock();
+    fRet.append(&fStore);
+    fRet.append(&G.create(RWNodeType::RETURN));
+    fEntry.addSuccessor(&fRet);
+
+    auto &gEntry = g.createBBlock();
+    auto *callF = RWNodeCall::get(&G.create(RWNodeType::CALL));
+    callF->addCallee(&f);
+    gEntry.append(callF);
+    auto &gRet = g.createBBlock();
+    gRet.append(&G.create(RWNodeType::RETURN));
+    gEntry.addSuccessor(&gRet);
+
+    // main() { f(); ... = Y; Y = ...; g(); ... = Y; }
+    auto &main = G.createSubgraph();
+    G.setEntry(&main);
+    RWBBlock *prev = nullptr;
+    auto append = [&](RWNode *n) {
+        auto &B = main.createBBlock();
+        B.append(n);
+        if (prev)
+            prev->addSuccessor(&B);
+        prev = &B;
+    };
+    auto *mainCallF = RWNodeCall::get(&G.create(RWNodeType::CALL));
+    mainCallF->addCallee(&f);
+    append(mainCallF);
+    auto &L1 = G.create(RWNodeType::LOAD);
+    L1.addUse(Y, 0, 4);
+    append(&L1);
+    auto &S = G.create(RWNodeType::STORE);
+    S.addDef(Y, 0, 4, /* strong update = */ true);
+    append(&S);
+    auto *mainCallG = RWNodeCall::get(&G.create(RWNodeType::CALL));
+    mainCallG->addCallee(&g);
+    append(mainCallG);
+    auto &L2 = G.create(RWNodeType::LOAD);
+    L2.addUse(Y, 0, 4);
+    append(&L2);
+    append(&G.create(RWNodeType::RETURN));
+
+    const auto fStoreID = fStore.getID();
+    const auto L1ID = L1.getID();
+    const auto L2ID = L2.getID();
+
+    MemorySSATransformation SSA(std::move(G));
+    SSA.run();
+
+    auto definedBy = [&](unsigned use, unsigned def) {
+        auto *n = SSA.getGraph()->getNode(use);
+        for (auto *d : SSA.getDefinitions(n)) {
+            if (d->getID() == def)
+                return true;
+        }
+        return false;
+    };
+
+    REQUIRE(definedBy(L1ID, fStoreID));
+    // g() calls f() that writes to Y
+    REQUIRE(definedBy(L2ID, fStoreID));
+}
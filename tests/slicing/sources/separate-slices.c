@@ -0,0 +1,15 @@
+void check_value(int v) { (void)v; }
+
+int main(void) {
+    int a = 1, b = 2, c = 3;
+    for (int i = 0; i < 3; ++i) {
+        a += i;
+        b *= 2;
+    }
+    if (c > 2)
+        c = a + 1;
+    check_value(b);
+    test_assert(a == 4);
+    check_value(c);
+    return 0;
+}
@@ -106,11 +106,12 @@ def compile(source, output=None, params=[]):
     return output
 
 
-def slice(bccode, args):
-    output = bccode + ".sliced"
+def slice(bccode, args, criteria="test_assert", output=None):
+    if output is None:
+        output = bccode + ".sliced"
     slicer = join(DG_TOOLS_DIR, "llvm-slicer")
 
-    cmd = [slicer, "-c", "test_assert"] + args + [bccode, "-o", output]
+    cmd = [slicer, "-c", criteria] + args + [bccode, "-o", output]
     if command(cmd) != 0:
         error('Failed executing llvm-slicer')
 
@@ -143,6 +144,32 @@ def opt(bccode, passes, output=None):
     return output
 
 
+def disassemble(bccode):
+    llvm_dis = join(LLVM_TOOLS_DIR, "llvm-dis")
+    out, _, exitcode = command_output([llvm_dis, bccode, "-o", "-"])
+    if exitcode != 0:
+        error('Failed executing ' + llvm_dis)
+
+    # skip the ModuleID, it is the name of the file
+    return out.decode().split('\n')[1:]
+
+
+def check_separate_slices(test, bccode, args):
+    """ Check that the slices computed at once with -separate-slices
+        are the same as the slices computed for every criterion alone """
+    slice(bccode, args + test.addparams + ['-separate-slices'],
+          criteria=",".join(test.separateslices),
+          output=bccode + ".separate.bc")
+
+    for i, crit in enumerate(test.separateslices):
+        alone = slice(bccode,
+                      args + test.addparams + ['-cutoff-diverging=false'],
+                      criteria=crit, output=bccode + "." + crit)
+        separate = bccode + ".separate.{0}.bc".format(i + 1)
+        if disassemble(separate) != disassemble(alone):
+            error("The separate slice for '{0}' differs".format(crit))
+
+
 def check_output(out, err, exitcode, expout):
     if debug:
         print("--- stdout ---")
@@ -219,6 +246,9 @@ def _test_enabled(test, setup):
 
 
 def run_test(test, bccode, optafter, linkafter, args):
+    if test.separateslices:
+        check_separate_slices(test, bccode, args)
+
     bccode = slice(bccode, args + test.addparams)
 
     if optafter:
@@ -2,7 +2,8 @@ class Test:
     def __init__(self, src, linkbefore=[], linkafter=[],
                             optbefore=[], optafter=[],
                             addparams=[], requiredparams=[],
-                            compilerparams=[], expectedoutput=None):
+                            compilerparams=[], expectedoutput=None,
+                            separateslices=[]):
         self.source = src
         self.linkbefore = linkbefore
         self.linkafter = linkafter
@@ -12,6 +13,9 @@ class Test:
         self.requiredparams = requiredparams
         self.compilerparams = compilerparams
         self.expectedoutput = expectedoutput
+        # the criteria whose slices are computed also
+        # with -separate-slices and compared
+        self.separateslices = separateslices
 
 
 tests = {
@@ -225,4 +229,7 @@ tests = {
     'atomic2'             : Test('atomic2.c'),
     'atomic3'             : Test('atomic3.c'),
     'cyclic-realloc'      : Test('cyclic-realloc.c'),
+    'separate-slices'     : Test('separate-slices.c',
+                                  separateslices=['test_assert',
+                                                  'check_value']),
 }
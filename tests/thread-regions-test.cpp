@@ -3,6 +3,7 @@
 #include "dg/PointerAnalysis/PointerAnalysisFI.h"
 #include "dg/llvm/PointerAnalysis/PointerAnalysis.h"
 #include "dg/llvm/ThreadRegions/ControlFlowGraph.h"
+#include "dg/llvm/ThreadRegions/MayHappenInParallel.h"
 #include "dg/llvm/ThreadRegions/ThreadRegion.h"
 
 #include "llvm/ThreadRegions/Graphs/GraphBuilder.h"
@@ -189,64 +190,56 @@ TEST_CASE("Test of node class methods", "[node]") {
 }
 
 TEST_CASE("Test of ThreadRegion class methods", "[ThreadRegion]") {
-    NodePtr node0(createNode<NodeType::GENERAL>()),
-            node1(createNode<NodeType::GENERAL>());
-
-    std::unique_ptr<ThreadRegion> threadRegion0(new ThreadRegion(node0.get())),
-            threadRegion1(new ThreadRegion(node1.get()));
+    std::unique_ptr<ThreadRegion> threadRegion0(new ThreadRegion()),
+            threadRegion1(new ThreadRegion());
 
-    REQUIRE(threadRegion0->successors().empty());
-    REQUIRE(threadRegion1->successors().empty());
+    REQUIRE(threadRegion0->directSuccessors().empty());
+    REQUIRE(threadRegion0->calledSuccessors().empty());
+    REQUIRE(threadRegion0->forkedSuccessors().empty());
+    REQUIRE(threadRegion0->interestingCallSuccessor() == nullptr);
 
     SECTION("Incrementing Ids") {
         REQUIRE(threadRegion0->id() < threadRegion1->id());
     }
 
     SECTION("Name of node is set properly") {
-        std::string dotname = "cluster" + std::to_string(threadRegion0->id());
+        std::string dotname = "cluster_" + std::to_string(threadRegion0->id());
         REQUIRE(dotname == threadRegion0->dotName());
     }
 
-    SECTION("Add successor") {
-        REQUIRE(threadRegion0->addSuccessor(threadRegion1.get()));
-        REQUIRE(threadRegion0->successors().size() == 1);
-        REQUIRE(threadRegion1->predecessors().size() == 1);
-    }
-
-    SECTION("Add predecessor") {
-        REQUIRE(threadRegion0->addPredecessor(threadRegion1.get()));
-        REQUIRE(threadRegion0->predecessors().size() == 1);
-        REQUIRE(threadRegion1->successors().size() == 1);
-    }
-
-    SECTION("Remove existing successor") {
-        threadRegion0->addSuccessor(threadRegion1.get());
-        REQUIRE(threadRegion0->successors().size() == 1);
-        REQUIRE(threadRegion0->removeSuccessor(threadRegion1.get()));
-        REQUIRE(threadRegion0->successors().empty());
+    SECTION("Add direct successor") {
+        threadRegion0->addDirectSuccessor(threadRegion1.get());
+        REQUIRE(threadRegion0->directSuccessors().size() == 1);
+        REQUIRE(threadRegion0->directSuccessors()[0] == threadRegion1.get());
+        REQUIRE(threadRegion1->directSuccessors().empty());
     }
 
-    SECTION("Removing existing predecessor") {
-        threadRegion0->addPredecessor(threadRegion1.get());
-        REQUIRE(threadRegion0->predecessors().size() == 1);
-        REQUIRE(threadRegion0->removePredecessor(threadRegion1.get()));
-        REQUIRE(threadRegion0->predecessors().empty());
+    SECTION("Add call successor") {
+        threadRegion0->addCallSuccessor(threadRegion1.get());
+        REQUIRE(threadRegion0->calledSuccessors().size() == 1);
+        REQUIRE(threadRegion0->directSuccessors().empty());
     }
 
-    SECTION("Removing nonexistent successor") {
-        REQUIRE_FALSE(threadRegion0->removeSuccessor(threadRegion1.get()));
+    SECTION("Add forked successor") {
+        threadRegion0->addForkedSuccessor(threadRegion1.get());
+        REQUIRE(threadRegion0->forkedSuccessors().size() == 1);
+        REQUIRE(threadRegion0->directSuccessors().empty());
     }
 
-    SECTION("Removing nonexistent predecessor") {
-        REQUIRE_FALSE(threadRegion0->removePredecessor(threadRegion1.get()));
+    SECTION("Set interesting call successor") {
+        threadRegion0->setInterestingCallSuccessor(threadRegion1.get());
+        REQUIRE(threadRegion0->interestingCallSuccessor() ==
+                threadRegion1.get());
     }
 
-    SECTION("Remove nullptr from successor") {
-        REQUIRE_FALSE(threadRegion0->removeSuccessor(nullptr));
-    }
-
-    SECTION("Remove nullptr from predecessor") {
-        REQUIRE_FALSE(threadRegion0->removePredecessor(nullptr));
+    SECTION("First and last node") {
+        NodePtr node0(createNode<NodeType::GENERAL>()),
+                node1(createNode<NodeType::GENERAL>());
+        REQUIRE(threadRegion0->firstNode() == nullptr);
+        threadRegion0->insertNode(node0.get());
+        threadRegion0->insertNode(node1.get());
+        REQUIRE(threadRegion0->firstNode() == node0.get());
+        REQUIRE(threadRegion0->lastNode() == node1.get());
     }
 }
 
@@ -587,3 +580,95 @@ TEST_CASE("GraphBuilder build tests", "[GraphBuilder]") {
         REQUIRE(i == 2);
     }
 }
+
+static const ThreadRegion *
+regionOf(const ControlFlowGraph &controlFlowGraph,
+         const llvm::Instruction *instruction) {
+    for (const auto *region : controlFlowGraph.allRegions()) {
+        auto instructions = region->llvmInstructions();
+        if (instructions.find(instruction) != instructions.end()) {
+            return region;
+        }
+    }
+    return nullptr;
+}
+
+TEST_CASE("MayHappenInParallel without threads", "[MayHappenInParallel]") {
+    using namespace llvm;
+    LLVMContext context;
+    SMDiagnostic SMD;
+    std::unique_ptr<Module> M = parseIRFile(SIMPLE_FILE, SMD, context);
+    dg::DGLLVMPointerAnalysis pointsToAnalysis(M.get(), "main",
+                                               dg::Offset::UNKNOWN, true);
+    pointsToAnalysis.run();
+
+    ControlFlowGraph controlFlowGraph(&pointsToAnalysis);
+    controlFlowGraph.buildFunction(M->getFunction("main"));
+
+    MayHappenInParallel mayHappenInParallel(
+            controlFlowGraph.mainEntryRegion());
+    mayHappenInParallel.run();
+
+    REQUIRE(mayHappenInParallel.countRelations() == 0);
+    for (const auto *region : controlFlowGraph.allRegions()) {
+        REQUIRE(mayHappenInParallel.parallelRegions(region).empty());
+    }
+}
+
+TEST_CASE("MayHappenInParallel with a forked thread",
+          "[MayHappenInParallel]") {
+    using namespace llvm;
+    LLVMContext context;
+    SMDiagnostic SMD;
+    std::unique_ptr<Module> M = parseIRFile(PTHREAD_EXIT_FILE, SMD, context);
+    dg::DGLLVMPointerAnalysis pointsToAnalysis(M.get(), "main",
+                                               dg::Offset::UNKNOWN, true);
+    pointsToAnalysis.run();
+
+    ControlFlowGraph controlFlowGraph(&pointsToAnalysis);
+    controlFlowGraph.buildFunction(M->getFunction("main"));
+
+    MayHappenInParallel mayHappenInParallel(
+            controlFlowGraph.mainEntryRegion());
+    mayHappenInParallel.run();
+
+    // main is split by the fork into the region that forks the thread
+    // and the region with the join, the thread runs in a single region
+    const ThreadRegion *joinRegion = nullptr;
+    for (const auto &block : *M->getFunction("main")) {
+        for (const auto &instruction : block) {
+            const auto *callInst = dyn_cast<CallInst>(&instruction);
+            const auto *function =
+                    callInst ? callInst->getCalledFunction() : nullptr;
+            if (function && function->getName().equals("pthread_join")) {
+                joinRegion = regionOf(controlFlowGraph, callInst);
+            }
+        }
+    }
+    const ThreadRegion *threadRegion = regionOf(
+            controlFlowGraph, &M->getFunction("func")->front().front());
+    const ThreadRegion *entryRegion = controlFlowGraph.mainEntryRegion();
+
+    REQUIRE(controlFlowGraph.allRegions().size() == 3);
+    REQUIRE(joinRegion != nullptr);
+    REQUIRE(threadRegion != nullptr);
+    REQUIRE(entryRegion != joinRegion);
+    REQUIRE(entryRegion != threadRegion);
+    REQUIRE(joinRegion != threadRegion);
+
+    SECTION("Only the thread and the rest of main are parallel") {
+        REQUIRE(mayHappenInParallel.parallelRegions(entryRegion).empty());
+
+        auto threadParallel = mayHappenInParallel.parallelRegions(threadRegion);
+        REQUIRE(threadParallel.size() == 1);
+        REQUIRE(*threadParallel.begin() == joinRegion);
+
+        auto joinParallel = mayHappenInParallel.parallelRegions(joinRegion);
+        REQUIRE(joinParallel.size() == 1);
+        REQUIRE(*joinParallel.begin() == threadRegion);
+    }
+
+    SECTION("Unordered pairs are counted once") {
+        REQUIRE(mayHappenInParallel.countRelations() == 1);
+    }
+}
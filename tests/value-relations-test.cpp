@@ -539,3 +539,44 @@ TEST_CASE("big graph") {
         checkRelations(related, {{one, eq}, {two, sgt}, {three, sge}});
     }
 }
+
+TEST_CASE("copy of graph") {
+    Dummy d;
+    RelGraph graph(d);
+
+    const Bucket &one = graph.getNewBucket();
+    const Bucket &two = graph.getNewBucket();
+    const Bucket &three = graph.getNewBucket();
+    const Bucket &border = graph.getBorderBucket(7);
+
+    graph.addRelation(one, Relations::SLT, two);
+    graph.addRelation(two, Relations::SLE, three);
+    graph.addRelation(three, Relations::PT, border);
+
+    RelGraph copy(d, graph);
+
+    REQUIRE(copy.size() == graph.size());
+    for (const Bucket *b : {&one, &two, &three, &border}) {
+        const Bucket *copied = copy.getBucket(b->id);
+        REQUIRE(copied);
+        CHECK(copied != b);
+        CHECK(copy.getRelated(*copied, allRelations) ==
+              graph.getRelated(*b, allRelations));
+    }
+    REQUIRE(copy.getBorderB(7));
+    CHECK(copy.getBorderB(7)->id == border.id);
+    CHECK(collect(copy.begin(), copy.end()).size() ==
+          collect(graph.begin(), graph.end()).size());
+
+    SECTION("changing the copy does not change the original") {
+        copy.addRelation(*copy.getBucket(one.id), Relations::SLT,
+                         *copy.getBucket(three.id));
+        const Bucket &four = copy.getNewBucket();
+        copy.addRelation(four, Relations::SGT, *copy.getBucket(three.id));
+
+        CHECK(copy.size() == graph.size() + 1);
+        CHECK(!graph.getBucket(four.id));
+        CHECK(graph.getRelated(three, allRelations).size() <
+              copy.getRelated(*copy.getBucket(three.id), allRelations).size());
+    }
+}
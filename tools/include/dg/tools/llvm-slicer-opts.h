@@ -36,6 +36,12 @@ struct SlicerOptions {
     // but the instructions that follow the call
     bool criteriaAreNextInstr{false};
 
+    // compute a separate slice for every set of slicing criteria
+    // (over one dependence graph)
+    bool separateSlices{false};
+    // the number of threads (and processes) computing the separate slices
+    unsigned workers{1};
+
     // string describing the slicing criteria
     std::string slicingCriteria{};
     // SC string in the old format
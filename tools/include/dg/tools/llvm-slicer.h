@@ -3,6 +3,7 @@
 
 #include <ctime>
 #include <fstream>
+#include <vector>
 
 #include <llvm/IR/Module.h>
 #include <llvm/Support/raw_os_ostream.h>
@@ -22,6 +23,7 @@
 #include "dg/llvm/LLVMDGAssemblyAnnotationWriter.h"
 
 #include "dg/util/TimeMeasure.h"
+#include "dg/util/parallel.h"
 
 #include "llvm-slicer-opts.h"
 #include "llvm-slicer-utils.h"
@@ -50,6 +52,15 @@
 //  Slicer slicer(M, options);
 //  slicer.buildDG(true /* compute dependencies */);
 //
+//  More slices of the same graph are computed as follows
+//  (the graph can be sliced only once, so every slice(i)
+//  must be called on a different copy of the process):
+//
+//  Slicer slicer(M, options);
+//  slicer.buildDG();
+//  slicer.markSlices(criteria_sets);
+//  slicer.slice(i);
+//
 /// --------------------------------------------------------------------
 class Slicer {
     llvm::Module *M{};
@@ -59,6 +70,8 @@ class Slicer {
     std::unique_ptr<dg::LLVMDependenceGraph> _dg{};
 
     dg::llvmdg::LLVMSlicer slicer;
+    // the slices marked by markSlices()
+    std::vector<dg::SliceMarking<dg::LLVMNode>> _slices;
     uint32_t slice_id = 0;
     const uint32_t _default_slice_id = 0xdead;
     bool _computed_deps{false};
@@ -157,6 +170,59 @@ class Slicer {
         return true;
     }
 
+    // Mark the nodes of more slices, one for every set of criteria.
+    // Unlike mark(), the slices are not stored in the nodes, so they
+    // are marked in parallel (using _options.workers threads).
+    // This method calls computeDependencies() too.
+    bool markSlices(std::vector<std::set<dg::LLVMNode *>> &criteria_sets) {
+        assert(_dg && "markSlices() called without the dependence graph");
+
+        dg::debug::TimeMeasure tm;
+
+        computeDependencies();
+
+        std::vector<std::set<dg::LLVMNode *>> unmark(criteria_sets.size());
+        for (size_t i = 0; i < criteria_sets.size(); ++i) {
+            if (_options.removeSlicingCriteria)
+                unmark[i] = criteria_sets[i];
+
+            if (!criteria_sets[i].empty())
+                _dg->getCallSites(_options.additionalSlicingCriteria,
+                                  &criteria_sets[i]);
+        }
+
+        for (const auto &funcName : _options.preservedFunctions)
+            slicer.keepFunctionUntouched(funcName.c_str());
+
+        tm.start();
+        _slices.assign(criteria_sets.size(),
+                       dg::SliceMarking<dg::LLVMNode>(_options.forwardSlicing));
+        dg::parallelFor(
+                _options.workers, criteria_sets.size(),
+                [&](size_t i) {
+                    for (dg::LLVMNode *start : criteria_sets[i])
+                        _slices[i].mark(start);
+                    for (dg::LLVMNode *nd : unmark[i])
+                        _slices[i].unmark(nd);
+                },
+                /* chunk = */ 1);
+        tm.stop();
+        tm.report("[llvm-slicer] Finding dependent nodes of all slices took");
+
+        return true;
+    }
+
+    // Slice the graph w.r.t. the i-th slice marked by markSlices().
+    // This changes the graph and the module.
+    bool slice(size_t i) {
+        assert(i < _slices.size() && "Must run markSlices() before slice(i)");
+
+        slice_id = _default_slice_id;
+        _slices[i].apply(slice_id);
+
+        return slice();
+    }
+
     bool slice() {
         assert(_dg && "Must run buildDG() and computeDependencies()");
         assert(slice_id != 0 && "Must run mark() method before slice()");
@@ -515,6 +581,9 @@ class ModuleAnnotator {
         case AnalysisType::inv:
             module_comment += "flow-sensitive with invalidate\n";
             break;
+        case AnalysisType::sfs:
+            module_comment += "sparse flow-sensitive\n";
+            break;
         case AnalysisType::svf:
             module_comment += "SVF\n";
             break;
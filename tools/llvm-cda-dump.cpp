@@ -321,16 +321,12 @@ static void dumpIr(LLVMControlDependenceAnalysis &cda) {
             const auto *info = ntscd->_getFunInfo(&f);
             if (info) {
                 for (auto *nd : *graph) {
-                    auto it = info->controlDependence.find(nd);
-                    if (it == info->controlDependence.end())
-                        continue;
-
-                    for (const auto *dep : it->second) {
-                        // FIXME: for interproc CD this will not work as the
-                        // nodes would be in a different graph
-                        std::cout << " " << graph->getName() << "_"
-                                  << dep->getID() << " -> " << graph->getName()
-                                  << "_" << nd->getID() << " [ color=red ]\n";
+                    // FIXME: for interproc CD this will not work as the
+                    // nodes would be in a different graph
+                    for (auto id : info->controlDependence[nd->getID()]) {
+                        std::cout << " " << graph->getName() << "_" << id
+                                  << " -> " << graph->getName() << "_"
+                                  << nd->getID() << " [ color=red ]\n";
                     }
                 }
             }
@@ -341,14 +337,10 @@ static void dumpIr(LLVMControlDependenceAnalysis &cda) {
             const auto *info = dod->_getFunInfo(&f);
             if (info) {
                 for (auto *nd : *graph) {
-                    auto it = info->controlDependence.find(nd);
-                    if (it == info->controlDependence.end())
-                        continue;
-
-                    for (const auto *dep : it->second) {
-                        std::cout << " " << graph->getName() << "_"
-                                  << dep->getID() << " -> " << graph->getName()
-                                  << "_" << nd->getID() << " [ color=red ]\n";
+                    for (auto id : info->controlDependence[nd->getID()]) {
+                        std::cout << " " << graph->getName() << "_" << id
+                                  << " -> " << graph->getName() << "_"
+                                  << nd->getID() << " [ color=red ]\n";
                     }
                 }
             }
@@ -407,6 +399,10 @@ int main(int argc, char *argv[]) {
         if (dump_ir) {
             dumpIr(cda);
         } else {
+            // with more threads, compute the dependencies of all functions
+            // at once instead of on demand
+            if (cda.getOptions().workers > 1)
+                cda.compute();
             dumpCda(cda);
         }
     }
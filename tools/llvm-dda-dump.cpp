@@ -519,7 +519,7 @@ class Dumper {
   private:
     static void printId(const RWNode *node) { printf(" [%u]", node->getID()); }
 
-    void _dumpDefSites(const std::set<DefSite> &defs, const char *kind) {
+    void _dumpDefSites(const DefSiteSetT &defs, const char *kind) {
         if (defs.empty())
             return;
 
@@ -51,6 +51,13 @@ llvm::cl::opt<bool>
 llvm::cl::opt<bool> fi("fi", llvm::cl::desc("Run flow-insensitive PTA."),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<unsigned> fiWorkers(
+        "fi-workers",
+        llvm::cl::desc("Run flow-insensitive PTA with the given number "
+                       "of threads\n"
+                       "(e.g., to compare it with -fi)."),
+        llvm::cl::init(0), llvm::cl::cat(SlicingOpts));
+
 llvm::cl::opt<bool> fs("fs", llvm::cl::desc("Run flow-sensitive PTA."),
                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
@@ -60,6 +67,10 @@ llvm::cl::opt<bool> fsinv(
                 "Run flow-sensitive PTA with invalidated memory analysis."),
         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+llvm::cl::opt<bool> sfs("sfs",
+                        llvm::cl::desc("Run sparse flow-sensitive PTA."),
+                        llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
 #if HAVE_SVF
 llvm::cl::opt<bool> svf("svf", llvm::cl::desc("Run SVF PTA (Andersen)."),
                         llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
@@ -208,6 +219,14 @@ int main(int argc, char *argv[]) {
                 "DG FI", createAnalysis<DGLLVMPointerAnalysis>(M.get(), opts),
                 0);
     }
+    if (fiWorkers > 0) {
+        auto popts = opts;
+        popts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::fi;
+        popts.workers = fiWorkers;
+        analyses.emplace_back(
+                "DG FI parallel",
+                createAnalysis<DGLLVMPointerAnalysis>(M.get(), popts), 0);
+    }
     if (fs) {
         opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::fs;
         analyses.emplace_back(
@@ -220,6 +239,12 @@ int main(int argc, char *argv[]) {
                 "DG FSinv",
                 createAnalysis<DGLLVMPointerAnalysis>(M.get(), opts), 0);
     }
+    if (sfs) {
+        opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::sfs;
+        analyses.emplace_back(
+                "DG SFS", createAnalysis<DGLLVMPointerAnalysis>(M.get(), opts),
+                0);
+    }
 #ifdef HAVE_SVF
     if (svf) {
         opts.analysisType = dg::LLVMPointerAnalysisOptions::AnalysisType::svf;
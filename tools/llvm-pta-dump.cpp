@@ -262,7 +262,7 @@ static void dumpPointer(const Pointer &ptr, bool dot) {
         printf(" + %" PRIu64, *ptr.offset);
 }
 
-static void dumpMemoryObject(MemoryObject *mo, int ind, bool dot) {
+static void dumpMemoryObject(const MemoryObject *mo, int ind, bool dot) {
     bool printed_multi = false;
     for (auto &it : mo->pointsTo) {
         int width = 0;
@@ -607,6 +607,8 @@ static void dumpPointerGraph(DGLLVMPointerAnalysis *pta, PTType type) {
 static void dumpStats(DGLLVMPointerAnalysis *pta) {
     const auto &nodes = pta->getNodes();
     printf("Pointer subgraph size: %zu\n", nodes.size() - 1);
+    printf("Fixpoint iterations: %zu\n", pta->getPTA()->getIterationsNum());
+    printf("Processed nodes: %zu\n", pta->getPTA()->getProcessedNodesNum());
 
     size_t nonempty_size = 0; // number of nodes with non-empty pt-set
     size_t maximum = 0;       // maximum pt-set size
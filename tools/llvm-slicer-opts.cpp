@@ -143,6 +143,31 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                            "is per basic block)\n"),
             llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<unsigned> cdaWorkers(
+            "cda-workers",
+            llvm::cl::desc("The number of threads used by control dependence "
+                           "analysis. With more than one thread, the\n"
+                           "dependencies of all functions are computed "
+                           "eagerly (default=1)."),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> cdaNodesOnDemand(
+            "cda-nodes-on-demand",
+            llvm::cl::desc("Compute NTSCD only for the queried blocks or "
+                           "instructions instead of\n"
+                           "whole functions (default=false)."),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<std::string> cdaCache(
+            "cda-cache",
+            llvm::cl::desc("Keep control dependencies of functions in the "
+                           "given file between runs.\n"
+                           "The dependencies of functions whose CFG did not "
+                           "change are\n"
+                           "read from the file (default=none)."),
+            llvm::cl::value_desc("file"), llvm::cl::init(""),
+            llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<bool> icfgCD(
             "cda-icfg",
             llvm::cl::desc(
@@ -232,7 +257,9 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                     clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::fs,
                                "fs", "Flow-sensitive PTA"),
                     clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::inv,
-                               "inv", "PTA with invalidate nodes")
+                               "inv", "PTA with invalidate nodes"),
+                    clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::sfs,
+                               "sfs", "Sparse flow-sensitive PTA")
 #ifdef HAVE_SVF
                             ,
                     clEnumValN(LLVMPointerAnalysisOptions::AnalysisType::svf,
@@ -246,6 +273,52 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
             llvm::cl::init(LLVMPointerAnalysisOptions::AnalysisType::fi),
             llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<bool> ptaDiffPropagation(
+            "pta-diff-propagation",
+            llvm::cl::desc("Propagate only newly added pointers in the "
+                           "fixpoint\n"
+                           "of DG pointer analysis (default=false)."),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<bool> ptaCollapseCycles(
+            "pta-collapse-cycles",
+            llvm::cl::desc("Detect and collapse cycles of nodes that copy "
+                           "pointers\n"
+                           "during flow-insensitive PTA (default=false)."),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<dg::PointerAnalysisOptions::Scheduling> ptaScheduling(
+            "pta-scheduling",
+            llvm::cl::desc("The order in which DG PTA processes nodes:"),
+            llvm::cl::values(
+                    clEnumValN(dg::PointerAnalysisOptions::Scheduling::BFS,
+                               "bfs", "BFS order from changed nodes (default)"),
+                    clEnumValN(dg::PointerAnalysisOptions::Scheduling::
+                                       TOPOLOGICAL,
+                               "topological",
+                               "Topological order of SCCs of the graph")
+#if LLVM_VERSION_MAJOR < 4
+                            ,
+                    nullptr
+#endif
+                    ),
+            llvm::cl::init(dg::PointerAnalysisOptions::Scheduling::BFS),
+            llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ptaWorkers(
+            "pta-workers",
+            llvm::cl::desc("The number of threads used by flow-insensitive "
+                           "DG PTA\n"
+                           "(default=1)."),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> ddaWorkers(
+            "dda-workers",
+            llvm::cl::desc("The number of threads used by data dependence "
+                           "analysis. With more than one thread, all\n"
+                           "definitions are computed eagerly (default=1)."),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
     llvm::cl::opt<LLVMDataDependenceAnalysisOptions::AnalysisType> ddaType(
             "dda", llvm::cl::desc("Choose data dependence analysis to use:"),
             llvm::cl::values(
@@ -364,6 +437,23 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
                     "'crit'.\n"),
             llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
 
+    llvm::cl::opt<bool> separateSlices(
+            "separate-slices",
+            llvm::cl::desc(
+                    "Compute a separate slice for every set of slicing\n"
+                    "criteria (the sets are separated by ';' in -sc and\n"
+                    "by ',' in -c). The dependence graph is built only\n"
+                    "once and the slices are saved into separate files.\n"
+                    "Implies -cutoff-diverging=false (default=false).\n"),
+            llvm::cl::init(false), llvm::cl::cat(SlicingOpts));
+
+    llvm::cl::opt<unsigned> slicerWorkers(
+            "slicer-workers",
+            llvm::cl::desc("The number of threads (and processes) computing "
+                           "separate slices\n"
+                           "(default=1)."),
+            llvm::cl::init(1), llvm::cl::cat(SlicingOpts));
+
     ////////////////////////////////////
     // ===-- End of the options --=== //
     ////////////////////////////////////
@@ -399,6 +489,8 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
     options.forwardSlicing = forwardSlicing;
     options.cutoffDiverging = cutoffDiverging;
     options.criteriaAreNextInstr = criteriaAreNextInstr;
+    options.separateSlices = separateSlices;
+    options.workers = slicerWorkers;
 
     auto &dgOptions = options.dgOptions;
     auto &PTAOptions = dgOptions.PTAOptions;
@@ -413,18 +505,26 @@ SlicerOptions parseSlicerOptions(int argc, char *argv[], bool requireCrit,
     CDAOptions.interprocedural = interprocCd;
     CDAOptions._icfg = icfgCD;
     CDAOptions.setNodePerInstruction(cdaPerInstr);
+    CDAOptions.workers = cdaWorkers;
+    CDAOptions.nodesOnDemand = cdaNodesOnDemand;
+    CDAOptions.cacheFile = cdaCache;
 
     addAllocationFuns(dgOptions, allocationFuns);
 
     PTAOptions.entryFunction = entryFunction;
     PTAOptions.fieldSensitivity = dg::Offset(ptaFieldSensitivity);
     PTAOptions.analysisType = ptaType;
+    PTAOptions.differencePropagation = ptaDiffPropagation;
+    PTAOptions.collapseCycles = ptaCollapseCycles;
+    PTAOptions.scheduling = ptaScheduling;
+    PTAOptions.workers = ptaWorkers;
     PTAOptions.threads = threads;
 
     DDAOptions.threads = threads;
     DDAOptions.entryFunction = entryFunction;
     DDAOptions.undefinedFunsBehavior = undefinedFunsBehavior;
     DDAOptions.analysisType = ddaType;
+    DDAOptions.workers = ddaWorkers;
 
     return options;
 }
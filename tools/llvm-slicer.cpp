@@ -1,10 +1,15 @@
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <iostream>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "dg/tools/llvm-slicer-opts.h"
 #include "dg/tools/llvm-slicer-preprocess.h"
 #include "dg/tools/llvm-slicer-utils.h"
@@ -133,6 +138,150 @@ static AnnotationOptsT parseAnnotationOptions(const std::string &annot) {
     return opts;
 }
 
+// The sets of slicing criteria for -separate-slices: the sets of -sc
+// (with the secondary criteria that are given for all sets) and the
+// criteria of -c. The first item of a pair is in the format of -sc and
+// the second in the format of -c.
+static std::vector<std::pair<std::string, std::string>>
+getCriteriaSets(const SlicerOptions &options) {
+    std::vector<std::pair<std::string, std::string>> sets;
+
+    std::vector<std::string> toAll;
+    std::vector<std::string> criteria;
+    for (auto &crit : splitList(options.slicingCriteria, ';')) {
+        if (crit.empty())
+            continue;
+        if (crit[0] == '|')
+            toAll.push_back(crit);
+        else
+            criteria.push_back(crit);
+    }
+    for (auto &crit : criteria) {
+        for (auto &sec : toAll)
+            crit += ";" + sec;
+        sets.emplace_back(crit, "");
+    }
+
+    for (auto &crit : splitList(options.legacySlicingCriteria)) {
+        if (!crit.empty())
+            sets.emplace_back("", crit);
+    }
+
+    return sets;
+}
+
+// the name of the file with the i-th separate slice
+static std::string getSliceFileName(const SlicerOptions &options, size_t i) {
+    std::string fl;
+    if (!options.outputFile.empty()) {
+        fl = options.outputFile;
+    } else {
+        fl = options.inputFile;
+        replace_suffix(fl, ".sliced");
+    }
+
+    std::string num = "." + std::to_string(i + 1);
+    if (fl.size() > 3 && fl.compare(fl.size() - 3, 3, ".bc") == 0)
+        fl.insert(fl.size() - 3, num);
+    else
+        fl += num;
+
+    return fl;
+}
+
+// slice the module w.r.t. the i-th slice marked by the slicer
+// and save it, return the exit code
+static int saveSeparateSlice(::Slicer &slicer, llvm::Module *M,
+                             SlicerOptions options, size_t i, bool empty) {
+    options.outputFile = getSliceFileName(options, i);
+    ModuleWriter writer(options, M);
+
+    if (empty) {
+        llvm::errs() << "No reachable slicing criteria for slice " << i + 1
+                     << "\n";
+        if (!slicer.createEmptyMain()) {
+            llvm::errs() << "ERROR: failed creating an empty main\n";
+            return 1;
+        }
+    } else if (!slicer.slice(i)) {
+        errs() << "ERROR: Slicing failed\n";
+        return 1;
+    }
+
+    std::string prefix = "Statistics of slice " + std::to_string(i + 1) + " ";
+    maybe_print_statistics(M, prefix.c_str());
+    return writer.cleanAndSaveModule(should_verify_module);
+}
+
+// Compute a separate slice for every set of slicing criteria. The graph
+// is marked for all slices at once and then every slice is created
+// in a separate process (slicing changes the graph and the module,
+// so every slice needs its own copy of them).
+static int sliceSeparately(::Slicer &slicer, llvm::Module *M,
+                           const SlicerOptions &options) {
+    auto sets = getCriteriaSets(options);
+    std::vector<std::set<LLVMNode *>> criteria(sets.size());
+    for (size_t i = 0; i < sets.size(); ++i) {
+        if (!getSlicingCriteriaNodes(slicer.getDG(), sets[i].first,
+                                     sets[i].second,
+                                     options.legacySecondarySlicingCriteria,
+                                     criteria[i],
+                                     options.criteriaAreNextInstr)) {
+            llvm::errs() << "ERROR: Failed finding slicing criteria: '"
+                         << sets[i].first << sets[i].second << "'\n";
+            return 1;
+        }
+    }
+
+    if (!slicer.markSlices(criteria)) {
+        llvm::errs() << "Finding dependent nodes failed\n";
+        return 1;
+    }
+
+    dg::debug::TimeMeasure tm;
+    tm.start();
+
+    int ret = 0;
+    size_t running = 0;
+    auto waitForSlice = [&ret, &running]() {
+        int status;
+        if (wait(&status) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != 0)
+            ret = 1;
+        --running;
+    };
+
+    for (size_t i = 0; i < criteria.size(); ++i) {
+        if (running >= std::max(options.workers, 1U))
+            waitForSlice();
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            llvm::errs() << "ERROR: Failed creating a process for slice "
+                         << i + 1 << "\n";
+            ret = 1;
+            break;
+        }
+
+        if (pid == 0) {
+            // do not run the destructors in the child,
+            // the parent process owns the files
+            _exit(saveSeparateSlice(slicer, M, options, i,
+                                    criteria[i].empty()));
+        }
+
+        ++running;
+    }
+
+    while (running > 0)
+        waitForSlice();
+
+    tm.stop();
+    tm.report("[llvm-slicer] Slicing and saving all slices took");
+
+    return ret;
+}
+
 int main(int argc, char *argv[]) {
     setupStackTraceOnError(argc, argv);
 
@@ -189,6 +338,15 @@ int main(int argc, char *argv[]) {
         options.cutoffDiverging = false;
     }
 
+    // the cutoff changes the module before the graph is built, so it would
+    // have to use the criteria of all slices and the slices would not be
+    // the same as if they were computed alone
+    if (options.cutoffDiverging && options.separateSlices) {
+        llvm::errs() << "[llvm-slicer] computing separate slices, not cutting "
+                        "off diverging\n";
+        options.cutoffDiverging = false;
+    }
+
     if (options.cutoffDiverging) {
         DBG(llvm - slicer, "Searching for slicing criteria values");
         auto csvalues = getSlicingCriteriaValues(
@@ -228,6 +386,15 @@ int main(int argc, char *argv[]) {
     ModuleAnnotator annotator(options, &slicer.getDG(),
                               parseAnnotationOptions(annotationOpts));
 
+    if (options.separateSlices) {
+        if (annotator.shouldAnnotate() || dump_dg) {
+            llvm::errs() << "WARNING: annotating and dumping the graph is "
+                            "not supported with separate slices\n";
+        }
+
+        return sliceSeparately(slicer, M.get(), options);
+    }
+
     std::set<LLVMNode *> criteria_nodes;
     if (!getSlicingCriteriaNodes(slicer.getDG(), options.slicingCriteria,
                                  options.legacySlicingCriteria,
@@ -42,6 +42,12 @@ llvm::cl::opt<unsigned> max_iter("max-iter",
                                  llvm::cl::desc("Maximal number of iterations"),
                                  llvm::cl::init(20));
 
+llvm::cl::opt<unsigned>
+        workers("workers",
+                llvm::cl::desc("The number of threads analyzing functions "
+                               "(default=1)"),
+                llvm::cl::init(1));
+
 llvm::cl::opt<std::string> inputFile(llvm::cl::Positional, llvm::cl::Required,
                                      llvm::cl::desc("<input file>"),
                                      llvm::cl::init(""));
@@ -161,7 +167,7 @@ int main(int argc, char *argv[]) {
     structure.analyzeBeforeRelationsAnalysis();
 
     RelationsAnalyzer ra(*M, codeGraph, structure);
-    unsigned num_iter = ra.analyze(max_iter);
+    unsigned num_iter = ra.analyze(max_iter, workers);
     structure.analyzeAfterRelationsAnalysis();
     // call to analyzeAfterRelationsAnalysis is unnecessary, but better for
     // testing end analysis
@@ -170,6 +176,9 @@ int main(int argc, char *argv[]) {
     tm.report("INFO: Value Relations analysis took");
     std::cerr << "INFO: The analysis made " << num_iter << " passes."
               << "\n";
+    std::cerr << "INFO: Locations were processed "
+              << ra.getProcessedLocationsNum() << " times."
+              << "\n";
     std::cerr << "\n";
 
     if (todot)